@@ -0,0 +1,440 @@
+/*
+ * MAX78000 ADC
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * A 10 bit ADC doing one conversion per START. A conversion takes
+ * ADC_CONV_CYCLES cycles of the ADC clock, which the GCR derives from
+ * PCLK through PCLKDIV.ADCFRQ and CTRL.ADC_DIVSEL divides further.
+ * The result is checked against the four limit comparators set up for
+ * its channel. Reference selection and input scaling are stored but
+ * have no effect; the samples are the codes a conversion returns.
+ *
+ * Each channel takes its samples from either
+ *
+ *  - "file[n]", a file of little endian 16 bit codes, read
+ *    ADC_FILE_BATCH samples at a time, or
+ *  - "samples[n]", a list of codes that can be replaced at any time,
+ *    for example with a single qom-set per block of samples.
+ *
+ * Each conversion consumes one sample, and when they run out the
+ * channel holds its last value.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/log.h"
+#include "qemu/bswap.h"
+#include "qemu/timer.h"
+#include "qapi/error.h"
+#include "qapi/visitor.h"
+#include "qapi/qapi-builtin-visit.h"
+#include "trace.h"
+#include "hw/irq.h"
+#include "hw/qdev-clock.h"
+#include "migration/vmstate.h"
+#include "hw/adc/max78000_adc.h"
+
+static void max78000_adc_update_irq(Max78000AdcState *s)
+{
+    qemu_set_irq(s->irq, (s->intr >> ADC_INTR_IF_SHIFT) & s->intr &
+                         ADC_INTR_ALL);
+}
+
+static uint16_t max78000_adc_next_sample(Max78000AdcChannel *ch)
+{
+    ssize_t ret;
+
+    if (ch->pos == ch->len && ch->fd >= 0) {
+        do {
+            ret = read(ch->fd, ch->buf, ADC_FILE_BATCH * sizeof(uint16_t));
+        } while (ret < 0 && errno == EINTR);
+        ch->pos = 0;
+        ch->len = MAX(ret, 0) / sizeof(uint16_t);
+        if (ch->len == 0) {
+            qemu_close(ch->fd);
+            ch->fd = -1;
+        }
+    }
+
+    if (ch->pos < ch->len) {
+        ch->last = le16_to_cpu(ch->buf[ch->pos++]) & ADC_SAMPLE_MASK;
+    }
+    return ch->last;
+}
+
+static void max78000_adc_cancel(Max78000AdcState *s)
+{
+    timer_del(s->conv_timer);
+    s->status &= ~ADC_STATUS_ACTIVE;
+    s->ctrl &= ~ADC_CTRL_START;
+}
+
+static bool max78000_adc_clocked(Max78000AdcState *s)
+{
+    return (s->ctrl & (ADC_CTRL_PWR | ADC_CTRL_CLK_EN)) ==
+           (ADC_CTRL_PWR | ADC_CTRL_CLK_EN) && clock_is_enabled(s->clk);
+}
+
+static void max78000_adc_start(Max78000AdcState *s)
+{
+    unsigned div = (s->ctrl >> ADC_CTRL_DIVSEL_SHIFT) & ADC_CTRL_DIVSEL_MASK;
+
+    if (!max78000_adc_clocked(s)) {
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: ADC is not powered or clocked\n",
+                      __func__);
+        s->ctrl &= ~ADC_CTRL_START;
+        return;
+    }
+    if (s->status & ADC_STATUS_ACTIVE) {
+        return;
+    }
+
+    s->status |= ADC_STATUS_ACTIVE;
+    timer_mod(s->conv_timer, qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL) +
+              clock_ticks_to_ns(s->clk, ADC_CONV_CYCLES << div));
+}
+
+static void max78000_adc_convert_done(void *opaque)
+{
+    Max78000AdcState *s = opaque;
+    unsigned chan = (s->ctrl >> ADC_CTRL_CH_SEL_SHIFT) & ADC_CTRL_CH_SEL_MASK;
+    uint32_t flags = 0;
+    uint16_t sample = 0;
+    uint32_t lim;
+    int i;
+
+    if (chan < ADC_NUM_CHANNELS) {
+        sample = max78000_adc_next_sample(&s->ch[chan]);
+    }
+    trace_max78000_adc_convert(chan, sample);
+
+    s->status &= ~ADC_STATUS_ACTIVE;
+    s->ctrl &= ~ADC_CTRL_START;
+
+    /* The previous result was never acknowledged */
+    if (s->intr & (ADC_INTR_DONE << ADC_INTR_IF_SHIFT)) {
+        flags |= ADC_INTR_OVERFLOW;
+    }
+    s->data = (s->ctrl & ADC_CTRL_DATA_ALIGN) ? sample << 6 : sample;
+    flags |= ADC_INTR_DONE;
+
+    for (i = 0; i < ADC_NUM_LIMITS; i++) {
+        lim = s->limit[i];
+        if (((lim >> ADC_LIMIT_CH_SEL_SHIFT) & ADC_LIMIT_CH_SEL_MASK) != chan) {
+            continue;
+        }
+        if ((lim & ADC_LIMIT_HI_EN) &&
+            sample > ((lim >> ADC_LIMIT_HI_SHIFT) & ADC_LIMIT_HI_MASK)) {
+            flags |= ADC_INTR_HI_LIMIT;
+        }
+        if ((lim & ADC_LIMIT_LO_EN) && sample < (lim & ADC_LIMIT_LO_MASK)) {
+            flags |= ADC_INTR_LO_LIMIT;
+        }
+    }
+
+    s->intr |= flags << ADC_INTR_IF_SHIFT;
+    max78000_adc_update_irq(s);
+}
+
+static uint64_t max78000_adc_read(void *opaque, hwaddr addr,
+                                  unsigned int size)
+{
+    Max78000AdcState *s = opaque;
+    uint32_t val;
+
+    switch (addr) {
+    case ADC_CTRL:
+        return s->ctrl;
+
+    case ADC_STATUS:
+        val = s->status;
+        if (s->intr & (ADC_INTR_OVERFLOW << ADC_INTR_IF_SHIFT)) {
+            val |= ADC_STATUS_OVERFLOW;
+        }
+        return val;
+
+    case ADC_DATA:
+        return s->data;
+
+    case ADC_INTR:
+        val = s->intr;
+        if ((s->intr >> ADC_INTR_IF_SHIFT) & s->intr & ADC_INTR_ALL) {
+            val |= ADC_INTR_PENDING;
+        }
+        return val;
+
+    case ADC_LIMIT0 ... ADC_LIMIT0 + 4 * ADC_NUM_LIMITS - 1:
+        if (addr & 3) {
+            break;
+        }
+        return s->limit[(addr - ADC_LIMIT0) / 4];
+
+    default:
+        break;
+    }
+
+    qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+        HWADDR_PRIx "\n", __func__, addr);
+    return 0;
+}
+
+static void max78000_adc_write(void *opaque, hwaddr addr,
+                               uint64_t val64, unsigned int size)
+{
+    Max78000AdcState *s = opaque;
+    uint32_t val = val64;
+    uint32_t old;
+
+    switch (addr) {
+    case ADC_CTRL:
+        old = s->ctrl;
+        s->ctrl = val | (old & ADC_CTRL_START);
+        if ((val & ADC_CTRL_PWR) && !(old & ADC_CTRL_PWR)) {
+            /* The reference settles immediately */
+            s->intr |= ADC_INTR_REF_READY << ADC_INTR_IF_SHIFT;
+        }
+        if (!max78000_adc_clocked(s)) {
+            max78000_adc_cancel(s);
+        } else if (val & ADC_CTRL_START) {
+            max78000_adc_start(s);
+        }
+        break;
+
+    case ADC_STATUS:
+    case ADC_DATA:
+        break;
+
+    case ADC_INTR:
+        s->intr &= ~(val & (ADC_INTR_ALL << ADC_INTR_IF_SHIFT));
+        s->intr = (s->intr & ~ADC_INTR_ALL) | (val & ADC_INTR_ALL);
+        break;
+
+    case ADC_LIMIT0 ... ADC_LIMIT0 + 4 * ADC_NUM_LIMITS - 1:
+        if (addr & 3) {
+            goto bad_offset;
+        }
+        s->limit[(addr - ADC_LIMIT0) / 4] = val & 0x3f3ff3ff;
+        break;
+
+    default:
+    bad_offset:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        return;
+    }
+
+    max78000_adc_update_irq(s);
+}
+
+static void max78000_adc_clk_update(void *opaque, ClockEvent event)
+{
+    Max78000AdcState *s = opaque;
+
+    /* Clocks are set up before the device is realized */
+    if (s->conv_timer && !clock_is_enabled(s->clk)) {
+        max78000_adc_cancel(s);
+    }
+}
+
+static void max78000_adc_get_samples(Object *obj, Visitor *v,
+                                     const char *name, void *opaque,
+                                     Error **errp)
+{
+    Max78000AdcChannel *ch = opaque;
+    uint16List *list = NULL;
+    uint32_t i;
+
+    if (ch->fd < 0) {
+        for (i = ch->len; i > ch->pos; i--) {
+            QAPI_LIST_PREPEND(list, le16_to_cpu(ch->buf[i - 1]));
+        }
+    }
+    visit_type_uint16List(v, name, &list, errp);
+    qapi_free_uint16List(list);
+}
+
+static void max78000_adc_set_samples(Object *obj, Visitor *v,
+                                     const char *name, void *opaque,
+                                     Error **errp)
+{
+    Max78000AdcChannel *ch = opaque;
+    uint16List *list = NULL, *l;
+    uint32_t n = 0;
+
+    if (ch->path) {
+        error_setg(errp, "%s: the channel is fed from a file", name);
+        return;
+    }
+    if (!visit_type_uint16List(v, name, &list, errp)) {
+        return;
+    }
+
+    for (l = list; l; l = l->next) {
+        n++;
+    }
+    g_free(ch->buf);
+    ch->buf = g_new(uint16_t, n);
+    for (l = list, n = 0; l; l = l->next) {
+        ch->buf[n++] = cpu_to_le16(l->value);
+    }
+    ch->len = n;
+    ch->pos = 0;
+    qapi_free_uint16List(list);
+}
+
+static void max78000_adc_get_file(Object *obj, Visitor *v, const char *name,
+                                  void *opaque, Error **errp)
+{
+    Max78000AdcChannel *ch = opaque;
+    char *path = g_strdup(ch->path ?: "");
+
+    visit_type_str(v, name, &path, errp);
+    g_free(path);
+}
+
+static void max78000_adc_set_file(Object *obj, Visitor *v, const char *name,
+                                  void *opaque, Error **errp)
+{
+    Max78000AdcChannel *ch = opaque;
+    char *path;
+
+    if (DEVICE(obj)->realized) {
+        error_setg(errp, "%s: cannot be changed after realize", name);
+        return;
+    }
+    if (!visit_type_str(v, name, &path, errp)) {
+        return;
+    }
+    g_free(ch->path);
+    ch->path = *path ? path : NULL;
+    if (!ch->path) {
+        g_free(path);
+    }
+}
+
+static void max78000_adc_reset_hold(Object *obj, ResetType type)
+{
+    Max78000AdcState *s = MAX78000_ADC(obj);
+
+    timer_del(s->conv_timer);
+    s->ctrl = 0;
+    s->status = 0;
+    s->data = 0;
+    s->intr = 0;
+    memset(s->limit, 0, sizeof(s->limit));
+}
+
+static void max78000_adc_reset_exit(Object *obj, ResetType type)
+{
+    Max78000AdcState *s = MAX78000_ADC(obj);
+
+    max78000_adc_update_irq(s);
+}
+
+static const MemoryRegionOps max78000_adc_ops = {
+    .read = max78000_adc_read,
+    .write = max78000_adc_write,
+    .endianness = DEVICE_LITTLE_ENDIAN,
+    .valid.min_access_size = 4,
+    .valid.max_access_size = 4,
+};
+
+/* The input samples are host-side and are not migrated */
+static const VMStateDescription vmstate_max78000_adc = {
+    .name = TYPE_MAX78000_ADC,
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(ctrl, Max78000AdcState),
+        VMSTATE_UINT32(status, Max78000AdcState),
+        VMSTATE_UINT32(data, Max78000AdcState),
+        VMSTATE_UINT32(intr, Max78000AdcState),
+        VMSTATE_UINT32_ARRAY(limit, Max78000AdcState, ADC_NUM_LIMITS),
+        VMSTATE_TIMER_PTR(conv_timer, Max78000AdcState),
+        VMSTATE_CLOCK(clk, Max78000AdcState),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static void max78000_adc_init(Object *obj)
+{
+    Max78000AdcState *s = MAX78000_ADC(obj);
+    int i;
+
+    sysbus_init_irq(SYS_BUS_DEVICE(obj), &s->irq);
+
+    s->clk = qdev_init_clock_in(DEVICE(obj), "clk", max78000_adc_clk_update,
+                                s, ClockUpdate);
+
+    memory_region_init_io(&s->mmio, obj, &max78000_adc_ops, s,
+                          TYPE_MAX78000_ADC, 0x1000);
+    sysbus_init_mmio(SYS_BUS_DEVICE(obj), &s->mmio);
+
+    for (i = 0; i < ADC_NUM_CHANNELS; i++) {
+        s->ch[i].fd = -1;
+        object_property_add(obj, "samples[*]", "uint16List",
+                            max78000_adc_get_samples,
+                            max78000_adc_set_samples, NULL, &s->ch[i]);
+        object_property_add(obj, "file[*]", "str",
+                            max78000_adc_get_file,
+                            max78000_adc_set_file, NULL, &s->ch[i]);
+    }
+}
+
+static void max78000_adc_realize(DeviceState *dev, Error **errp)
+{
+    Max78000AdcState *s = MAX78000_ADC(dev);
+    Max78000AdcChannel *ch;
+    int i;
+
+    if (!clock_has_source(s->clk)) {
+        error_setg(errp, "MAX78000 ADC: clk must be connected");
+        return;
+    }
+
+    for (i = 0; i < ADC_NUM_CHANNELS; i++) {
+        ch = &s->ch[i];
+        if (!ch->path) {
+            continue;
+        }
+        ch->fd = qemu_open(ch->path, O_RDONLY, errp);
+        if (ch->fd < 0) {
+            return;
+        }
+        g_free(ch->buf);
+        ch->buf = g_new(uint16_t, ADC_FILE_BATCH);
+        ch->len = 0;
+        ch->pos = 0;
+    }
+
+    s->conv_timer = timer_new_ns(QEMU_CLOCK_VIRTUAL,
+                                 max78000_adc_convert_done, s);
+}
+
+static void max78000_adc_class_init(ObjectClass *klass, const void *data)
+{
+    ResettableClass *rc = RESETTABLE_CLASS(klass);
+    DeviceClass *dc = DEVICE_CLASS(klass);
+
+    rc->phases.hold = max78000_adc_reset_hold;
+    rc->phases.exit = max78000_adc_reset_exit;
+    dc->realize = max78000_adc_realize;
+    dc->vmsd = &vmstate_max78000_adc;
+}
+
+static const TypeInfo max78000_adc_info = {
+    .name          = TYPE_MAX78000_ADC,
+    .parent        = TYPE_SYS_BUS_DEVICE,
+    .instance_size = sizeof(Max78000AdcState),
+    .instance_init = max78000_adc_init,
+    .class_init    = max78000_adc_class_init,
+};
+
+static void max78000_adc_register_types(void)
+{
+    type_register_static(&max78000_adc_info);
+}
+
+type_init(max78000_adc_register_types)
@@ -15,13 +15,59 @@
 #include "system/system.h"
 #include "hw/arm/max78000_soc.h"
 #include "hw/qdev-clock.h"
+#include "hw/qdev-properties.h"
 #include "hw/misc/unimp.h"
 
 static const uint32_t max78000_icc_addr[] = {0x4002a000, 0x4002a800};
+/* UART3 is the low power UART, in the LPGCR's clock and reset domain */
 static const uint32_t max78000_uart_addr[] = {0x40042000, 0x40043000,
-                                              0x40044000};
-
-static const int max78000_uart_irq[] = {14, 15, 34};
+                                              0x40044000, 0x40081400};
+
+static const int max78000_uart_irq[] = {14, 15, 34, 88};
+static const int max78000_uart_dma_rx[MAX78000_NUM_HS_UART] = {
+    DMA_REQ_UART0_RX, DMA_REQ_UART1_RX, DMA_REQ_UART2_RX};
+static const int max78000_uart_dma_tx[MAX78000_NUM_HS_UART] = {
+    DMA_REQ_UART0_TX, DMA_REQ_UART1_TX, DMA_REQ_UART2_TX};
+
+static const uint32_t max78000_tmr_addr[] = {0x40010000, 0x40011000,
+                                             0x40012000, 0x40013000,
+                                             0x40080c00, 0x40081000};
+
+static const uint32_t max78000_gpio_addr[] = {0x40008000, 0x40009000,
+                                              0x40080400};
+static const int max78000_gpio_irq[] = {24, 25, 26};
+
+static const uint32_t max78000_spi_addr[] = {0x400be000, 0x40046000};
+static const int max78000_spi_irq[] = {56, 16};
+static const int max78000_spi_dma_rx[] = {DMA_REQ_SPI0_RX, DMA_REQ_SPI1_RX};
+static const int max78000_spi_dma_tx[] = {DMA_REQ_SPI0_TX, DMA_REQ_SPI1_TX};
+
+static const uint32_t max78000_i2c_addr[] = {0x4001d000, 0x4001e000,
+                                             0x4001f000};
+static const int max78000_i2c_irq[] = {13, 36, 62};
+static const int max78000_i2c_dma_rx[] = {DMA_REQ_I2C0_RX, DMA_REQ_I2C1_RX,
+                                          DMA_REQ_I2C2_RX};
+static const int max78000_i2c_dma_tx[] = {DMA_REQ_I2C0_TX, DMA_REQ_I2C1_TX,
+                                          DMA_REQ_I2C2_TX};
+
+static const uint32_t max78000_wdt_addr[] = {0x40003000, 0x40080800};
+static const int max78000_wdt_irq[] = {1, 57};
+
+#define MAX78000_DMA_IRQ 28
+#define MAX78000_TMR_IRQ 5
+#define MAX78000_FLC_IRQ 23
+#define MAX78000_WUT_IRQ 53
+#define MAX78000_RTC_IRQ 3
+#define MAX78000_GPIOWAKE_IRQ 54
+
+#define MAX78000_CNN_BASE 0x50100000
+#define MAX78000_CNN_IRQ 82
+
+#define MAX78000_PCIF_IRQ 84
+#define MAX78000_I2S_IRQ 49
+#define MAX78000_ADC_IRQ 20
+#define MAX78000_PT_IRQ 59
+#define MAX78000_OWM_IRQ 67
 
 static void max78000_soc_initfn(Object *obj)
 {
@@ -32,6 +78,10 @@ static void max78000_soc_initfn(Object *obj)
 
     object_initialize_child(obj, "gcr", &s->gcr, TYPE_MAX78000_GCR);
 
+    object_initialize_child(obj, "flc", &s->flc, TYPE_MAX78000_FLC);
+
+    object_initialize_child(obj, "dma", &s->dma, TYPE_MAX78000_DMA);
+
     for (i = 0; i < MAX78000_NUM_ICC; i++) {
         g_autofree char *name = g_strdup_printf("icc%d", i);
         object_initialize_child(obj, name, &s->icc[i], TYPE_MAX78000_ICC);
@@ -47,14 +97,73 @@ static void max78000_soc_initfn(Object *obj)
 
     object_initialize_child(obj, "aes", &s->aes, TYPE_MAX78000_AES);
 
+    object_initialize_child(obj, "crc", &s->crc, TYPE_MAX78000_CRC);
+
+    object_initialize_child(obj, "sema", &s->sema, TYPE_MAX78000_SEMA);
+
+    object_initialize_child(obj, "pcif", &s->pcif, TYPE_MAX78000_PCIF);
+
+    object_initialize_child(obj, "i2s", &s->i2s, TYPE_MAX78000_I2S);
+
+    object_initialize_child(obj, "adc", &s->adc, TYPE_MAX78000_ADC);
+
+    object_initialize_child(obj, "pt", &s->pt, TYPE_MAX78000_PT);
+
+    object_initialize_child(obj, "owm", &s->owm, TYPE_MAX78000_OWM);
+
+    object_initialize_child(obj, "cnn", &s->cnn, TYPE_MAX78000_CNN);
+
+    for (i = 0; i < MAX78000_NUM_TMR; i++) {
+        g_autofree char *name = g_strdup_printf("tmr%d", i);
+        object_initialize_child(obj, name, &s->tmr[i], TYPE_MAX78000_TMR);
+    }
+
+    object_initialize_child(obj, "wut", &s->wut, TYPE_MAX78000_WUT);
+
+    object_initialize_child(obj, "rtc", &s->rtc, TYPE_MAX78000_RTC);
+
+    for (i = 0; i < MAX78000_NUM_WDT; i++) {
+        g_autofree char *name = g_strdup_printf("wdt%d", i);
+        object_initialize_child(obj, name, &s->wdt[i], TYPE_MAX78000_WDT);
+    }
+
+    for (i = 0; i < MAX78000_NUM_GPIO; i++) {
+        g_autofree char *name = g_strdup_printf("gpio%d", i);
+        g_autofree char *alias = g_strdup_printf("gpio%d-stimulus", i);
+        object_initialize_child(obj, name, &s->gpio[i], TYPE_MAX78000_GPIO);
+        object_property_add_alias(obj, alias, OBJECT(&s->gpio[i]), "chardev");
+    }
+
+    for (i = 0; i < MAX78000_NUM_SPI; i++) {
+        g_autofree char *name = g_strdup_printf("spi%d", i);
+        object_initialize_child(obj, name, &s->spi[i], TYPE_MAX78000_SPI);
+    }
+
+    for (i = 0; i < MAX78000_NUM_I2C; i++) {
+        g_autofree char *name = g_strdup_printf("i2c%d", i);
+        object_initialize_child(obj, name, &s->i2c[i], TYPE_MAX78000_I2C);
+    }
+
+    object_initialize_child(obj, "pwrseq", &s->pwrseq, TYPE_MAX78000_PWRSEQ);
+
+    object_initialize_child(obj, "lpgcr", &s->lpgcr, TYPE_MAX78000_LPGCR);
+
+    object_initialize_child(obj, "irq5-orgate", &s->irq5_orgate,
+                            TYPE_OR_IRQ);
+    object_initialize_child(obj, "cpu-irq-split", &s->cpu_irq_split,
+                            TYPE_SPLIT_IRQ);
+
     s->sysclk = qdev_init_clock_in(DEVICE(s), "sysclk", NULL, NULL, 0);
+    /* Peripherals are clocked from PCLK, which runs at half of SYSCLK */
+    s->pclk = clock_new(obj, "pclk");
 }
 
 static void max78000_soc_realize(DeviceState *dev_soc, Error **errp)
 {
     MAX78000State *s = MAX78000_SOC(dev_soc);
     MemoryRegion *system_memory = get_system_memory();
-    DeviceState *dev, *gcrdev, *armv7m;
+    MemoryRegion *flash;
+    DeviceState *dev, *gcrdev, *dmadev, *armv7m;
     SysBusDevice *busdev;
     Error *err = NULL;
     int i;
@@ -64,19 +173,48 @@ static void max78000_soc_realize(DeviceState *dev_soc, Error **errp)
         return;
     }
 
-    memory_region_init_rom(&s->flash, OBJECT(dev_soc), "MAX78000.flash",
-                           FLASH_SIZE, &err);
-    if (err != NULL) {
-        error_propagate(errp, err);
-        return;
+    clock_set_mul_div(s->pclk, 2, 1);
+    clock_set_source(s->pclk, s->sysclk);
+
+    /*
+     * The flash is read-only to the CPU and written through the flash
+     * controller. A file backed memory backend lets its contents be
+     * mapped straight from an image, shared or copy-on-write.
+     */
+    if (s->flash_memdev) {
+        if (host_memory_backend_is_mapped(s->flash_memdev)) {
+            error_setg(errp, "flash-memdev is already in use");
+            return;
+        }
+        if (s->flc.blk) {
+            error_setg(errp, "flash-memdev and a flash drive are mutually "
+                       "exclusive");
+            return;
+        }
+        flash = host_memory_backend_get_memory(s->flash_memdev);
+        if (memory_region_size(flash) != FLASH_SIZE) {
+            error_setg(errp, "flash-memdev must be %d bytes", FLASH_SIZE);
+            return;
+        }
+        host_memory_backend_set_mapped(s->flash_memdev, true);
+        memory_region_set_readonly(flash, true);
+    } else {
+        memory_region_init_rom(&s->flash, OBJECT(dev_soc), "MAX78000.flash",
+                               FLASH_SIZE, &err);
+        if (err != NULL) {
+            error_propagate(errp, err);
+            return;
+        }
+        flash = &s->flash;
     }
 
-    memory_region_add_subregion(system_memory, FLASH_BASE_ADDRESS, &s->flash);
+    memory_region_add_subregion(system_memory, FLASH_BASE_ADDRESS, flash);
 
     memory_region_init_ram(&s->sram, NULL, "MAX78000.sram", SRAM_SIZE,
                            &err);
 
     gcrdev = DEVICE(&s->gcr);
+    qdev_connect_clock_in(gcrdev, "pclk", s->pclk);
     object_property_set_link(OBJECT(gcrdev), "sram", OBJECT(&s->sram),
                                  &err);
 
@@ -105,6 +243,38 @@ static void max78000_soc_realize(DeviceState *dev_soc, Error **errp)
         return;
     }
 
+    object_property_set_int(OBJECT(&s->irq5_orgate), "num-lines", 2,
+                            &error_abort);
+    if (!qdev_realize(DEVICE(&s->irq5_orgate), NULL, errp)) {
+        return;
+    }
+    qdev_connect_gpio_out(DEVICE(&s->irq5_orgate), 0,
+                          qdev_get_gpio_in(armv7m, 5));
+
+    dmadev = DEVICE(&s->dma);
+    object_property_set_link(OBJECT(dmadev), "downstream",
+                             OBJECT(system_memory), &error_abort);
+    if (!sysbus_realize(SYS_BUS_DEVICE(dmadev), errp)) {
+        return;
+    }
+    sysbus_mmio_map(SYS_BUS_DEVICE(dmadev), 0, 0x40028000);
+    for (i = 0; i < DMA_NUM_CHANNELS; i++) {
+        sysbus_connect_irq(SYS_BUS_DEVICE(dmadev), i,
+                           qdev_get_gpio_in(armv7m, MAX78000_DMA_IRQ + i));
+    }
+
+    object_property_set_link(OBJECT(gcrdev), "dma", OBJECT(dmadev), &err);
+
+    dev = DEVICE(&s->flc);
+    object_property_set_link(OBJECT(dev), "flash", OBJECT(flash),
+                             &error_abort);
+    if (!sysbus_realize(SYS_BUS_DEVICE(dev), errp)) {
+        return;
+    }
+    sysbus_mmio_map(SYS_BUS_DEVICE(dev), 0, 0x40029000);
+    sysbus_connect_irq(SYS_BUS_DEVICE(dev), 0,
+                       qdev_get_gpio_in(armv7m, MAX78000_FLC_IRQ));
+
     for (i = 0; i < MAX78000_NUM_ICC; i++) {
         dev = DEVICE(&(s->icc[i]));
         sysbus_realize(SYS_BUS_DEVICE(dev), errp);
@@ -113,22 +283,41 @@ static void max78000_soc_realize(DeviceState *dev_soc, Error **errp)
 
     for (i = 0; i < MAX78000_NUM_UART; i++) {
         g_autofree char *link = g_strdup_printf("uart%d", i);
+        g_autofree char *clk = g_strdup_printf("uart%d-clk", i);
+        DeviceState *ctrl = i < MAX78000_NUM_HS_UART ? gcrdev :
+                                                       DEVICE(&s->lpgcr);
         dev = DEVICE(&(s->uart[i]));
         qdev_prop_set_chr(dev, "chardev", serial_hd(i));
+        qdev_connect_clock_in(dev, "clk", qdev_get_clock_out(ctrl, clk));
         if (!sysbus_realize(SYS_BUS_DEVICE(&s->uart[i]), errp)) {
             return;
         }
 
-        object_property_set_link(OBJECT(gcrdev), link, OBJECT(dev),
+        object_property_set_link(OBJECT(ctrl), link, OBJECT(dev),
                                  &err);
 
         busdev = SYS_BUS_DEVICE(dev);
         sysbus_mmio_map(busdev, 0, max78000_uart_addr[i]);
         sysbus_connect_irq(busdev, 0, qdev_get_gpio_in(armv7m,
                                                        max78000_uart_irq[i]));
+        /* The low power UART has no DMA requests */
+        if (i < MAX78000_NUM_HS_UART) {
+            qdev_connect_gpio_out_named(dev, "dma-rx", 0,
+                    qdev_get_gpio_in_named(dmadev, "request",
+                                           max78000_uart_dma_rx[i]));
+            qdev_connect_gpio_out_named(dev, "dma-tx", 0,
+                    qdev_get_gpio_in_named(dmadev, "request",
+                                           max78000_uart_dma_tx[i]));
+        }
+        qdev_connect_gpio_out_named(dev, "wakeup", 0,
+                qdev_get_gpio_in_named(gcrdev, "wakeup",
+                                       GCR_WAKE_UART0 + i));
     }
 
     dev = DEVICE(&s->trng);
+    object_property_set_link(OBJECT(dev), "aes", OBJECT(&s->aes),
+                             &error_abort);
+    qdev_connect_clock_in(dev, "clk", qdev_get_clock_out(gcrdev, "trng-clk"));
     sysbus_realize(SYS_BUS_DEVICE(dev), errp);
     sysbus_mmio_map(SYS_BUS_DEVICE(dev), 0, 0x4004d000);
     sysbus_connect_irq(SYS_BUS_DEVICE(dev), 0, qdev_get_gpio_in(armv7m, 4));
@@ -136,63 +325,309 @@ static void max78000_soc_realize(DeviceState *dev_soc, Error **errp)
     object_property_set_link(OBJECT(gcrdev), "trng", OBJECT(dev), &err);
 
     dev = DEVICE(&s->aes);
+    qdev_connect_clock_in(dev, "clk", qdev_get_clock_out(gcrdev, "aes-clk"));
     sysbus_realize(SYS_BUS_DEVICE(dev), errp);
     sysbus_mmio_map(SYS_BUS_DEVICE(dev), 0, 0x40007400);
-    sysbus_connect_irq(SYS_BUS_DEVICE(dev), 0, qdev_get_gpio_in(armv7m, 5));
+    sysbus_connect_irq(SYS_BUS_DEVICE(dev), 0,
+                       qdev_get_gpio_in(DEVICE(&s->irq5_orgate), 0));
+    qdev_connect_gpio_out_named(dev, "dma-rx", 0,
+            qdev_get_gpio_in_named(dmadev, "request", DMA_REQ_AES_RX));
+    qdev_connect_gpio_out_named(dev, "dma-tx", 0,
+            qdev_get_gpio_in_named(dmadev, "request", DMA_REQ_AES_TX));
 
     object_property_set_link(OBJECT(gcrdev), "aes", OBJECT(dev), &err);
 
+    dev = DEVICE(&s->crc);
+    qdev_connect_clock_in(dev, "clk", qdev_get_clock_out(gcrdev, "crc-clk"));
+    if (!sysbus_realize(SYS_BUS_DEVICE(dev), errp)) {
+        return;
+    }
+    sysbus_mmio_map(SYS_BUS_DEVICE(dev), 0, 0x4000f000);
+    qdev_connect_gpio_out_named(dev, "dma-tx", 0,
+            qdev_get_gpio_in_named(dmadev, "request", DMA_REQ_CRC_TX));
+
+    object_property_set_link(OBJECT(gcrdev), "crc", OBJECT(dev), &err);
+
+    dev = DEVICE(&s->sema);
+    if (!sysbus_realize(SYS_BUS_DEVICE(dev), errp)) {
+        return;
+    }
+    sysbus_mmio_map(SYS_BUS_DEVICE(dev), 0, 0x4003e000);
+    sysbus_connect_irq(SYS_BUS_DEVICE(dev), 0, qdev_get_gpio_in(armv7m, 63));
+
+    object_property_set_link(OBJECT(gcrdev), "sema", OBJECT(dev), &err);
+
+    dev = DEVICE(&s->pcif);
+    qdev_connect_clock_in(dev, "clk", qdev_get_clock_out(gcrdev, "pcif-clk"));
+    if (!sysbus_realize(SYS_BUS_DEVICE(dev), errp)) {
+        return;
+    }
+    sysbus_mmio_map(SYS_BUS_DEVICE(dev), 0, 0x4000e000);
+    sysbus_connect_irq(SYS_BUS_DEVICE(dev), 0,
+                       qdev_get_gpio_in(armv7m, MAX78000_PCIF_IRQ));
+    qdev_connect_gpio_out_named(dev, "dma-rx", 0,
+            qdev_get_gpio_in_named(dmadev, "request", DMA_REQ_PCIF_RX));
+
+    dev = DEVICE(&s->i2s);
+    qdev_connect_clock_in(dev, "clk", qdev_get_clock_out(gcrdev, "i2s-clk"));
+    if (!sysbus_realize(SYS_BUS_DEVICE(dev), errp)) {
+        return;
+    }
+    sysbus_mmio_map(SYS_BUS_DEVICE(dev), 0, 0x40060000);
+    sysbus_connect_irq(SYS_BUS_DEVICE(dev), 0,
+                       qdev_get_gpio_in(armv7m, MAX78000_I2S_IRQ));
+    qdev_connect_gpio_out_named(dev, "dma-rx", 0,
+            qdev_get_gpio_in_named(dmadev, "request", DMA_REQ_I2S_RX));
+    qdev_connect_gpio_out_named(dev, "dma-tx", 0,
+            qdev_get_gpio_in_named(dmadev, "request", DMA_REQ_I2S_TX));
+
+    object_property_set_link(OBJECT(gcrdev), "i2s", OBJECT(dev), &err);
+
+    dev = DEVICE(&s->adc);
+    qdev_connect_clock_in(dev, "clk", qdev_get_clock_out(gcrdev, "adc-clk"));
+    if (!sysbus_realize(SYS_BUS_DEVICE(dev), errp)) {
+        return;
+    }
+    sysbus_mmio_map(SYS_BUS_DEVICE(dev), 0, 0x40034000);
+    sysbus_connect_irq(SYS_BUS_DEVICE(dev), 0,
+                       qdev_get_gpio_in(armv7m, MAX78000_ADC_IRQ));
+
+    object_property_set_link(OBJECT(gcrdev), "adc", OBJECT(dev), &err);
+
+    dev = DEVICE(&s->pt);
+    qdev_connect_clock_in(dev, "clk", qdev_get_clock_out(gcrdev, "pt-clk"));
+    if (!sysbus_realize(SYS_BUS_DEVICE(dev), errp)) {
+        return;
+    }
+    sysbus_mmio_map(SYS_BUS_DEVICE(dev), 0, 0x4003c000);
+    sysbus_connect_irq(SYS_BUS_DEVICE(dev), 0,
+                       qdev_get_gpio_in(armv7m, MAX78000_PT_IRQ));
+
+    object_property_set_link(OBJECT(gcrdev), "pt", OBJECT(dev), &err);
+
+    dev = DEVICE(&s->owm);
+    qdev_connect_clock_in(dev, "clk", qdev_get_clock_out(gcrdev, "owm-clk"));
+    if (!sysbus_realize(SYS_BUS_DEVICE(dev), errp)) {
+        return;
+    }
+    sysbus_mmio_map(SYS_BUS_DEVICE(dev), 0, 0x4003d000);
+    sysbus_connect_irq(SYS_BUS_DEVICE(dev), 0,
+                       qdev_get_gpio_in(armv7m, MAX78000_OWM_IRQ));
+
+    object_property_set_link(OBJECT(gcrdev), "owm", OBJECT(dev), &err);
+
+    dev = DEVICE(&s->cnn);
+    if (!sysbus_realize(SYS_BUS_DEVICE(dev), errp)) {
+        return;
+    }
+    for (i = 0; i < CNN_NUM_QUADRANTS; i++) {
+        sysbus_mmio_map(SYS_BUS_DEVICE(dev), i,
+                        MAX78000_CNN_BASE + i * CNN_QUAD_SIZE);
+    }
+    sysbus_connect_irq(SYS_BUS_DEVICE(dev), 0,
+                       qdev_get_gpio_in(armv7m, MAX78000_CNN_IRQ));
+
+    object_property_set_link(OBJECT(gcrdev), "cnn", OBJECT(dev), &err);
+
+    for (i = 0; i < MAX78000_NUM_TMR; i++) {
+        g_autofree char *clk = g_strdup_printf("tmr%d-clk", i);
+
+        dev = DEVICE(&s->tmr[i]);
+        qdev_connect_clock_in(dev, "clk",
+                qdev_get_clock_out(i < 4 ? gcrdev : DEVICE(&s->lpgcr), clk));
+        if (!sysbus_realize(SYS_BUS_DEVICE(dev), errp)) {
+            return;
+        }
+        busdev = SYS_BUS_DEVICE(dev);
+        sysbus_mmio_map(busdev, 0, max78000_tmr_addr[i]);
+        if (i == 0) {
+            sysbus_connect_irq(busdev, 0,
+                    qdev_get_gpio_in(DEVICE(&s->irq5_orgate), 1));
+        } else {
+            sysbus_connect_irq(busdev, 0,
+                    qdev_get_gpio_in(armv7m, MAX78000_TMR_IRQ + i));
+        }
+
+        if (i < 4) {
+            g_autofree char *link = g_strdup_printf("tmr%d", i);
+            object_property_set_link(OBJECT(gcrdev), link, OBJECT(dev),
+                                     &err);
+        }
+    }
+
+    for (i = 0; i < MAX78000_NUM_SPI; i++) {
+        g_autofree char *link = g_strdup_printf("spi%d", i);
+        g_autofree char *clk = g_strdup_printf("spi%d-clk", i);
+
+        dev = DEVICE(&s->spi[i]);
+        qdev_connect_clock_in(dev, "clk", qdev_get_clock_out(gcrdev, clk));
+        if (!sysbus_realize(SYS_BUS_DEVICE(dev), errp)) {
+            return;
+        }
+        busdev = SYS_BUS_DEVICE(dev);
+        sysbus_mmio_map(busdev, 0, max78000_spi_addr[i]);
+        sysbus_connect_irq(busdev, 0,
+                           qdev_get_gpio_in(armv7m, max78000_spi_irq[i]));
+        qdev_connect_gpio_out_named(dev, "dma-rx", 0,
+                qdev_get_gpio_in_named(dmadev, "request",
+                                       max78000_spi_dma_rx[i]));
+        qdev_connect_gpio_out_named(dev, "dma-tx", 0,
+                qdev_get_gpio_in_named(dmadev, "request",
+                                       max78000_spi_dma_tx[i]));
+
+        object_property_set_link(OBJECT(gcrdev), link, OBJECT(dev), &err);
+    }
+
+    for (i = 0; i < MAX78000_NUM_I2C; i++) {
+        g_autofree char *link = g_strdup_printf("i2c%d", i);
+        g_autofree char *clk = g_strdup_printf("i2c%d-clk", i);
+
+        dev = DEVICE(&s->i2c[i]);
+        qdev_connect_clock_in(dev, "clk", qdev_get_clock_out(gcrdev, clk));
+        if (!sysbus_realize(SYS_BUS_DEVICE(dev), errp)) {
+            return;
+        }
+        busdev = SYS_BUS_DEVICE(dev);
+        sysbus_mmio_map(busdev, 0, max78000_i2c_addr[i]);
+        sysbus_connect_irq(busdev, 0,
+                           qdev_get_gpio_in(armv7m, max78000_i2c_irq[i]));
+        qdev_connect_gpio_out_named(dev, "dma-rx", 0,
+                qdev_get_gpio_in_named(dmadev, "request",
+                                       max78000_i2c_dma_rx[i]));
+        qdev_connect_gpio_out_named(dev, "dma-tx", 0,
+                qdev_get_gpio_in_named(dmadev, "request",
+                                       max78000_i2c_dma_tx[i]));
+
+        object_property_set_link(OBJECT(gcrdev), link, OBJECT(dev), &err);
+    }
+
+    dev = DEVICE(&s->wut);
+    if (!sysbus_realize(SYS_BUS_DEVICE(dev), errp)) {
+        return;
+    }
+    sysbus_mmio_map(SYS_BUS_DEVICE(dev), 0, 0x40006400);
+    sysbus_connect_irq(SYS_BUS_DEVICE(dev), 0,
+                       qdev_get_gpio_in(armv7m, MAX78000_WUT_IRQ));
+    qdev_connect_gpio_out_named(dev, "wakeup", 0,
+            qdev_get_gpio_in_named(gcrdev, "wakeup", GCR_WAKE_WUT));
+
+    object_property_set_link(OBJECT(gcrdev), "wut", OBJECT(dev), &err);
+
+    dev = DEVICE(&s->rtc);
+    if (!sysbus_realize(SYS_BUS_DEVICE(dev), errp)) {
+        return;
+    }
+    sysbus_mmio_map(SYS_BUS_DEVICE(dev), 0, 0x40006000);
+    sysbus_connect_irq(SYS_BUS_DEVICE(dev), 0,
+                       qdev_get_gpio_in(armv7m, MAX78000_RTC_IRQ));
+    qdev_connect_gpio_out_named(dev, "wakeup", 0,
+            qdev_get_gpio_in_named(gcrdev, "wakeup", GCR_WAKE_RTC));
+
+    object_property_set_link(OBJECT(gcrdev), "rtc", OBJECT(dev), &err);
+
+    dev = DEVICE(&s->pwrseq);
+    if (!sysbus_realize(SYS_BUS_DEVICE(dev), errp)) {
+        return;
+    }
+    sysbus_mmio_map(SYS_BUS_DEVICE(dev), 0, 0x40006800);
+    sysbus_connect_irq(SYS_BUS_DEVICE(dev), 0,
+                       qdev_get_gpio_in(armv7m, MAX78000_GPIOWAKE_IRQ));
+    qdev_connect_gpio_out_named(dev, "wakeup", 0,
+            qdev_get_gpio_in_named(gcrdev, "wakeup", GCR_WAKE_GPIO));
+
+    for (i = 0; i < MAX78000_NUM_GPIO; i++) {
+        g_autofree char *clk = g_strdup_printf("gpio%d-clk", i);
+        int pin;
+
+        dev = DEVICE(&s->gpio[i]);
+        qdev_connect_clock_in(dev, "clk",
+                qdev_get_clock_out(i < 2 ? gcrdev : DEVICE(&s->lpgcr), clk));
+        if (!sysbus_realize(SYS_BUS_DEVICE(dev), errp)) {
+            return;
+        }
+        busdev = SYS_BUS_DEVICE(dev);
+        sysbus_mmio_map(busdev, 0, max78000_gpio_addr[i]);
+        sysbus_connect_irq(busdev, 0,
+                           qdev_get_gpio_in(armv7m, max78000_gpio_irq[i]));
+        for (pin = 0; pin < GPIO_NUM_PINS; pin++) {
+            qdev_connect_gpio_out_named(dev, "wakeup", pin,
+                    qdev_get_gpio_in_named(DEVICE(&s->pwrseq), "gpio-wake",
+                                           i * PWRSEQ_PINS_PER_PORT + pin));
+        }
+
+        if (i < 2) {
+            g_autofree char *link = g_strdup_printf("gpio%d", i);
+            object_property_set_link(OBJECT(gcrdev), link, OBJECT(dev),
+                                     &err);
+        }
+    }
+
+    for (i = 0; i < MAX78000_NUM_WDT; i++) {
+        g_autofree char *clk = g_strdup_printf("wdt%d-clk", i);
+
+        dev = DEVICE(&s->wdt[i]);
+        qdev_connect_clock_in(dev, "clk",
+                qdev_get_clock_out(i == 0 ? gcrdev : DEVICE(&s->lpgcr), clk));
+        if (!sysbus_realize(SYS_BUS_DEVICE(dev), errp)) {
+            return;
+        }
+        sysbus_mmio_map(SYS_BUS_DEVICE(dev), 0, max78000_wdt_addr[i]);
+        sysbus_connect_irq(SYS_BUS_DEVICE(dev), 0,
+                           qdev_get_gpio_in(armv7m, max78000_wdt_irq[i]));
+    }
+    object_property_set_link(OBJECT(gcrdev), "wdt0", OBJECT(&s->wdt[0]),
+                             &err);
+
+    dev = DEVICE(&s->lpgcr);
+    qdev_connect_clock_in(dev, "pclk", s->pclk);
+    object_property_set_link(OBJECT(dev), "tmr4", OBJECT(&s->tmr[4]),
+                             &error_abort);
+    object_property_set_link(OBJECT(dev), "tmr5", OBJECT(&s->tmr[5]),
+                             &error_abort);
+    object_property_set_link(OBJECT(dev), "gpio2", OBJECT(&s->gpio[2]),
+                             &error_abort);
+    object_property_set_link(OBJECT(dev), "wdt1", OBJECT(&s->wdt[1]),
+                             &error_abort);
+    if (!sysbus_realize(SYS_BUS_DEVICE(dev), errp)) {
+        return;
+    }
+    sysbus_mmio_map(SYS_BUS_DEVICE(dev), 0, 0x40080000);
+
+    object_property_set_link(OBJECT(gcrdev), "cpu", OBJECT(s->armv7m.cpu),
+                             &error_abort);
+
     dev = DEVICE(&s->gcr);
     sysbus_realize(SYS_BUS_DEVICE(dev), errp);
     sysbus_mmio_map(SYS_BUS_DEVICE(dev), 0, 0x40000000);
 
+    /*
+     * Any exception that un-halts the core also ends a low power mode
+     * entered through the GCR, so the NVIC output is shared with it.
+     */
+    dev = DEVICE(&s->cpu_irq_split);
+    object_property_set_int(OBJECT(dev), "num-lines", 2, &error_abort);
+    if (!qdev_realize(dev, NULL, errp)) {
+        return;
+    }
+    qdev_connect_gpio_out(dev, 0,
+            qdev_get_gpio_in(DEVICE(s->armv7m.cpu), ARM_CPU_IRQ));
+    qdev_connect_gpio_out(dev, 1,
+            qdev_get_gpio_in_named(gcrdev, "wakeup", GCR_WAKE_NVIC));
+    sysbus_connect_irq(SYS_BUS_DEVICE(&s->armv7m.nvic), 0,
+                       qdev_get_gpio_in(dev, 0));
+
     create_unimplemented_device("systemInterface",      0x40000400, 0x400);
     create_unimplemented_device("functionControl",      0x40000800, 0x400);
-    create_unimplemented_device("watchdogTimer0",       0x40003000, 0x400);
     create_unimplemented_device("dynamicVoltScale",     0x40003c00, 0x40);
     create_unimplemented_device("SIMO",                 0x40004400, 0x400);
     create_unimplemented_device("trimSystemInit",       0x40005400, 0x400);
     create_unimplemented_device("generalCtrlFunc",      0x40005800, 0x400);
-    create_unimplemented_device("wakeupTimer",          0x40006400, 0x400);
-    create_unimplemented_device("powerSequencer",       0x40006800, 0x400);
     create_unimplemented_device("miscControl",          0x40006c00, 0x400);
 
-    create_unimplemented_device("gpio0",                0x40008000, 0x1000);
-    create_unimplemented_device("gpio1",                0x40009000, 0x1000);
 
-    create_unimplemented_device("parallelCamInterface", 0x4000e000, 0x1000);
-    create_unimplemented_device("CRC",                  0x4000f000, 0x1000);
 
-    create_unimplemented_device("timer0",               0x40010000, 0x1000);
-    create_unimplemented_device("timer1",               0x40011000, 0x1000);
-    create_unimplemented_device("timer2",               0x40012000, 0x1000);
-    create_unimplemented_device("timer3",               0x40013000, 0x1000);
-
-    create_unimplemented_device("i2c0",                 0x4001d000, 0x1000);
-    create_unimplemented_device("i2c1",                 0x4001e000, 0x1000);
-    create_unimplemented_device("i2c2",                 0x4001f000, 0x1000);
-
-    create_unimplemented_device("standardDMA",          0x40028000, 0x1000);
-    create_unimplemented_device("flashController0",     0x40029000, 0x400);
-
-    create_unimplemented_device("adc",                  0x40034000, 0x1000);
-    create_unimplemented_device("pulseTrainEngine",     0x4003c000, 0xa0);
-    create_unimplemented_device("oneWireMaster",        0x4003d000, 0x1000);
-    create_unimplemented_device("semaphore",            0x4003e000, 0x1000);
-
-    create_unimplemented_device("spi1",                 0x40046000, 0x2000);
-    create_unimplemented_device("i2s",                  0x40060000, 0x1000);
-    create_unimplemented_device("lowPowerControl",      0x40080000, 0x400);
-    create_unimplemented_device("gpio2",                0x40080400, 0x200);
-    create_unimplemented_device("lowPowerWatchdogTimer",    0x40080800, 0x400);
-    create_unimplemented_device("lowPowerTimer4",       0x40080c00, 0x400);
-
-    create_unimplemented_device("lowPowerTimer5",       0x40081000, 0x400);
-    create_unimplemented_device("lowPowerUART0",        0x40081400, 0x400);
     create_unimplemented_device("lowPowerComparator",   0x40088000, 0x400);
 
-    create_unimplemented_device("spi0",                 0x400be000, 0x400);
-
     /*
      * The MAX78000 user guide's base address map lists the CNN TX FIFO as
      * beginning at 0x400c0400 and ending at 0x400c0400. Given that CNN_FIFO
@@ -202,18 +637,20 @@ static void max78000_soc_realize(DeviceState *dev_soc, Error **errp)
     create_unimplemented_device("cnnTxFIFO",            0x400c0400, 0x2000);
 
     create_unimplemented_device("cnnGlobalControl",     0x50000000, 0x10000);
-    create_unimplemented_device("cnnx16quad0",          0x50100000, 0x40000);
-    create_unimplemented_device("cnnx16quad1",          0x50500000, 0x40000);
-    create_unimplemented_device("cnnx16quad2",          0x50900000, 0x40000);
-    create_unimplemented_device("cnnx16quad3",          0x50d00000, 0x40000);
 
 }
 
+static const Property max78000_soc_properties[] = {
+    DEFINE_PROP_LINK("flash-memdev", MAX78000State, flash_memdev,
+                     TYPE_MEMORY_BACKEND, HostMemoryBackend *),
+};
+
 static void max78000_soc_class_init(ObjectClass *klass, const void *data)
 {
     DeviceClass *dc = DEVICE_CLASS(klass);
 
     dc->realize = max78000_soc_realize;
+    device_class_set_props(dc, max78000_soc_properties);
 }
 
 static const TypeInfo max78000_soc_info = {
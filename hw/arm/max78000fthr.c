@@ -7,18 +7,164 @@
  */
 
 #include "qemu/osdep.h"
+#include "qemu/main-loop.h"
 #include "qapi/error.h"
+#include "qapi/qapi-commands-migration.h"
+#include "qapi/qapi-commands-misc.h"
 #include "hw/boards.h"
+#include "hw/irq.h"
 #include "hw/qdev-properties.h"
 #include "hw/qdev-clock.h"
+#include "hw/i2c/i2c.h"
+#include "hw/sd/sd.h"
+#include "hw/sensor/tmp105.h"
+#include "hw/ssi/ssi.h"
 #include "qemu/error-report.h"
+#include "system/blockdev.h"
+#include "system/block-backend.h"
+#include "system/runstate.h"
+#include "migration/misc.h"
 #include "hw/arm/max78000_soc.h"
 #include "hw/arm/boot.h"
 
 /* 60MHz is the default, but other clocks can be selected. */
 #define SYSCLK_FRQ 60000000ULL
+
+#define TYPE_MAX78000FTHR_MACHINE MACHINE_TYPE_NAME("max78000fthr")
+OBJECT_DECLARE_SIMPLE_TYPE(Max78000FthrMachineState, MAX78000FTHR_MACHINE)
+
+struct Max78000FthrMachineState {
+    MachineState parent_obj;
+
+    /* File the machine is saved to when the firmware signals it is ready */
+    char *ready_snapshot;
+    bool ready_seen;
+    bool stopping;
+    bool saving;
+    NotifierWithReturn migration_notifier;
+};
+
+/*
+ * Saving the machine at the firmware's "ready" point lets later runs
+ * skip its initialisation by restoring it with -incoming. The ready
+ * write stops the vCPU on the spot, so the snapshot is the same on every
+ * run; the machine is then migrated to the file and resumes.
+ */
+static void max78000fthr_resume(void *opaque)
+{
+    Error *err = NULL;
+
+    if (!runstate_is_running()) {
+        qmp_cont(&err);
+        if (err) {
+            error_report_err(err);
+        }
+    }
+}
+
+static void max78000fthr_save(void *opaque)
+{
+    Max78000FthrMachineState *m = opaque;
+    g_autofree char *uri = g_strdup_printf("file:%s", m->ready_snapshot);
+    Error *err = NULL;
+
+    qmp_migrate(uri, false, NULL, false, false, false, false, &err);
+    if (err) {
+        error_reportf_err(err, "max78000fthr: saving %s failed: ",
+                          m->ready_snapshot);
+        m->saving = false;
+        max78000fthr_resume(m);
+    }
+}
+
+static void max78000fthr_vm_state_change(void *opaque, bool running,
+                                         RunState state)
+{
+    Max78000FthrMachineState *m = opaque;
+
+    if (running || !m->stopping) {
+        return;
+    }
+    m->stopping = false;
+    m->saving = true;
+    aio_bh_schedule_oneshot(qemu_get_aio_context(), max78000fthr_save, m);
+}
+
+static int max78000fthr_migration_event(NotifierWithReturn *notifier,
+                                        MigrationEvent *e, Error **errp)
+{
+    Max78000FthrMachineState *m = container_of(notifier,
+                                               Max78000FthrMachineState,
+                                               migration_notifier);
+
+    if (!m->saving || e->type == MIG_EVENT_PRECOPY_SETUP) {
+        return 0;
+    }
+    m->saving = false;
+    aio_bh_schedule_oneshot(qemu_get_aio_context(), max78000fthr_resume, m);
+    return 0;
+}
+
+static void max78000fthr_ready(void *opaque, int n, int level)
+{
+    Max78000FthrMachineState *m = opaque;
+
+    if (!level || !m->ready_snapshot || m->ready_seen) {
+        return;
+    }
+    m->ready_seen = true;
+    m->stopping = true;
+    vm_stop(RUN_STATE_PAUSED);
+}
+
+static char *max78000fthr_get_ready_snapshot(Object *obj, Error **errp)
+{
+    return g_strdup(MAX78000FTHR_MACHINE(obj)->ready_snapshot);
+}
+
+static void max78000fthr_set_ready_snapshot(Object *obj, const char *value,
+                                            Error **errp)
+{
+    Max78000FthrMachineState *m = MAX78000FTHR_MACHINE(obj);
+
+    g_free(m->ready_snapshot);
+    m->ready_snapshot = g_strdup(value);
+}
+
+/* The microSD slot sits on SPI0, selected by SS0 */
+static void max78000fthr_init_sd(MAX78000State *soc)
+{
+    DriveInfo *dinfo = drive_get(IF_SD, 0, 0);
+    BlockBackend *blk = dinfo ? blk_by_legacy_dinfo(dinfo) : NULL;
+    DeviceState *sd_dev, *card_dev;
+
+    sd_dev = ssi_create_peripheral(soc->spi[0].bus, "ssi-sd");
+    qdev_connect_gpio_out_named(DEVICE(&soc->spi[0]), SSI_GPIO_CS, 0,
+                                qdev_get_gpio_in_named(sd_dev, SSI_GPIO_CS, 0));
+
+    card_dev = qdev_new(TYPE_SD_CARD_SPI);
+    qdev_prop_set_drive_err(card_dev, "drive", blk, &error_fatal);
+    qdev_realize_and_unref(card_dev, qdev_get_child_bus(sd_dev, "sd-bus"),
+                           &error_fatal);
+}
+
+/*
+ * The FTHR's own I2C parts (PMIC, audio codec, camera) have no model;
+ * a temperature sensor and a magnetometer stand in for sensors on the
+ * Feather header's I2C1.
+ */
+static void max78000fthr_init_i2c(MAX78000State *soc)
+{
+    I2CBus *bus = soc->i2c[1].bus;
+
+    i2c_slave_create_simple(bus, TYPE_TMP105, 0x48);
+    i2c_slave_create_simple(bus, "lsm303dlhc_mag", 0x1e);
+}
+
 static void max78000_init(MachineState *machine)
 {
+    Max78000FthrMachineState *m = MAX78000FTHR_MACHINE(machine);
+    DriveInfo *dinfo;
     DeviceState *dev;
     Clock *sysclk;
 
@@ -27,16 +173,33 @@ static void max78000_init(MachineState *machine)
 
     dev = qdev_new(TYPE_MAX78000_SOC);
     object_property_add_child(OBJECT(machine), "soc", OBJECT(dev));
+    dinfo = drive_get(IF_PFLASH, 0, 0);
+    if (dinfo) {
+        qdev_prop_set_drive_err(DEVICE(&MAX78000_SOC(dev)->flc), "drive",
+                                blk_by_legacy_dinfo(dinfo), &error_fatal);
+    }
     qdev_connect_clock_in(dev, "sysclk", sysclk);
     sysbus_realize_and_unref(SYS_BUS_DEVICE(dev), &error_fatal);
 
+    max78000fthr_init_sd(MAX78000_SOC(dev));
+    max78000fthr_init_i2c(MAX78000_SOC(dev));
+
+    qdev_connect_gpio_out_named(DEVICE(&MAX78000_SOC(dev)->gcr), "ready", 0,
+                                qemu_allocate_irq(max78000fthr_ready, m, 0));
+    if (m->ready_snapshot) {
+        qemu_add_vm_change_state_handler(max78000fthr_vm_state_change, m);
+        migration_add_notifier(&m->migration_notifier,
+                               max78000fthr_migration_event);
+    }
+
     armv7m_load_kernel(ARM_CPU(first_cpu),
                        machine->kernel_filename,
                        0x00000000, FLASH_SIZE);
 }
 
-static void max78000_machine_init(MachineClass *mc)
+static void max78000_machine_class_init(ObjectClass *oc, const void *data)
 {
+    MachineClass *mc = MACHINE_CLASS(oc);
     static const char * const valid_cpu_types[] = {
         ARM_CPU_TYPE_NAME("cortex-m4"),
         NULL
@@ -45,6 +208,23 @@ static void max78000_machine_init(MachineClass *mc)
     mc->desc = "MAX78000FTHR Board (Cortex-M4 / (Unimplemented) RISC-V)";
     mc->init = max78000_init;
     mc->valid_cpu_types = valid_cpu_types;
+
+    object_class_property_add_str(oc, "ready-snapshot",
+                                  max78000fthr_get_ready_snapshot,
+                                  max78000fthr_set_ready_snapshot);
+    object_class_property_set_description(oc, "ready-snapshot",
+                                          "Save the machine to this file "
+                                          "when the firmware writes "
+                                          "GCR_READY_MAGIC to GCR offset 0x3c");
 }
 
-DEFINE_MACHINE("max78000fthr", max78000_machine_init)
+static const TypeInfo max78000_machine_types[] = {
+    {
+        .name          = TYPE_MAX78000FTHR_MACHINE,
+        .parent        = TYPE_MACHINE,
+        .instance_size = sizeof(Max78000FthrMachineState),
+        .class_init    = max78000_machine_class_init,
+    },
+};
+
+DEFINE_TYPES(max78000_machine_types)
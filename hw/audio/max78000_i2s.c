@@ -0,0 +1,834 @@
+/*
+ * MAX78000 I2S
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Channel 0 of the I2S controller, as bus master. Each FIFO entry holds
+ * one right aligned sample; the PDM filter, the external clock and the
+ * bit ordering controls are stored but have no effect.
+ *
+ * The word select clock runs at
+ *
+ *     clk / (2 * (CLKDIV + 1)) / (2 * (BITS_WORD + 1))
+ *
+ * frames per second of virtual time, counted exactly from when the
+ * interface was started. Samples are only moved when the guest accesses
+ * the controller, or when a FIFO reaches a level that raises an enabled
+ * interrupt or DMA request. Stretches with nothing to do therefore cost
+ * nothing, and a long recording can be replayed faster than real time
+ * under -icount.
+ *
+ * Received samples come from the "in-wav" file or, as raw 16 bit mono
+ * little endian samples, from the "chardev". Both are read in large
+ * blocks. The source's own sample rate is ignored, and once it runs dry
+ * the microphone reads silence. Transmitted samples are written to the
+ * "out-wav" file, at the rate and sample size programmed when the first
+ * one is sent.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/log.h"
+#include "qemu/bswap.h"
+#include "qemu/error-report.h"
+#include "qemu/host-utils.h"
+#include "qemu/timer.h"
+#include "qapi/error.h"
+#include "system/system.h"
+#include "trace.h"
+#include "hw/irq.h"
+#include "hw/qdev-clock.h"
+#include "hw/qdev-properties.h"
+#include "hw/qdev-properties-system.h"
+#include "migration/vmstate.h"
+#include "hw/audio/max78000_i2s.h"
+
+#define WAV_HEADER_SIZE 44
+#define WAV_MAX_CHANNELS 8
+
+static unsigned max78000_i2s_word_bits(Max78000I2sState *s)
+{
+    return (s->ctrl1ch0 & I2S_CTRL1_BITS_WORD_MASK) + 1;
+}
+
+static unsigned max78000_i2s_sample_bits(Max78000I2sState *s)
+{
+    unsigned smp = (s->ctrl1ch0 >> I2S_CTRL1_SMP_SIZE_SHIFT) &
+                   I2S_CTRL1_SMP_SIZE_MASK;
+
+    return smp ? smp + 1 : max78000_i2s_word_bits(s);
+}
+
+/* Input clock cycles per frame */
+static uint32_t max78000_i2s_frame_div(Max78000I2sState *s)
+{
+    uint32_t clkdiv = (s->ctrl1ch0 >> I2S_CTRL1_CLKDIV_SHIFT) &
+                      I2S_CTRL1_CLKDIV_MASK;
+
+    return 4 * (clkdiv + 1) * max78000_i2s_word_bits(s);
+}
+
+/* The left (bit 0) and right (bit 1) slots that are transferred */
+static unsigned max78000_i2s_slots(Max78000I2sState *s)
+{
+    switch ((s->ctrl0ch0 >> I2S_CTRL0_STEREO_SHIFT) & I2S_CTRL0_STEREO_MASK) {
+    case I2S_STEREO_MONO_LEFT:
+        return 1;
+    case I2S_STEREO_MONO_RIGHT:
+        return 2;
+    default:
+        return 3;
+    }
+}
+
+static uint32_t max78000_i2s_rx_thd(Max78000I2sState *s)
+{
+    return MIN((s->ctrl0ch0 >> I2S_CTRL0_RX_THD_SHIFT) &
+               I2S_CTRL0_RX_THD_MASK, I2S_FIFO_DEPTH - 1);
+}
+
+static uint32_t max78000_i2s_dma_rx_thd(Max78000I2sState *s)
+{
+    return MIN((s->dmach0 >> I2S_DMA_RX_THD_SHIFT) & I2S_DMA_RX_THD_MASK,
+               I2S_FIFO_DEPTH - 1);
+}
+
+static uint32_t max78000_i2s_dma_tx_thd(Max78000I2sState *s)
+{
+    return MIN(s->dmach0 & I2S_DMA_TX_THD_MASK, I2S_FIFO_DEPTH - 1);
+}
+
+static bool max78000_i2s_running(Max78000I2sState *s)
+{
+    return (s->ctrl1ch0 & I2S_CTRL1_EN) &&
+           (s->ctrl0ch0 & (I2S_CTRL0_TX_EN | I2S_CTRL0_RX_EN)) &&
+           clock_is_enabled(s->clk);
+}
+
+/* Make sure need bytes of input are buffered */
+static bool max78000_i2s_in_fill(Max78000I2sState *s, uint32_t need)
+{
+    ssize_t ret;
+
+    if (s->in_len - s->in_pos >= need) {
+        return true;
+    }
+
+    memmove(s->in_buf, s->in_buf + s->in_pos, s->in_len - s->in_pos);
+    s->in_len -= s->in_pos;
+    s->in_pos = 0;
+
+    while (s->in_len < need && s->in_left) {
+        ret = read(s->in_fd, s->in_buf + s->in_len,
+                   MIN(I2S_STREAM_BUF_SIZE - s->in_len, s->in_left));
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            s->in_left = 0;
+            break;
+        }
+        s->in_len += ret;
+        s->in_left -= ret;
+    }
+    return s->in_len >= need;
+}
+
+/* The next input frame, as left aligned left and right samples */
+static void max78000_i2s_in_frame(Max78000I2sState *s, int32_t frame[2])
+{
+    uint32_t bytes = s->in_bits / 8;
+    uint8_t sample[2];
+    const uint8_t *p;
+    int ch;
+
+    frame[0] = frame[1] = 0;
+
+    if (s->in_fd >= 0) {
+        if (!max78000_i2s_in_fill(s, bytes * s->in_channels)) {
+            return;
+        }
+        p = s->in_buf + s->in_pos;
+        s->in_pos += bytes * s->in_channels;
+        for (ch = 0; ch < MIN(s->in_channels, 2); ch++, p += bytes) {
+            switch (s->in_bits) {
+            case 8:
+                /* 8 bit WAV samples are unsigned */
+                frame[ch] = (uint32_t)(p[0] ^ 0x80) << 24;
+                break;
+            case 16:
+                frame[ch] = (uint32_t)lduw_le_p(p) << 16;
+                break;
+            case 24:
+                frame[ch] = (uint32_t)(p[0] | p[1] << 8 | p[2] << 16) << 8;
+                break;
+            case 32:
+                frame[ch] = ldl_le_p(p);
+                break;
+            }
+        }
+    } else if (fifo8_num_used(&s->chr_fifo) >= 2) {
+        sample[0] = fifo8_pop(&s->chr_fifo);
+        sample[1] = fifo8_pop(&s->chr_fifo);
+        frame[0] = (uint32_t)lduw_le_p(sample) << 16;
+        qemu_chr_fe_accept_input(&s->chr);
+    }
+
+    if (s->in_channels == 1) {
+        frame[1] = frame[0];
+    }
+}
+
+static void max78000_i2s_out_header(Max78000I2sState *s)
+{
+    uint32_t align = s->out_channels * s->out_bits / 8;
+    uint32_t size = MIN(s->out_size, UINT32_MAX - 36);
+    uint8_t hdr[WAV_HEADER_SIZE];
+
+    memcpy(hdr, "RIFF", 4);
+    stl_le_p(hdr + 4, size + 36);
+    memcpy(hdr + 8, "WAVEfmt ", 8);
+    stl_le_p(hdr + 16, 16);
+    stw_le_p(hdr + 20, 1);
+    stw_le_p(hdr + 22, s->out_channels);
+    stl_le_p(hdr + 24, s->out_rate);
+    stl_le_p(hdr + 28, s->out_rate * align);
+    stw_le_p(hdr + 32, align);
+    stw_le_p(hdr + 34, s->out_bits);
+    memcpy(hdr + 36, "data", 4);
+    stl_le_p(hdr + 40, size);
+
+    if (pwrite(s->out_fd, hdr, sizeof(hdr), 0) != sizeof(hdr)) {
+        error_report("Could not update MAX78000 I2S output: %s",
+                     strerror(errno));
+    }
+}
+
+static void max78000_i2s_out_flush(Max78000I2sState *s)
+{
+    if (!s->out_started) {
+        return;
+    }
+    if (s->out_len &&
+        qemu_write_full(s->out_fd, s->out_buf, s->out_len) != s->out_len) {
+        error_report("Could not write MAX78000 I2S output: %s",
+                     strerror(errno));
+    }
+    s->out_size += s->out_len;
+    s->out_len = 0;
+    max78000_i2s_out_header(s);
+}
+
+static void max78000_i2s_out_frame(Max78000I2sState *s,
+                                   const int32_t frame[2])
+{
+    uint32_t bytes;
+    uint8_t *p;
+    int ch;
+
+    if (s->out_fd < 0) {
+        return;
+    }
+
+    if (!s->out_started) {
+        s->out_channels = ctpop32(max78000_i2s_slots(s));
+        s->out_bits = ROUND_UP(max78000_i2s_sample_bits(s), 8);
+        s->out_rate = clock_get_hz(s->clk) / max78000_i2s_frame_div(s);
+        s->out_started = true;
+        max78000_i2s_out_header(s);
+        if (lseek(s->out_fd, WAV_HEADER_SIZE, SEEK_SET) < 0) {
+            error_report("Could not write MAX78000 I2S output: %s",
+                         strerror(errno));
+        }
+    }
+
+    bytes = s->out_bits / 8;
+    if (s->out_len + bytes * s->out_channels > I2S_STREAM_BUF_SIZE) {
+        max78000_i2s_out_flush(s);
+    }
+
+    for (ch = 0; ch < s->out_channels; ch++) {
+        p = s->out_buf + s->out_len;
+        switch (s->out_bits) {
+        case 8:
+            p[0] = ((uint32_t)frame[ch] >> 24) ^ 0x80;
+            break;
+        case 16:
+            stw_le_p(p, frame[ch] >> 16);
+            break;
+        case 24:
+            p[0] = frame[ch] >> 8;
+            p[1] = frame[ch] >> 16;
+            p[2] = frame[ch] >> 24;
+            break;
+        case 32:
+            stl_le_p(p, frame[ch]);
+            break;
+        }
+        s->out_len += bytes;
+    }
+}
+
+/* Move one frame's worth of samples in and out of the FIFOs */
+static void max78000_i2s_frame(Max78000I2sState *s)
+{
+    unsigned slots = max78000_i2s_slots(s);
+    unsigned bits = max78000_i2s_sample_bits(s);
+    int32_t frame[2];
+    int ch;
+
+    if (s->ctrl0ch0 & I2S_CTRL0_RX_EN) {
+        max78000_i2s_in_frame(s, frame);
+        for (ch = 0; ch < 2; ch++) {
+            if (!(slots & BIT(ch))) {
+                continue;
+            }
+            if (fifo32_is_full(&s->rx_fifo)) {
+                s->intfl |= I2S_INT_RX_OV;
+            } else {
+                fifo32_push(&s->rx_fifo, (uint32_t)frame[ch] >> (32 - bits));
+            }
+        }
+    }
+
+    if (s->ctrl0ch0 & I2S_CTRL0_TX_EN) {
+        for (ch = 0; ch < 2; ch++) {
+            if (!(slots & BIT(ch))) {
+                continue;
+            }
+            /* An empty FIFO sends silence */
+            frame[ch] = fifo32_is_empty(&s->tx_fifo) ? 0 :
+                        fifo32_pop(&s->tx_fifo) << (32 - bits);
+        }
+        if (slots == 1) {
+            frame[1] = frame[0];
+        } else if (slots == 2) {
+            frame[0] = frame[1];
+        }
+        max78000_i2s_out_frame(s, frame);
+    }
+}
+
+/* Virtual time at which the given frame, counted from start_ns, ends */
+static int64_t max78000_i2s_frame_time(Max78000I2sState *s, uint64_t frame)
+{
+    return s->start_ns + muldiv64_round_up(frame * max78000_i2s_frame_div(s),
+                                           NANOSECONDS_PER_SECOND,
+                                           clock_get_hz(s->clk));
+}
+
+/* Transfer every frame that is due by now */
+static void max78000_i2s_catch_up(Max78000I2sState *s)
+{
+    int64_t now = qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
+    uint64_t due;
+
+    if (!max78000_i2s_running(s)) {
+        return;
+    }
+
+    due = muldiv64(now - s->start_ns, clock_get_hz(s->clk),
+                   NANOSECONDS_PER_SECOND) / max78000_i2s_frame_div(s);
+    while (s->frames_done < due) {
+        max78000_i2s_frame(s);
+        s->frames_done++;
+    }
+}
+
+/* End of the last transferred frame, or -1 if the interface is stopped */
+static int64_t max78000_i2s_boundary(Max78000I2sState *s)
+{
+    if (!max78000_i2s_running(s)) {
+        return -1;
+    }
+    return max78000_i2s_frame_time(s, s->frames_done);
+}
+
+/*
+ * Start counting frames afresh after a change of clock or format. If
+ * the interface kept running, count from the end of its last frame so
+ * that reprogramming it does not shift the sample clock.
+ */
+static void max78000_i2s_restart(Max78000I2sState *s, int64_t boundary)
+{
+    if (boundary >= 0 && max78000_i2s_running(s)) {
+        s->start_ns = boundary;
+    } else {
+        s->start_ns = qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
+    }
+    s->frames_done = 0;
+
+    if (max78000_i2s_running(s)) {
+        trace_max78000_i2s_start(s->start_ns, clock_get_hz(s->clk) /
+                                 max78000_i2s_frame_div(s));
+    }
+}
+
+/* Frames until a FIFO level raises an enabled interrupt or DMA request */
+static uint64_t max78000_i2s_next_event(Max78000I2sState *s)
+{
+    unsigned per_frame = ctpop32(max78000_i2s_slots(s));
+    uint64_t next = UINT64_MAX;
+    uint32_t level, target;
+    bool tx_event = false;
+
+    if (s->ctrl0ch0 & I2S_CTRL0_RX_EN) {
+        level = fifo32_num_used(&s->rx_fifo);
+        target = UINT32_MAX;
+        if ((s->inten & I2S_INT_RX_THD) &&
+            max78000_i2s_rx_thd(s) >= level) {
+            target = MIN(target, max78000_i2s_rx_thd(s) + 1);
+        }
+        if ((s->dmach0 & I2S_DMA_RX_EN) &&
+            max78000_i2s_dma_rx_thd(s) >= level) {
+            target = MIN(target, max78000_i2s_dma_rx_thd(s) + 1);
+        }
+        if ((s->inten & I2S_INT_RX_OV) && !(s->intfl & I2S_INT_RX_OV)) {
+            target = MIN(target, I2S_FIFO_DEPTH + 1);
+        }
+        if (target != UINT32_MAX) {
+            next = MIN(next, DIV_ROUND_UP(target - level, per_frame));
+        }
+    }
+
+    if (s->ctrl0ch0 & I2S_CTRL0_TX_EN) {
+        level = fifo32_num_used(&s->tx_fifo);
+        target = 0;
+        if ((s->inten & I2S_INT_TX_HE) && I2S_FIFO_DEPTH / 2 < level) {
+            target = MAX(target, I2S_FIFO_DEPTH / 2);
+            tx_event = true;
+        }
+        if ((s->inten & I2S_INT_TX_OB) && 1 < level) {
+            target = MAX(target, 1);
+            tx_event = true;
+        }
+        if ((s->dmach0 & I2S_DMA_TX_EN) &&
+            max78000_i2s_dma_tx_thd(s) < level) {
+            target = MAX(target, max78000_i2s_dma_tx_thd(s));
+            tx_event = true;
+        }
+        if (tx_event) {
+            next = MIN(next, DIV_ROUND_UP(level - target, per_frame));
+        }
+    }
+
+    return next;
+}
+
+static void max78000_i2s_update(Max78000I2sState *s)
+{
+    uint32_t rx = fifo32_num_used(&s->rx_fifo);
+    uint32_t tx = fifo32_num_used(&s->tx_fifo);
+    bool tx_en = s->ctrl0ch0 & I2S_CTRL0_TX_EN;
+    uint64_t next;
+
+    if (rx > max78000_i2s_rx_thd(s)) {
+        s->intfl |= I2S_INT_RX_THD;
+    }
+    if (tx_en && tx <= I2S_FIFO_DEPTH / 2) {
+        s->intfl |= I2S_INT_TX_HE;
+    }
+    if (tx_en && tx <= 1) {
+        s->intfl |= I2S_INT_TX_OB;
+    }
+
+    qemu_set_irq(s->irq, s->intfl & s->inten);
+    qemu_set_irq(s->dma_rx, (s->dmach0 & I2S_DMA_RX_EN) &&
+                 rx > max78000_i2s_dma_rx_thd(s));
+    qemu_set_irq(s->dma_tx, (s->dmach0 & I2S_DMA_TX_EN) && tx_en &&
+                 tx <= max78000_i2s_dma_tx_thd(s));
+
+    if (!s->timer) {
+        /* Not realized yet */
+        return;
+    }
+    next = max78000_i2s_running(s) ? max78000_i2s_next_event(s) : UINT64_MAX;
+    if (next == UINT64_MAX) {
+        timer_del(s->timer);
+    } else {
+        timer_mod(s->timer,
+                  max78000_i2s_frame_time(s, s->frames_done + next));
+    }
+}
+
+static void max78000_i2s_timer(void *opaque)
+{
+    Max78000I2sState *s = opaque;
+
+    max78000_i2s_catch_up(s);
+    max78000_i2s_update(s);
+}
+
+static uint64_t max78000_i2s_read(void *opaque, hwaddr addr,
+                                  unsigned int size)
+{
+    Max78000I2sState *s = opaque;
+    uint32_t val;
+
+    max78000_i2s_catch_up(s);
+
+    switch (addr) {
+    case I2S_CTRL0CH0:
+        return s->ctrl0ch0;
+
+    case I2S_CTRL1CH0:
+        return s->ctrl1ch0;
+
+    case I2S_FILTCH0:
+        return s->filtch0;
+
+    case I2S_DMACH0:
+        return s->dmach0 |
+               fifo32_num_used(&s->tx_fifo) << I2S_DMA_TX_LVL_SHIFT |
+               fifo32_num_used(&s->rx_fifo) << I2S_DMA_RX_LVL_SHIFT;
+
+    case I2S_FIFOCH0:
+        if (fifo32_is_empty(&s->rx_fifo)) {
+            qemu_log_mask(LOG_GUEST_ERROR, "%s: RX FIFO empty\n", __func__);
+            return 0;
+        }
+        val = fifo32_pop(&s->rx_fifo);
+        max78000_i2s_update(s);
+        return val;
+
+    case I2S_INTFL:
+        return s->intfl;
+
+    case I2S_INTEN:
+        return s->inten;
+
+    case I2S_EXTSETUP:
+        return s->extsetup;
+
+    case I2S_WKEN:
+        return s->wken;
+
+    case I2S_WKFL:
+        return s->wkfl;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        return 0;
+    }
+}
+
+static void max78000_i2s_write(void *opaque, hwaddr addr,
+                               uint64_t val64, unsigned int size)
+{
+    Max78000I2sState *s = opaque;
+    uint32_t val = val64;
+    int64_t boundary;
+
+    max78000_i2s_catch_up(s);
+    boundary = max78000_i2s_boundary(s);
+
+    switch (addr) {
+    case I2S_CTRL0CH0:
+        if (val & I2S_CTRL0_FLUSH) {
+            fifo32_reset(&s->rx_fifo);
+            fifo32_reset(&s->tx_fifo);
+        }
+        s->ctrl0ch0 = val & ~I2S_CTRL0_FLUSH;
+        max78000_i2s_restart(s, boundary);
+        break;
+
+    case I2S_CTRL1CH0:
+        s->ctrl1ch0 = val;
+        max78000_i2s_restart(s, boundary);
+        break;
+
+    case I2S_FILTCH0:
+        s->filtch0 = val;
+        break;
+
+    case I2S_DMACH0:
+        s->dmach0 = val & (I2S_DMA_TX_THD_MASK | I2S_DMA_TX_EN |
+                           I2S_DMA_RX_THD_MASK << I2S_DMA_RX_THD_SHIFT |
+                           I2S_DMA_RX_EN);
+        break;
+
+    case I2S_FIFOCH0:
+        if (fifo32_is_full(&s->tx_fifo)) {
+            qemu_log_mask(LOG_GUEST_ERROR, "%s: TX FIFO full\n", __func__);
+            break;
+        }
+        fifo32_push(&s->tx_fifo, val);
+        break;
+
+    case I2S_INTFL:
+        s->intfl &= ~val;
+        break;
+
+    case I2S_INTEN:
+        s->inten = val & I2S_INT_ALL;
+        break;
+
+    case I2S_EXTSETUP:
+        s->extsetup = val;
+        break;
+
+    case I2S_WKEN:
+        s->wken = val;
+        break;
+
+    case I2S_WKFL:
+        s->wkfl &= ~val;
+        break;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        return;
+    }
+
+    max78000_i2s_update(s);
+}
+
+static void max78000_i2s_clk_update(void *opaque, ClockEvent event)
+{
+    Max78000I2sState *s = opaque;
+
+    /* The clock has already changed, so frames in flight are lost */
+    max78000_i2s_restart(s, -1);
+    max78000_i2s_update(s);
+}
+
+static void max78000_i2s_exit_notify(Notifier *notifier, void *data)
+{
+    Max78000I2sState *s = container_of(notifier, Max78000I2sState,
+                                       exit_notifier);
+
+    max78000_i2s_catch_up(s);
+    max78000_i2s_out_flush(s);
+}
+
+static int max78000_i2s_can_receive(void *opaque)
+{
+    Max78000I2sState *s = opaque;
+
+    return fifo8_num_free(&s->chr_fifo);
+}
+
+static void max78000_i2s_receive(void *opaque, const uint8_t *buf, int size)
+{
+    Max78000I2sState *s = opaque;
+
+    fifo8_push_all(&s->chr_fifo, buf, size);
+}
+
+static bool max78000_i2s_open_wav(Max78000I2sState *s, Error **errp)
+{
+    bool have_fmt = false;
+    uint16_t format = 0;
+    uint8_t hdr[16];
+    uint32_t size;
+
+    s->in_fd = qemu_open(s->in_path, O_RDONLY, errp);
+    if (s->in_fd < 0) {
+        return false;
+    }
+
+    if (read(s->in_fd, hdr, 12) != 12 || memcmp(hdr, "RIFF", 4) ||
+        memcmp(hdr + 8, "WAVE", 4)) {
+        goto bad;
+    }
+    for (;;) {
+        if (read(s->in_fd, hdr, 8) != 8) {
+            goto bad;
+        }
+        size = ldl_le_p(hdr + 4);
+        if (!memcmp(hdr, "data", 4)) {
+            break;
+        }
+        if (!memcmp(hdr, "fmt ", 4) && size >= 16) {
+            if (read(s->in_fd, hdr, 16) != 16) {
+                goto bad;
+            }
+            format = lduw_le_p(hdr);
+            s->in_channels = lduw_le_p(hdr + 2);
+            s->in_bits = lduw_le_p(hdr + 14);
+            have_fmt = true;
+            size -= 16;
+        }
+        /* Chunks are padded to an even size */
+        if (lseek(s->in_fd, size + (size & 1), SEEK_CUR) < 0) {
+            goto bad;
+        }
+    }
+
+    if (!have_fmt || (format != 1 && format != 0xfffe) ||
+        s->in_channels == 0 || s->in_channels > WAV_MAX_CHANNELS ||
+        (s->in_bits != 8 && s->in_bits != 16 && s->in_bits != 24 &&
+         s->in_bits != 32)) {
+        error_setg(errp, "MAX78000 I2S: '%s' is not 8, 16, 24 or 32 bit "
+                   "PCM with up to %d channels", s->in_path,
+                   WAV_MAX_CHANNELS);
+        goto fail;
+    }
+
+    s->in_left = size;
+    s->in_buf = g_malloc(I2S_STREAM_BUF_SIZE);
+    return true;
+
+bad:
+    error_setg(errp, "MAX78000 I2S: '%s' is not a WAV file", s->in_path);
+fail:
+    qemu_close(s->in_fd);
+    s->in_fd = -1;
+    return false;
+}
+
+static void max78000_i2s_reset_hold(Object *obj, ResetType type)
+{
+    Max78000I2sState *s = MAX78000_I2S(obj);
+
+    s->ctrl0ch0 = 0;
+    s->ctrl1ch0 = 0;
+    s->filtch0 = 0;
+    s->dmach0 = 0;
+    s->intfl = 0;
+    s->inten = 0;
+    s->extsetup = 0;
+    s->wken = 0;
+    s->wkfl = 0;
+    fifo32_reset(&s->rx_fifo);
+    fifo32_reset(&s->tx_fifo);
+    s->start_ns = 0;
+    s->frames_done = 0;
+}
+
+static void max78000_i2s_reset_exit(Object *obj, ResetType type)
+{
+    Max78000I2sState *s = MAX78000_I2S(obj);
+
+    max78000_i2s_update(s);
+}
+
+static const MemoryRegionOps max78000_i2s_ops = {
+    .read = max78000_i2s_read,
+    .write = max78000_i2s_write,
+    .endianness = DEVICE_LITTLE_ENDIAN,
+    .valid.min_access_size = 4,
+    .valid.max_access_size = 4,
+};
+
+static const Property max78000_i2s_properties[] = {
+    DEFINE_PROP_CHR("chardev", Max78000I2sState, chr),
+    DEFINE_PROP_STRING("in-wav", Max78000I2sState, in_path),
+    DEFINE_PROP_STRING("out-wav", Max78000I2sState, out_path),
+};
+
+/* The input and output streams are host-side and are not migrated */
+static const VMStateDescription vmstate_max78000_i2s = {
+    .name = TYPE_MAX78000_I2S,
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(ctrl0ch0, Max78000I2sState),
+        VMSTATE_UINT32(ctrl1ch0, Max78000I2sState),
+        VMSTATE_UINT32(filtch0, Max78000I2sState),
+        VMSTATE_UINT32(dmach0, Max78000I2sState),
+        VMSTATE_UINT32(intfl, Max78000I2sState),
+        VMSTATE_UINT32(inten, Max78000I2sState),
+        VMSTATE_UINT32(extsetup, Max78000I2sState),
+        VMSTATE_UINT32(wken, Max78000I2sState),
+        VMSTATE_UINT32(wkfl, Max78000I2sState),
+        VMSTATE_FIFO32(rx_fifo, Max78000I2sState),
+        VMSTATE_FIFO32(tx_fifo, Max78000I2sState),
+        VMSTATE_INT64(start_ns, Max78000I2sState),
+        VMSTATE_UINT64(frames_done, Max78000I2sState),
+        VMSTATE_TIMER_PTR(timer, Max78000I2sState),
+        VMSTATE_CLOCK(clk, Max78000I2sState),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static void max78000_i2s_init(Object *obj)
+{
+    Max78000I2sState *s = MAX78000_I2S(obj);
+
+    sysbus_init_irq(SYS_BUS_DEVICE(obj), &s->irq);
+    qdev_init_gpio_out_named(DEVICE(obj), &s->dma_rx, "dma-rx", 1);
+    qdev_init_gpio_out_named(DEVICE(obj), &s->dma_tx, "dma-tx", 1);
+
+    s->clk = qdev_init_clock_in(DEVICE(obj), "clk", max78000_i2s_clk_update,
+                                s, ClockUpdate);
+
+    fifo32_create(&s->rx_fifo, I2S_FIFO_DEPTH);
+    fifo32_create(&s->tx_fifo, I2S_FIFO_DEPTH);
+
+    s->in_fd = -1;
+    s->out_fd = -1;
+
+    memory_region_init_io(&s->mmio, obj, &max78000_i2s_ops, s,
+                          TYPE_MAX78000_I2S, 0x1000);
+    sysbus_init_mmio(SYS_BUS_DEVICE(obj), &s->mmio);
+}
+
+static void max78000_i2s_realize(DeviceState *dev, Error **errp)
+{
+    Max78000I2sState *s = MAX78000_I2S(dev);
+
+    if (!clock_has_source(s->clk)) {
+        error_setg(errp, "MAX78000 I2S: clk must be connected");
+        return;
+    }
+    if (s->in_path && qemu_chr_fe_backend_connected(&s->chr)) {
+        error_setg(errp, "MAX78000 I2S: in-wav and chardev are exclusive");
+        return;
+    }
+
+    if (s->in_path) {
+        if (!max78000_i2s_open_wav(s, errp)) {
+            return;
+        }
+    } else {
+        s->in_channels = 1;
+        s->in_bits = 16;
+        fifo8_create(&s->chr_fifo, I2S_STREAM_BUF_SIZE);
+        qemu_chr_fe_set_handlers(&s->chr, max78000_i2s_can_receive,
+                                 max78000_i2s_receive, NULL, NULL,
+                                 s, NULL, true);
+    }
+
+    if (s->out_path) {
+        s->out_fd = qemu_create(s->out_path, O_WRONLY | O_TRUNC, 0666, errp);
+        if (s->out_fd < 0) {
+            return;
+        }
+        s->out_buf = g_malloc(I2S_STREAM_BUF_SIZE);
+        s->exit_notifier.notify = max78000_i2s_exit_notify;
+        qemu_add_exit_notifier(&s->exit_notifier);
+    }
+
+    s->timer = timer_new_ns(QEMU_CLOCK_VIRTUAL, max78000_i2s_timer, s);
+}
+
+static void max78000_i2s_class_init(ObjectClass *klass, const void *data)
+{
+    ResettableClass *rc = RESETTABLE_CLASS(klass);
+    DeviceClass *dc = DEVICE_CLASS(klass);
+
+    rc->phases.hold = max78000_i2s_reset_hold;
+    rc->phases.exit = max78000_i2s_reset_exit;
+    device_class_set_props(dc, max78000_i2s_properties);
+    dc->realize = max78000_i2s_realize;
+    dc->vmsd = &vmstate_max78000_i2s;
+}
+
+static const TypeInfo max78000_i2s_info = {
+    .name          = TYPE_MAX78000_I2S,
+    .parent        = TYPE_SYS_BUS_DEVICE,
+    .instance_size = sizeof(Max78000I2sState),
+    .instance_init = max78000_i2s_init,
+    .class_init    = max78000_i2s_class_init,
+};
+
+static void max78000_i2s_register_types(void)
+{
+    type_register_static(&max78000_i2s_info);
+}
+
+type_init(max78000_i2s_register_types)
@@ -11,6 +11,8 @@
 #include "hw/irq.h"
 #include "hw/qdev-properties.h"
 #include "hw/qdev-properties-system.h"
+#include "hw/qdev-clock.h"
+#include "qapi/error.h"
 #include "qemu/log.h"
 #include "qemu/module.h"
 #include "migration/vmstate.h"
@@ -26,12 +28,91 @@ static int max78000_uart_can_receive(void *opaque)
     return fifo8_num_free(&s->rx_fifo);
 }
 
+static void max78000_uart_update_dma(Max78000UartState *s)
+{
+    uint32_t tx_thd = s->dma & UART_DMA_TX_THD_MASK;
+    uint32_t rx_thd = (s->dma >> UART_DMA_RX_THD_SHIFT) &
+                      UART_DMA_RX_THD_MASK;
+
+    qemu_set_irq(s->dma_tx_req, (s->dma & UART_DMA_TX_EN) &&
+                 fifo8_num_used(&s->tx_fifo) < tx_thd);
+    qemu_set_irq(s->dma_rx_req, (s->dma & UART_DMA_RX_EN) &&
+                 !fifo8_is_empty(&s->rx_fifo) &&
+                 fifo8_num_used(&s->rx_fifo) >= rx_thd);
+}
+
 static void max78000_update_irq(Max78000UartState *s)
 {
     int interrupt_level;
 
     interrupt_level = s->int_fl & s->int_en;
     qemu_set_irq(s->irq, interrupt_level);
+    qemu_set_irq(s->wakeup, s->wkfl & s->wken);
+    max78000_uart_update_dma(s);
+}
+
+static void max78000_uart_update_tx(Max78000UartState *s)
+{
+    /* TX_HE is set whenever the FIFO is at or below half occupancy */
+    if (fifo8_num_used(&s->tx_fifo) <= UART_FIFO_DEPTH / 2) {
+        s->int_fl |= UART_TX_HE;
+    }
+    max78000_update_irq(s);
+}
+
+/*
+ * Drain as much of the TX FIFO as the backend will take without
+ * blocking, and arrange to be called back once it can accept more.
+ */
+static gboolean max78000_uart_xmit(void *do_not_use, GIOCondition cond,
+                                   void *opaque)
+{
+    Max78000UartState *s = opaque;
+    const uint8_t *buf;
+    uint32_t len;
+    int ret;
+
+    s->watch_tag = 0;
+
+    /* instant drain the fifo when there's no back-end */
+    if (!qemu_chr_fe_backend_connected(&s->chr)) {
+        fifo8_reset(&s->tx_fifo);
+        goto out;
+    }
+
+    /* The FIFO may wrap, so this can take two writes to empty it */
+    while (!fifo8_is_empty(&s->tx_fifo)) {
+        buf = fifo8_peek_bufptr(&s->tx_fifo, fifo8_num_used(&s->tx_fifo),
+                                &len);
+        ret = qemu_chr_fe_write(&s->chr, buf, len);
+        if (ret <= 0) {
+            break;
+        }
+        fifo8_drop(&s->tx_fifo, ret);
+        if (ret < len) {
+            break;
+        }
+    }
+
+    if (!fifo8_is_empty(&s->tx_fifo)) {
+        s->watch_tag = qemu_chr_fe_add_watch(&s->chr, G_IO_OUT | G_IO_HUP,
+                                             max78000_uart_xmit, s);
+        if (!s->watch_tag) {
+            fifo8_reset(&s->tx_fifo);
+        }
+    }
+
+out:
+    max78000_uart_update_tx(s);
+    return G_SOURCE_REMOVE;
+}
+
+static void max78000_uart_cancel_xmit(Max78000UartState *s)
+{
+    if (s->watch_tag) {
+        g_source_remove(s->watch_tag);
+        s->watch_tag = 0;
+    }
 }
 
 static void max78000_uart_receive(void *opaque, const uint8_t *buf, int size)
@@ -46,11 +127,50 @@ static void max78000_uart_receive(void *opaque, const uint8_t *buf, int size)
 
     if (fifo8_num_used(&s->rx_fifo) >= rx_threshold) {
         s->int_fl |= UART_RX_THD;
+        s->wkfl |= s->wken & UART_WK_RX_THD;
     }
+    if (fifo8_is_full(&s->rx_fifo)) {
+        s->wkfl |= s->wken & UART_WK_RX_FULL;
+    }
+    s->wkfl |= s->wken & UART_WK_RX_NE;
 
     max78000_update_irq(s);
 }
 
+/*
+ * With its peripheral clock gated the UART neither transmits nor
+ * receives. The chardev handlers are removed so the backend is not
+ * polled at all, and queued TX data waits for the clock to return.
+ */
+static void max78000_uart_update_clock(Max78000UartState *s)
+{
+    bool enabled = clock_is_enabled(s->clk);
+
+    if (!enabled) {
+        max78000_uart_cancel_xmit(s);
+    }
+    if (enabled != s->chr_attached) {
+        if (enabled) {
+            qemu_chr_fe_set_handlers(&s->chr, max78000_uart_can_receive,
+                                     max78000_uart_receive, NULL, NULL,
+                                     s, NULL, true);
+        } else {
+            qemu_chr_fe_set_handlers(&s->chr, NULL, NULL, NULL, NULL,
+                                     NULL, NULL, false);
+        }
+        s->chr_attached = enabled;
+    }
+    if (enabled && !fifo8_is_empty(&s->tx_fifo) && !s->watch_tag) {
+        s->watch_tag = qemu_chr_fe_add_watch(&s->chr, G_IO_OUT | G_IO_HUP,
+                                             max78000_uart_xmit, s);
+    }
+}
+
+static void max78000_uart_clk_update(void *opaque, ClockEvent event)
+{
+    max78000_uart_update_clock(opaque);
+}
+
 static void max78000_uart_reset_hold(Object *obj, ResetType type)
 {
     Max78000UartState *s = MAX78000_UART(obj);
@@ -67,6 +187,15 @@ static void max78000_uart_reset_hold(Object *obj, ResetType type)
     s->wken = 0;
     s->wkfl = 0;
     fifo8_reset(&s->rx_fifo);
+    max78000_uart_cancel_xmit(s);
+    fifo8_reset(&s->tx_fifo);
+}
+
+static void max78000_uart_reset_exit(Object *obj, ResetType type)
+{
+    Max78000UartState *s = MAX78000_UART(obj);
+
+    max78000_update_irq(s);
 }
 
 static uint64_t max78000_uart_read(void *opaque, hwaddr addr,
@@ -79,8 +208,11 @@ static uint64_t max78000_uart_read(void *opaque, hwaddr addr,
         retvalue = s->ctrl;
         break;
     case UART_STATUS:
-        retvalue = (fifo8_num_used(&s->rx_fifo) << UART_RX_LVL) |
-                    UART_TX_EM |
+        retvalue = (fifo8_num_used(&s->tx_fifo) << UART_TX_LVL) |
+                    (fifo8_num_used(&s->rx_fifo) << UART_RX_LVL) |
+                    (fifo8_is_full(&s->tx_fifo) ? UART_TX_FULL : 0) |
+                    (fifo8_is_empty(&s->tx_fifo) ? UART_TX_EM : UART_TX_BUSY) |
+                    (fifo8_is_full(&s->rx_fifo) ? UART_RX_FULL : 0) |
                     (fifo8_is_empty(&s->rx_fifo) ? UART_RX_EM : 0);
         break;
     case UART_INT_EN:
@@ -110,7 +242,6 @@ static uint64_t max78000_uart_read(void *opaque, hwaddr addr,
         }
         break;
     case UART_DMA:
-        /* DMA not implemented */
         retvalue = s->dma;
         break;
     case UART_WKEN:
@@ -141,6 +272,11 @@ static void max78000_uart_write(void *opaque, hwaddr addr,
         if (value & UART_FLUSH_RX) {
             fifo8_reset(&s->rx_fifo);
         }
+        if (value & UART_FLUSH_TX) {
+            max78000_uart_cancel_xmit(s);
+            fifo8_reset(&s->tx_fifo);
+            max78000_uart_update_tx(s);
+        }
         if (value & UART_BCLKEN) {
             value = value | UART_BCLKRDY;
         }
@@ -174,26 +310,35 @@ static void max78000_uart_write(void *opaque, hwaddr addr,
         return;
     case UART_FIFO:
         data = value & 0xff;
+        if (fifo8_is_full(&s->tx_fifo)) {
+            qemu_log_mask(LOG_GUEST_ERROR,
+                          "%s: TX FIFO overflow, dropping 0x%02x\n",
+                          __func__, data);
+            return;
+        }
+        fifo8_push(&s->tx_fifo, data);
+
         /*
-         * XXX this blocks entire thread. Rewrite to use
-         * qemu_chr_fe_write and background I/O callbacks
+         * If a watch is pending the backend is busy; the byte stays
+         * queued and goes out with the rest of the FIFO when it fires.
          */
-        qemu_chr_fe_write_all(&s->chr, &data, 1);
-
-        /* TX is always empty */
-        s->int_fl |= UART_TX_HE;
-        max78000_update_irq(s);
-
+        if (!s->watch_tag && clock_is_enabled(s->clk)) {
+            max78000_uart_xmit(NULL, G_IO_OUT, s);
+        } else {
+            max78000_uart_update_tx(s);
+        }
         return;
     case UART_DMA:
-        /* DMA not implemented */
         s->dma = value;
+        max78000_uart_update_dma(s);
         return;
     case UART_WKEN:
         s->wken = value;
+        max78000_update_irq(s);
         return;
     case UART_WKFL:
-        s->wkfl = value;
+        s->wkfl &= ~value;
+        max78000_update_irq(s);
         return;
     default:
         qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
@@ -201,23 +346,41 @@ static void max78000_uart_write(void *opaque, hwaddr addr,
     }
 }
 
+/* The FIFO takes byte accesses, as the DMA makes them; the rest are word */
+static bool max78000_uart_accepts(void *opaque, hwaddr addr, unsigned size,
+                                  bool is_write, MemTxAttrs attrs)
+{
+    return size == 4 || addr == UART_FIFO;
+}
+
 static const MemoryRegionOps max78000_uart_ops = {
     .read = max78000_uart_read,
     .write = max78000_uart_write,
     .endianness = DEVICE_LITTLE_ENDIAN,
-    .valid.min_access_size = 4,
+    .valid.min_access_size = 1,
     .valid.max_access_size = 4,
+    .valid.accepts = max78000_uart_accepts,
 };
 
 static const Property max78000_uart_properties[] = {
     DEFINE_PROP_CHR("chardev", Max78000UartState, chr),
 };
 
+static int max78000_uart_post_load(void *opaque, int version_id)
+{
+    Max78000UartState *s = opaque;
+
+    /* Reattach the backend, and arrange to resend any pending TX data */
+    max78000_uart_update_clock(s);
+    return 0;
+}
+
 static const VMStateDescription max78000_uart_vmstate = {
     .name = TYPE_MAX78000_UART,
-    .version_id = 1,
-    .minimum_version_id = 1,
-    .fields = (VMStateField[]) {
+    .version_id = 3,
+    .minimum_version_id = 3,
+    .post_load = max78000_uart_post_load,
+    .fields = (const VMStateField[]) {
         VMSTATE_UINT32(ctrl, Max78000UartState),
         VMSTATE_UINT32(status, Max78000UartState),
         VMSTATE_UINT32(int_en, Max78000UartState),
@@ -231,6 +394,8 @@ static const VMStateDescription max78000_uart_vmstate = {
         VMSTATE_UINT32(wken, Max78000UartState),
         VMSTATE_UINT32(wkfl, Max78000UartState),
         VMSTATE_FIFO8(rx_fifo, Max78000UartState),
+        VMSTATE_FIFO8(tx_fifo, Max78000UartState),
+        VMSTATE_CLOCK(clk, Max78000UartState),
         VMSTATE_END_OF_LIST()
     }
 };
@@ -238,22 +403,31 @@ static const VMStateDescription max78000_uart_vmstate = {
 static void max78000_uart_init(Object *obj)
 {
     Max78000UartState *s = MAX78000_UART(obj);
-    fifo8_create(&s->rx_fifo, 8);
+    fifo8_create(&s->rx_fifo, UART_FIFO_DEPTH);
+    fifo8_create(&s->tx_fifo, UART_FIFO_DEPTH);
 
     sysbus_init_irq(SYS_BUS_DEVICE(obj), &s->irq);
+    qdev_init_gpio_out_named(DEVICE(obj), &s->dma_tx_req, "dma-tx", 1);
+    qdev_init_gpio_out_named(DEVICE(obj), &s->dma_rx_req, "dma-rx", 1);
+    qdev_init_gpio_out_named(DEVICE(obj), &s->wakeup, "wakeup", 1);
 
     memory_region_init_io(&s->mmio, obj, &max78000_uart_ops, s,
                           TYPE_MAX78000_UART, 0x400);
     sysbus_init_mmio(SYS_BUS_DEVICE(obj), &s->mmio);
+
+    s->clk = qdev_init_clock_in(DEVICE(s), "clk", max78000_uart_clk_update, s,
+                                ClockUpdate);
 }
 
 static void max78000_uart_realize(DeviceState *dev, Error **errp)
 {
     Max78000UartState *s = MAX78000_UART(dev);
 
-    qemu_chr_fe_set_handlers(&s->chr, max78000_uart_can_receive,
-                             max78000_uart_receive, NULL, NULL,
-                             s, NULL, true);
+    if (!clock_has_source(s->clk)) {
+        error_setg(errp, "MAX78000 UART: clk must be connected");
+        return;
+    }
+    max78000_uart_update_clock(s);
 }
 
 static void max78000_uart_class_init(ObjectClass *klass, const void *data)
@@ -262,6 +436,7 @@ static void max78000_uart_class_init(ObjectClass *klass, const void *data)
     ResettableClass *rc = RESETTABLE_CLASS(klass);
 
     rc->phases.hold = max78000_uart_reset_hold;
+    rc->phases.exit = max78000_uart_reset_exit;
 
     device_class_set_props(dc, max78000_uart_properties);
     dc->realize = max78000_uart_realize;
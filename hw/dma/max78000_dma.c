@@ -0,0 +1,472 @@
+/*
+ * MAX78000 Standard DMA Controller
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Transfers are carried out as soon as a channel is enabled, or as soon
+ * as the peripheral it serves raises its request line. Memory is
+ * accessed in blocks of up to DMA_BLOCK_SIZE bytes; only a side with a
+ * fixed address (a peripheral FIFO register) is accessed one beat at
+ * a time, so that the transfer can stop as soon as the peripheral
+ * drops its request.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/log.h"
+#include "qemu/main-loop.h"
+#include "qapi/error.h"
+#include "trace.h"
+#include "hw/irq.h"
+#include "hw/qdev-properties.h"
+#include "migration/vmstate.h"
+#include "hw/dma/max78000_dma.h"
+
+#define DMA_BLOCK_SIZE 4096
+
+static void max78000_dma_update_irq(Max78000DmaState *s)
+{
+    int i;
+
+    for (i = 0; i < DMA_NUM_CHANNELS; i++) {
+        Max78000DmaChannel *c = &s->ch[i];
+        bool pending;
+
+        pending = ((c->status & DMA_STATUS_CTZ_IF) &&
+                   (c->ctrl & DMA_CTRL_CTZ_IE)) ||
+                  ((c->status & (DMA_STATUS_RLD_IF | DMA_STATUS_BUS_ERR |
+                                 DMA_STATUS_TO_IF)) &&
+                   (c->ctrl & DMA_CTRL_DIS_IE));
+
+        if (pending) {
+            c->status |= DMA_STATUS_IPEND;
+        } else {
+            c->status &= ~DMA_STATUS_IPEND;
+        }
+        qemu_set_irq(s->irq[i], pending && (s->inten & (1 << i)));
+    }
+}
+
+static uint32_t max78000_dma_intfl(Max78000DmaState *s)
+{
+    uint32_t intfl = 0;
+    int i;
+
+    for (i = 0; i < DMA_NUM_CHANNELS; i++) {
+        if (s->ch[i].status & DMA_STATUS_IPEND) {
+            intfl |= 1 << i;
+        }
+    }
+    return intfl;
+}
+
+static unsigned max78000_dma_width(uint32_t ctrl, int shift)
+{
+    /* 0: byte, 1: halfword, 2: word; 3 is reserved */
+    return 1 << MIN((ctrl >> shift) & 3, 2);
+}
+
+static bool max78000_dma_requesting(Max78000DmaState *s, unsigned req)
+{
+    return req == DMA_REQ_MEMTOMEM || (s->requests & (1ULL << req));
+}
+
+static void max78000_dma_stop(Max78000DmaChannel *c)
+{
+    c->ctrl &= ~DMA_CTRL_EN;
+    c->status &= ~DMA_STATUS_EN;
+}
+
+/* Returns true if the channel ran out of data and should stop */
+static bool max78000_dma_count_to_zero(Max78000DmaState *s,
+                                       Max78000DmaChannel *c)
+{
+    c->status |= DMA_STATUS_CTZ_IF;
+
+    if ((c->ctrl & DMA_CTRL_RLDEN) && (c->cntrld & DMA_CNTRLD_EN)) {
+        c->src = c->srcrld;
+        c->dst = c->dstrld;
+        c->cnt = c->cntrld & DMA_CNT_MASK;
+        c->status |= DMA_STATUS_RLD_IF;
+        return false;
+    }
+
+    max78000_dma_stop(c);
+    return true;
+}
+
+/*
+ * Move as much data as the channel's request line allows. Returns true
+ * if any bytes were transferred.
+ */
+static bool max78000_dma_transfer(Max78000DmaState *s, int ch)
+{
+    Max78000DmaChannel *c = &s->ch[ch];
+    unsigned req = (c->ctrl >> DMA_CTRL_REQUEST_SHIFT) & DMA_CTRL_REQUEST_MASK;
+    unsigned swidth = max78000_dma_width(c->ctrl, DMA_CTRL_SRCWD_SHIFT);
+    unsigned dwidth = max78000_dma_width(c->ctrl, DMA_CTRL_DSTWD_SHIFT);
+    bool sinc = c->ctrl & DMA_CTRL_SRCINC;
+    bool dinc = c->ctrl & DMA_CTRL_DSTINC;
+    MemTxAttrs attrs = MEMTXATTRS_UNSPECIFIED;
+    uint8_t buf[DMA_BLOCK_SIZE];
+    bool progress = false;
+    uint32_t len, done;
+    MemTxResult res;
+
+    while ((c->ctrl & DMA_CTRL_EN) && c->cnt &&
+           max78000_dma_requesting(s, req)) {
+        len = MIN(c->cnt, DMA_BLOCK_SIZE);
+        res = MEMTX_OK;
+
+        /* Gather */
+        if (sinc) {
+            res = address_space_read(&s->downstream_as, c->src, attrs,
+                                     buf, len);
+        } else {
+            /* A peripheral source gets drained while it is requesting */
+            for (done = 0; done < len && res == MEMTX_OK; done += swidth) {
+                if (!max78000_dma_requesting(s, req)) {
+                    break;
+                }
+                res = address_space_read(&s->downstream_as, c->src, attrs,
+                                         buf + done, MIN(swidth, len - done));
+            }
+            len = MIN(done, len);
+        }
+
+        /* Scatter */
+        if (res != MEMTX_OK) {
+            done = 0;
+        } else if (dinc) {
+            res = address_space_write(&s->downstream_as, c->dst, attrs,
+                                      buf, len);
+            done = len;
+        } else {
+            /* A peripheral sink gets filled while it is requesting */
+            for (done = 0; done < len && res == MEMTX_OK; done += dwidth) {
+                if (sinc && !max78000_dma_requesting(s, req)) {
+                    break;
+                }
+                res = address_space_write(&s->downstream_as, c->dst, attrs,
+                                          buf + done, MIN(dwidth, len - done));
+            }
+            done = MIN(done, len);
+        }
+
+        if (res != MEMTX_OK) {
+            qemu_log_mask(LOG_GUEST_ERROR,
+                          "%s: channel %d bus error (src 0x%x dst 0x%x)\n",
+                          __func__, ch, c->src, c->dst);
+            c->status |= DMA_STATUS_BUS_ERR;
+            max78000_dma_stop(c);
+            break;
+        }
+
+        if (sinc) {
+            c->src += done;
+        }
+        if (dinc) {
+            c->dst += done;
+        }
+        c->cnt -= done;
+
+        if (done == 0) {
+            break;
+        }
+        progress = true;
+
+        if (c->cnt == 0) {
+            if (!max78000_dma_count_to_zero(s, c)) {
+                /*
+                 * Reloaded; pick the channel up again from the main loop
+                 * rather than spinning here.
+                 */
+                qemu_bh_schedule(s->bh);
+            }
+            break;
+        }
+    }
+
+    return progress;
+}
+
+static void max78000_dma_run(Max78000DmaState *s)
+{
+    bool progress;
+    int i;
+
+    /*
+     * Moving data makes peripherals update their request lines, which
+     * can unblock another channel; keep going until nothing moves.
+     */
+    do {
+        progress = false;
+        for (i = 0; i < DMA_NUM_CHANNELS; i++) {
+            progress |= max78000_dma_transfer(s, i);
+        }
+    } while (progress);
+
+    max78000_dma_update_irq(s);
+}
+
+static void max78000_dma_bh(void *opaque)
+{
+    max78000_dma_run(opaque);
+}
+
+static void max78000_dma_request(void *opaque, int n, int level)
+{
+    Max78000DmaState *s = opaque;
+
+    /*
+     * Requests are often raised from within the peripheral's own MMIO
+     * handler, where the DMA must not access it again; service them
+     * from a bottom half instead.
+     */
+    if (level) {
+        s->requests |= 1ULL << n;
+        qemu_bh_schedule(s->bh);
+    } else {
+        s->requests &= ~(1ULL << n);
+    }
+}
+
+static uint64_t max78000_dma_read(void *opaque, hwaddr addr,
+                                    unsigned int size)
+{
+    Max78000DmaState *s = opaque;
+    Max78000DmaChannel *c;
+
+    switch (addr) {
+    case DMA_INTEN:
+        return s->inten;
+
+    case DMA_INTFL:
+        return max78000_dma_intfl(s);
+
+    case DMA_CH_BASE ... DMA_CH_BASE + DMA_NUM_CHANNELS * DMA_CH_STRIDE - 4:
+        c = &s->ch[(addr - DMA_CH_BASE) / DMA_CH_STRIDE];
+        switch ((addr - DMA_CH_BASE) % DMA_CH_STRIDE) {
+        case DMA_CH_CTRL:
+            return c->ctrl;
+        case DMA_CH_STATUS:
+            return c->status;
+        case DMA_CH_SRC:
+            return c->src;
+        case DMA_CH_DST:
+            return c->dst;
+        case DMA_CH_CNT:
+            return c->cnt;
+        case DMA_CH_SRCRLD:
+            return c->srcrld;
+        case DMA_CH_DSTRLD:
+            return c->dstrld;
+        case DMA_CH_CNTRLD:
+            return c->cntrld;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+        HWADDR_PRIx "\n", __func__, addr);
+    return 0;
+}
+
+static void max78000_dma_write(void *opaque, hwaddr addr,
+                    uint64_t val64, unsigned int size)
+{
+    Max78000DmaState *s = opaque;
+    uint32_t val = val64;
+    Max78000DmaChannel *c;
+
+    switch (addr) {
+    case DMA_INTEN:
+        s->inten = val & ((1 << DMA_NUM_CHANNELS) - 1);
+        max78000_dma_update_irq(s);
+        return;
+
+    case DMA_INTFL:
+        /* Read only; flags are cleared through the channel status */
+        return;
+
+    case DMA_CH_BASE ... DMA_CH_BASE + DMA_NUM_CHANNELS * DMA_CH_STRIDE - 4:
+        c = &s->ch[(addr - DMA_CH_BASE) / DMA_CH_STRIDE];
+        switch ((addr - DMA_CH_BASE) % DMA_CH_STRIDE) {
+        case DMA_CH_CTRL:
+            c->ctrl = val;
+            if (val & DMA_CTRL_EN) {
+                c->status |= DMA_STATUS_EN;
+                if (c->cnt == 0) {
+                    max78000_dma_count_to_zero(s, c);
+                }
+                max78000_dma_run(s);
+            } else {
+                max78000_dma_stop(c);
+            }
+            break;
+        case DMA_CH_STATUS:
+            c->status &= ~(val & DMA_STATUS_W1C);
+            break;
+        case DMA_CH_SRC:
+            c->src = val;
+            break;
+        case DMA_CH_DST:
+            c->dst = val;
+            break;
+        case DMA_CH_CNT:
+            c->cnt = val & DMA_CNT_MASK;
+            break;
+        case DMA_CH_SRCRLD:
+            c->srcrld = val & 0x7fffffff;
+            break;
+        case DMA_CH_DSTRLD:
+            c->dstrld = val & 0x7fffffff;
+            break;
+        case DMA_CH_CNTRLD:
+            c->cntrld = val & (DMA_CNTRLD_EN | DMA_CNT_MASK);
+            break;
+        default:
+            goto bad_offset;
+        }
+        max78000_dma_update_irq(s);
+        return;
+
+    default:
+        break;
+    }
+
+bad_offset:
+    qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+        HWADDR_PRIx "\n", __func__, addr);
+}
+
+static void max78000_dma_reset_hold(Object *obj, ResetType type)
+{
+    Max78000DmaState *s = MAX78000_DMA(obj);
+
+    s->inten = 0;
+    memset(s->ch, 0, sizeof(s->ch));
+}
+
+static void max78000_dma_reset_exit(Object *obj, ResetType type)
+{
+    Max78000DmaState *s = MAX78000_DMA(obj);
+
+    max78000_dma_update_irq(s);
+}
+
+static const MemoryRegionOps max78000_dma_ops = {
+    .read = max78000_dma_read,
+    .write = max78000_dma_write,
+    .endianness = DEVICE_LITTLE_ENDIAN,
+    .valid.min_access_size = 4,
+    .valid.max_access_size = 4,
+};
+
+static const Property max78000_dma_properties[] = {
+    DEFINE_PROP_LINK("downstream", Max78000DmaState, downstream,
+                     TYPE_MEMORY_REGION, MemoryRegion*),
+};
+
+static const VMStateDescription vmstate_max78000_dma_channel = {
+    .name = TYPE_MAX78000_DMA "-channel",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(ctrl, Max78000DmaChannel),
+        VMSTATE_UINT32(status, Max78000DmaChannel),
+        VMSTATE_UINT32(src, Max78000DmaChannel),
+        VMSTATE_UINT32(dst, Max78000DmaChannel),
+        VMSTATE_UINT32(cnt, Max78000DmaChannel),
+        VMSTATE_UINT32(srcrld, Max78000DmaChannel),
+        VMSTATE_UINT32(dstrld, Max78000DmaChannel),
+        VMSTATE_UINT32(cntrld, Max78000DmaChannel),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static int max78000_dma_post_load(void *opaque, int version_id)
+{
+    Max78000DmaState *s = opaque;
+
+    /* A pending bottom half is not migrated; look at the channels again */
+    qemu_bh_schedule(s->bh);
+    return 0;
+}
+
+static const VMStateDescription vmstate_max78000_dma = {
+    .name = TYPE_MAX78000_DMA,
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .post_load = max78000_dma_post_load,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(inten, Max78000DmaState),
+        VMSTATE_STRUCT_ARRAY(ch, Max78000DmaState, DMA_NUM_CHANNELS, 1,
+                             vmstate_max78000_dma_channel,
+                             Max78000DmaChannel),
+        VMSTATE_UINT64(requests, Max78000DmaState),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static void max78000_dma_init(Object *obj)
+{
+    Max78000DmaState *s = MAX78000_DMA(obj);
+    int i;
+
+    for (i = 0; i < DMA_NUM_CHANNELS; i++) {
+        sysbus_init_irq(SYS_BUS_DEVICE(obj), &s->irq[i]);
+    }
+    qdev_init_gpio_in_named(DEVICE(obj), max78000_dma_request, "request",
+                            DMA_NUM_REQUESTS);
+
+    memory_region_init_io(&s->mmio, obj, &max78000_dma_ops, s,
+                        TYPE_MAX78000_DMA, 0x1000);
+    sysbus_init_mmio(SYS_BUS_DEVICE(obj), &s->mmio);
+}
+
+static void max78000_dma_realize(DeviceState *dev, Error **errp)
+{
+    Max78000DmaState *s = MAX78000_DMA(dev);
+
+    if (!s->downstream) {
+        error_setg(errp, "MAX78000 DMA 'downstream' link not set");
+        return;
+    }
+
+    address_space_init(&s->downstream_as, s->downstream,
+                       "max78000-dma-downstream");
+    s->bh = qemu_bh_new_guarded(max78000_dma_bh, s,
+                                &dev->mem_reentrancy_guard);
+}
+
+static void max78000_dma_class_init(ObjectClass *klass, const void *data)
+{
+    ResettableClass *rc = RESETTABLE_CLASS(klass);
+    DeviceClass *dc = DEVICE_CLASS(klass);
+
+    rc->phases.hold = max78000_dma_reset_hold;
+    rc->phases.exit = max78000_dma_reset_exit;
+    device_class_set_props(dc, max78000_dma_properties);
+    dc->realize = max78000_dma_realize;
+    dc->vmsd = &vmstate_max78000_dma;
+}
+
+static const TypeInfo max78000_dma_info = {
+    .name          = TYPE_MAX78000_DMA,
+    .parent        = TYPE_SYS_BUS_DEVICE,
+    .instance_size = sizeof(Max78000DmaState),
+    .instance_init = max78000_dma_init,
+    .class_init    = max78000_dma_class_init,
+};
+
+static void max78000_dma_register_types(void)
+{
+    type_register_static(&max78000_dma_info);
+}
+
+type_init(max78000_dma_register_types)
@@ -0,0 +1,604 @@
+/*
+ * MAX78000 GPIO
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Each port has 32 pins. Unnamed GPIO inputs let the board drive the
+ * pins, and unnamed GPIO outputs follow the pin levels. Interrupts are
+ * raised on edges or levels as configured by INTMODE, INTPOL and
+ * DUALEDGE; the named "wakeup" outputs carry INTFL & WKEN for the power
+ * sequencer. Alternate functions, drive strength and the pad controls
+ * other than the pull-up are stored but have no effect.
+ *
+ * For driving pins from a host-side script without a monitor round trip
+ * per edge, lines of the form
+ *
+ *     <time> <pin> <level>
+ *
+ * can be fed through the "chardev" property. <time> is the virtual
+ * clock time in nanoseconds at which the pin changes, or, when it
+ * starts with '+', the delay after the previous line. Transitions are
+ * applied exactly when virtual time reaches them, so a script that runs
+ * ahead of the guest replays deterministically.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/log.h"
+#include "qemu/ctype.h"
+#include "qemu/cutils.h"
+#include "qapi/error.h"
+#include "trace.h"
+#include "hw/irq.h"
+#include "hw/qdev-clock.h"
+#include "hw/qdev-properties.h"
+#include "hw/qdev-properties-system.h"
+#include "migration/vmstate.h"
+#include "hw/gpio/max78000_gpio.h"
+
+/*
+ * Current level of every pin: driven by the port where the output is
+ * enabled, otherwise by whatever is attached to it. A pin nobody drives
+ * floats to 1 if its pull-up is enabled, and to 0 otherwise.
+ */
+static uint32_t max78000_gpio_pins(Max78000GpioState *s)
+{
+    uint32_t input = (s->ext_level & s->ext_driven) |
+                     (s->padctrl0 & s->pssel & ~s->ext_driven);
+
+    return (s->out & s->outen) | (input & ~s->outen);
+}
+
+static void max78000_gpio_update(Max78000GpioState *s)
+{
+    uint32_t pins = max78000_gpio_pins(s);
+    uint32_t changed = pins ^ s->level;
+    uint32_t rise = changed & pins;
+    uint32_t fall = changed & ~pins;
+    uint32_t wake;
+    int i;
+
+    /* Edge and level detection stop while the port is not clocked */
+    if (clock_is_enabled(s->clk)) {
+        s->intfl |= s->intmode & ((rise & (s->intpol | s->dualedge)) |
+                                  (fall & (~s->intpol | s->dualedge)));
+        s->intfl |= ~s->intmode & ~(pins ^ s->intpol);
+    }
+    s->level = pins;
+
+    for (i = 0; changed; i++, changed >>= 1) {
+        if (changed & 1) {
+            qemu_set_irq(s->pin_out[i], extract32(pins, i, 1));
+        }
+    }
+
+    wake = s->intfl & s->wken;
+    for (i = 0; i < GPIO_NUM_PINS; i++) {
+        qemu_set_irq(s->wakeup[i], extract32(wake, i, 1));
+    }
+    qemu_set_irq(s->irq, !!(s->intfl & s->inten));
+}
+
+static void max78000_gpio_set_pin(Max78000GpioState *s, int pin, bool level)
+{
+    s->ext_driven |= 1u << pin;
+    s->ext_level = deposit32(s->ext_level, pin, 1, level);
+    max78000_gpio_update(s);
+}
+
+static void max78000_gpio_input(void *opaque, int pin, int level)
+{
+    max78000_gpio_set_pin(opaque, pin, level);
+}
+
+static void max78000_gpio_clk_update(void *opaque, ClockEvent event)
+{
+    max78000_gpio_update(opaque);
+}
+
+/* Apply every queued transition that is due, and wait for the next one */
+static void max78000_gpio_stim_run(void *opaque)
+{
+    Max78000GpioState *s = opaque;
+    int64_t now = qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
+    bool consumed = false;
+
+    while (s->stim_count) {
+        Max78000GpioEvent *ev = &s->stim[s->stim_head];
+
+        if (ev->time > now) {
+            timer_mod(s->stim_timer, ev->time);
+            break;
+        }
+        max78000_gpio_set_pin(s, ev->pin, ev->level);
+        s->stim_head = (s->stim_head + 1) % GPIO_STIM_QUEUE;
+        s->stim_count--;
+        consumed = true;
+    }
+    if (consumed) {
+        qemu_chr_fe_accept_input(&s->chr);
+    }
+}
+
+static bool max78000_gpio_stim_parse(Max78000GpioState *s, const char *line)
+{
+    const char *p = line;
+    Max78000GpioEvent *ev;
+    bool relative;
+    int64_t time;
+    uint64_t pin, level;
+
+    while (qemu_isspace(*p)) {
+        p++;
+    }
+    if (*p == '\0' || *p == '#') {
+        return true;
+    }
+    relative = *p == '+';
+    if (relative) {
+        p++;
+    }
+    if (qemu_strtoi64(p, &p, 0, &time) < 0 || time < 0 ||
+        qemu_strtou64(p, &p, 0, &pin) < 0 || pin >= GPIO_NUM_PINS ||
+        qemu_strtou64(p, &p, 0, &level) < 0 || level > 1) {
+        return false;
+    }
+    while (qemu_isspace(*p)) {
+        p++;
+    }
+    if (*p != '\0') {
+        return false;
+    }
+
+    if (relative) {
+        time += s->stim_last;
+    }
+    s->stim_last = time;
+
+    /* can_receive never lets more lines in than there are free slots */
+    assert(s->stim_count < GPIO_STIM_QUEUE);
+    ev = &s->stim[(s->stim_head + s->stim_count) % GPIO_STIM_QUEUE];
+    ev->time = time;
+    ev->pin = pin;
+    ev->level = level;
+    s->stim_count++;
+    return true;
+}
+
+static int max78000_gpio_stim_can_receive(void *opaque)
+{
+    Max78000GpioState *s = opaque;
+
+    /* Every line ends in a byte, so this bounds the lines as well */
+    return GPIO_STIM_QUEUE - s->stim_count;
+}
+
+static void max78000_gpio_stim_receive(void *opaque, const uint8_t *buf,
+                                       int size)
+{
+    Max78000GpioState *s = opaque;
+    int i;
+
+    for (i = 0; i < size; i++) {
+        if (buf[i] != '\n') {
+            /* Overlong lines are dropped whole once their end arrives */
+            if (s->stim_line_len < GPIO_STIM_LINE) {
+                s->stim_line[s->stim_line_len++] = buf[i];
+            }
+            continue;
+        }
+        if (s->stim_line_len < GPIO_STIM_LINE) {
+            s->stim_line[s->stim_line_len] = '\0';
+            if (!max78000_gpio_stim_parse(s, s->stim_line)) {
+                qemu_log_mask(LOG_GUEST_ERROR,
+                              "%s: bad stimulus line '%s'\n",
+                              __func__, s->stim_line);
+            }
+        } else {
+            qemu_log_mask(LOG_GUEST_ERROR, "%s: stimulus line too long\n",
+                          __func__);
+        }
+        s->stim_line_len = 0;
+    }
+    max78000_gpio_stim_run(s);
+}
+
+static uint64_t max78000_gpio_read(void *opaque, hwaddr addr,
+                                   unsigned int size)
+{
+    Max78000GpioState *s = opaque;
+
+    switch (addr) {
+    case GPIO_EN0:
+    case GPIO_EN0_SET:
+    case GPIO_EN0_CLR:
+        return s->en0;
+
+    case GPIO_OUTEN:
+    case GPIO_OUTEN_SET:
+    case GPIO_OUTEN_CLR:
+        return s->outen;
+
+    case GPIO_OUT:
+    case GPIO_OUT_SET:
+    case GPIO_OUT_CLR:
+        return s->out;
+
+    case GPIO_IN:
+        return max78000_gpio_pins(s);
+
+    case GPIO_INTMODE:
+        return s->intmode;
+
+    case GPIO_INTPOL:
+        return s->intpol;
+
+    case GPIO_INEN:
+        return s->inen;
+
+    case GPIO_INTEN:
+    case GPIO_INTEN_SET:
+    case GPIO_INTEN_CLR:
+        return s->inten;
+
+    case GPIO_INTFL:
+    case GPIO_INTFL_CLR:
+        return s->intfl;
+
+    case GPIO_WKEN:
+    case GPIO_WKEN_SET:
+    case GPIO_WKEN_CLR:
+        return s->wken;
+
+    case GPIO_DUALEDGE:
+        return s->dualedge;
+
+    case GPIO_PADCTRL0:
+        return s->padctrl0;
+
+    case GPIO_PADCTRL1:
+        return s->padctrl1;
+
+    case GPIO_EN1:
+    case GPIO_EN1_SET:
+    case GPIO_EN1_CLR:
+        return s->en1;
+
+    case GPIO_EN2:
+    case GPIO_EN2_SET:
+    case GPIO_EN2_CLR:
+        return s->en2;
+
+    case GPIO_HYSEN:
+        return s->hysen;
+
+    case GPIO_SRSEL:
+        return s->srsel;
+
+    case GPIO_DS0:
+        return s->ds0;
+
+    case GPIO_DS1:
+        return s->ds1;
+
+    case GPIO_PSSEL:
+        return s->pssel;
+
+    case GPIO_VSSEL:
+        return s->vssel;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        return 0;
+    }
+}
+
+static void max78000_gpio_write(void *opaque, hwaddr addr,
+                                uint64_t val64, unsigned int size)
+{
+    Max78000GpioState *s = opaque;
+    uint32_t val = val64;
+
+    switch (addr) {
+    case GPIO_EN0:
+        s->en0 = val;
+        break;
+
+    case GPIO_EN0_SET:
+        s->en0 |= val;
+        break;
+
+    case GPIO_EN0_CLR:
+        s->en0 &= ~val;
+        break;
+
+    case GPIO_OUTEN:
+        s->outen = val;
+        break;
+
+    case GPIO_OUTEN_SET:
+        s->outen |= val;
+        break;
+
+    case GPIO_OUTEN_CLR:
+        s->outen &= ~val;
+        break;
+
+    case GPIO_OUT:
+        s->out = val;
+        break;
+
+    case GPIO_OUT_SET:
+        s->out |= val;
+        break;
+
+    case GPIO_OUT_CLR:
+        s->out &= ~val;
+        break;
+
+    case GPIO_IN:
+        /* GPIO_IN is read only */
+        return;
+
+    case GPIO_INTMODE:
+        s->intmode = val;
+        break;
+
+    case GPIO_INTPOL:
+        s->intpol = val;
+        break;
+
+    case GPIO_INEN:
+        s->inen = val;
+        break;
+
+    case GPIO_INTEN:
+        s->inten = val;
+        break;
+
+    case GPIO_INTEN_SET:
+        s->inten |= val;
+        break;
+
+    case GPIO_INTEN_CLR:
+        s->inten &= ~val;
+        break;
+
+    case GPIO_INTFL:
+        /* GPIO_INTFL is read only */
+        return;
+
+    case GPIO_INTFL_CLR:
+        s->intfl &= ~val;
+        break;
+
+    case GPIO_WKEN:
+        s->wken = val;
+        break;
+
+    case GPIO_WKEN_SET:
+        s->wken |= val;
+        break;
+
+    case GPIO_WKEN_CLR:
+        s->wken &= ~val;
+        break;
+
+    case GPIO_DUALEDGE:
+        s->dualedge = val;
+        break;
+
+    case GPIO_PADCTRL0:
+        s->padctrl0 = val;
+        break;
+
+    case GPIO_PADCTRL1:
+        s->padctrl1 = val;
+        break;
+
+    case GPIO_EN1:
+        s->en1 = val;
+        break;
+
+    case GPIO_EN1_SET:
+        s->en1 |= val;
+        break;
+
+    case GPIO_EN1_CLR:
+        s->en1 &= ~val;
+        break;
+
+    case GPIO_EN2:
+        s->en2 = val;
+        break;
+
+    case GPIO_EN2_SET:
+        s->en2 |= val;
+        break;
+
+    case GPIO_EN2_CLR:
+        s->en2 &= ~val;
+        break;
+
+    case GPIO_HYSEN:
+        s->hysen = val;
+        break;
+
+    case GPIO_SRSEL:
+        s->srsel = val;
+        break;
+
+    case GPIO_DS0:
+        s->ds0 = val;
+        break;
+
+    case GPIO_DS1:
+        s->ds1 = val;
+        break;
+
+    case GPIO_PSSEL:
+        s->pssel = val;
+        break;
+
+    case GPIO_VSSEL:
+        s->vssel = val;
+        break;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        return;
+    }
+
+    max78000_gpio_update(s);
+}
+
+static void max78000_gpio_reset_hold(Object *obj, ResetType type)
+{
+    Max78000GpioState *s = MAX78000_GPIO(obj);
+
+    s->en0 = 0xffffffff;
+    s->en1 = 0;
+    s->en2 = 0;
+    s->outen = 0;
+    s->out = 0;
+    s->intmode = 0;
+    s->intpol = 0;
+    s->inen = 0;
+    s->inten = 0;
+    s->intfl = 0;
+    s->wken = 0;
+    s->dualedge = 0;
+    s->padctrl0 = 0;
+    s->padctrl1 = 0;
+    s->hysen = 0;
+    s->srsel = 0;
+    s->ds0 = 0;
+    s->ds1 = 0;
+    s->pssel = 0;
+    s->vssel = 0;
+
+    /* Whatever is attached to the pins keeps driving them */
+    s->level = max78000_gpio_pins(s);
+}
+
+static void max78000_gpio_reset_exit(Object *obj, ResetType type)
+{
+    Max78000GpioState *s = MAX78000_GPIO(obj);
+    uint32_t pins = s->level;
+    int i;
+
+    for (i = 0; i < GPIO_NUM_PINS; i++) {
+        qemu_set_irq(s->pin_out[i], extract32(pins, i, 1));
+    }
+    max78000_gpio_update(s);
+}
+
+static const MemoryRegionOps max78000_gpio_ops = {
+    .read = max78000_gpio_read,
+    .write = max78000_gpio_write,
+    .endianness = DEVICE_LITTLE_ENDIAN,
+    .valid.min_access_size = 4,
+    .valid.max_access_size = 4,
+};
+
+static const Property max78000_gpio_properties[] = {
+    DEFINE_PROP_CHR("chardev", Max78000GpioState, chr),
+};
+
+/* Queued stimulus is host-side input, like unread chardev data */
+static const VMStateDescription vmstate_max78000_gpio = {
+    .name = TYPE_MAX78000_GPIO,
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(en0, Max78000GpioState),
+        VMSTATE_UINT32(en1, Max78000GpioState),
+        VMSTATE_UINT32(en2, Max78000GpioState),
+        VMSTATE_UINT32(outen, Max78000GpioState),
+        VMSTATE_UINT32(out, Max78000GpioState),
+        VMSTATE_UINT32(intmode, Max78000GpioState),
+        VMSTATE_UINT32(intpol, Max78000GpioState),
+        VMSTATE_UINT32(inen, Max78000GpioState),
+        VMSTATE_UINT32(inten, Max78000GpioState),
+        VMSTATE_UINT32(intfl, Max78000GpioState),
+        VMSTATE_UINT32(wken, Max78000GpioState),
+        VMSTATE_UINT32(dualedge, Max78000GpioState),
+        VMSTATE_UINT32(padctrl0, Max78000GpioState),
+        VMSTATE_UINT32(padctrl1, Max78000GpioState),
+        VMSTATE_UINT32(hysen, Max78000GpioState),
+        VMSTATE_UINT32(srsel, Max78000GpioState),
+        VMSTATE_UINT32(ds0, Max78000GpioState),
+        VMSTATE_UINT32(ds1, Max78000GpioState),
+        VMSTATE_UINT32(pssel, Max78000GpioState),
+        VMSTATE_UINT32(vssel, Max78000GpioState),
+        VMSTATE_UINT32(ext_level, Max78000GpioState),
+        VMSTATE_UINT32(ext_driven, Max78000GpioState),
+        VMSTATE_UINT32(level, Max78000GpioState),
+        VMSTATE_CLOCK(clk, Max78000GpioState),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static void max78000_gpio_init(Object *obj)
+{
+    Max78000GpioState *s = MAX78000_GPIO(obj);
+
+    sysbus_init_irq(SYS_BUS_DEVICE(obj), &s->irq);
+    qdev_init_gpio_in(DEVICE(obj), max78000_gpio_input, GPIO_NUM_PINS);
+    qdev_init_gpio_out(DEVICE(obj), s->pin_out, GPIO_NUM_PINS);
+    qdev_init_gpio_out_named(DEVICE(obj), s->wakeup, "wakeup",
+                             GPIO_NUM_PINS);
+
+    memory_region_init_io(&s->mmio, obj, &max78000_gpio_ops, s,
+                          TYPE_MAX78000_GPIO, 0x200);
+    sysbus_init_mmio(SYS_BUS_DEVICE(obj), &s->mmio);
+
+    s->clk = qdev_init_clock_in(DEVICE(s), "clk", max78000_gpio_clk_update, s,
+                                ClockUpdate);
+}
+
+static void max78000_gpio_realize(DeviceState *dev, Error **errp)
+{
+    Max78000GpioState *s = MAX78000_GPIO(dev);
+
+    if (!clock_has_source(s->clk)) {
+        error_setg(errp, "MAX78000 GPIO: clk must be connected");
+        return;
+    }
+
+    s->stim_timer = timer_new_ns(QEMU_CLOCK_VIRTUAL,
+                                 max78000_gpio_stim_run, s);
+    qemu_chr_fe_set_handlers(&s->chr, max78000_gpio_stim_can_receive,
+                             max78000_gpio_stim_receive, NULL, NULL,
+                             s, NULL, true);
+}
+
+static void max78000_gpio_class_init(ObjectClass *klass, const void *data)
+{
+    ResettableClass *rc = RESETTABLE_CLASS(klass);
+    DeviceClass *dc = DEVICE_CLASS(klass);
+
+    rc->phases.hold = max78000_gpio_reset_hold;
+    rc->phases.exit = max78000_gpio_reset_exit;
+    device_class_set_props(dc, max78000_gpio_properties);
+    dc->realize = max78000_gpio_realize;
+    dc->vmsd = &vmstate_max78000_gpio;
+}
+
+static const TypeInfo max78000_gpio_info = {
+    .name          = TYPE_MAX78000_GPIO,
+    .parent        = TYPE_SYS_BUS_DEVICE,
+    .instance_size = sizeof(Max78000GpioState),
+    .instance_init = max78000_gpio_init,
+    .class_init    = max78000_gpio_class_init,
+};
+
+static void max78000_gpio_register_types(void)
+{
+    type_register_static(&max78000_gpio_info);
+}
+
+type_init(max78000_gpio_register_types)
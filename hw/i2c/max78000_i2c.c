@@ -0,0 +1,538 @@
+/*
+ * MAX78000 I2C
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Only master mode is modeled. Setting MSTCTRL.START sends the address
+ * byte at the head of the TX FIFO; the rest of the transaction moves
+ * as many bytes as the FIFOs allow at once and only waits for the guest
+ * when the TX FIFO runs dry or the RX FIFO fills. No bus timing is
+ * modeled, so a transaction that fits in the FIFOs completes within
+ * the MMIO write that issues STOP, and the interrupt line is updated
+ * once, after the controller has run as far as it can. Ten bit
+ * addressing and the slave registers are stored but have no effect.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/log.h"
+#include "qapi/error.h"
+#include "trace.h"
+#include "hw/irq.h"
+#include "hw/qdev-clock.h"
+#include "migration/vmstate.h"
+#include "hw/i2c/max78000_i2c.h"
+
+static void max78000_i2c_update(Max78000I2cState *s)
+{
+    uint32_t tx_thd = (s->txctrl0 >> I2C_TXCTRL0_THD_SHIFT) &
+                      I2C_TXCTRL0_THD_MASK;
+    uint32_t rx_thd = (s->rxctrl0 >> I2C_RXCTRL0_THD_SHIFT) &
+                      I2C_RXCTRL0_THD_MASK;
+    uint32_t tx_lvl = fifo8_num_used(&s->tx_fifo);
+    uint32_t rx_lvl = fifo8_num_used(&s->rx_fifo);
+
+    if (tx_lvl <= tx_thd) {
+        s->intfl0 |= I2C_INT0_TX_THD;
+    }
+    if (rx_lvl && rx_lvl >= rx_thd) {
+        s->intfl0 |= I2C_INT0_RX_THD;
+    }
+
+    qemu_set_irq(s->irq, (s->intfl0 & s->inten0) || (s->intfl1 & s->inten1));
+    qemu_set_irq(s->dma_tx_req, (s->dma & I2C_DMA_TX_EN) &&
+                 !fifo8_is_full(&s->tx_fifo) && tx_lvl <= tx_thd);
+    qemu_set_irq(s->dma_rx_req, (s->dma & I2C_DMA_RX_EN) &&
+                 rx_lvl && rx_lvl >= rx_thd);
+}
+
+static void max78000_i2c_stop(Max78000I2cState *s, uint32_t flags)
+{
+    i2c_end_transfer(s->bus);
+    s->mst_state = I2C_MST_IDLE;
+    s->mstctrl &= ~(I2C_MSTCTRL_START | I2C_MSTCTRL_RESTART |
+                    I2C_MSTCTRL_STOP);
+    s->intfl0 |= flags | I2C_INT0_STOP;
+}
+
+/*
+ * Once a write has drained the TX FIFO or a read has received its
+ * count, a pending RESTART or STOP ends the current transfer. Returns
+ * false if neither has been requested yet.
+ */
+static bool max78000_i2c_end_transfer(Max78000I2cState *s)
+{
+    if (s->mstctrl & I2C_MSTCTRL_RESTART) {
+        s->mstctrl &= ~I2C_MSTCTRL_RESTART;
+        s->mst_state = I2C_MST_ADDR;
+        s->intfl0 |= I2C_INT0_DONE;
+        return true;
+    }
+    if (s->mstctrl & I2C_MSTCTRL_STOP) {
+        max78000_i2c_stop(s, I2C_INT0_DONE);
+        return true;
+    }
+    return false;
+}
+
+static void max78000_i2c_run(Max78000I2cState *s)
+{
+    uint8_t byte;
+
+    if (!clock_is_enabled(s->clk)) {
+        return;
+    }
+
+    for (;;) {
+        switch (s->mst_state) {
+        case I2C_MST_IDLE:
+            return;
+
+        case I2C_MST_ADDR:
+            if (fifo8_is_empty(&s->tx_fifo)) {
+                return;
+            }
+            byte = fifo8_pop(&s->tx_fifo);
+            if (s->mstctrl & I2C_MSTCTRL_EX_ADDR_EN) {
+                qemu_log_mask(LOG_UNIMP, "%s: 10 bit addressing is not "
+                              "supported\n", __func__);
+            }
+            s->mstctrl &= ~I2C_MSTCTRL_START;
+            if (i2c_start_transfer(s->bus, byte >> 1, byte & 1)) {
+                if (!(s->txctrl0 & I2C_TXCTRL0_NACK_FLUSH_DIS)) {
+                    fifo8_reset(&s->tx_fifo);
+                }
+                max78000_i2c_stop(s, I2C_INT0_ADDR_NACK_ERR);
+                return;
+            }
+            s->intfl0 |= I2C_INT0_ADDR_ACK;
+            if (byte & 1) {
+                s->rx_left = (s->rxctrl1 & I2C_RXCTRL1_CNT_MASK) ?: 256;
+                s->mst_state = I2C_MST_READ;
+            } else {
+                s->mst_state = I2C_MST_WRITE;
+            }
+            break;
+
+        case I2C_MST_WRITE:
+            if (!fifo8_is_empty(&s->tx_fifo)) {
+                if (i2c_send(s->bus, fifo8_pop(&s->tx_fifo))) {
+                    if (!(s->txctrl0 & I2C_TXCTRL0_NACK_FLUSH_DIS)) {
+                        fifo8_reset(&s->tx_fifo);
+                    }
+                    max78000_i2c_stop(s, I2C_INT0_DATA_ERR);
+                    return;
+                }
+            } else if (!max78000_i2c_end_transfer(s)) {
+                return;
+            }
+            break;
+
+        case I2C_MST_READ:
+            if (s->rx_left) {
+                if (fifo8_is_full(&s->rx_fifo)) {
+                    return;
+                }
+                fifo8_push(&s->rx_fifo, i2c_recv(s->bus));
+                s->rx_left--;
+                if (!s->rx_left) {
+                    i2c_nack(s->bus);
+                }
+            } else if (!max78000_i2c_end_transfer(s)) {
+                return;
+            }
+            break;
+        }
+    }
+}
+
+static uint32_t max78000_i2c_status(Max78000I2cState *s)
+{
+    uint32_t status = 0;
+
+    if (s->mst_state != I2C_MST_IDLE) {
+        status |= I2C_STATUS_BUSY | I2C_STATUS_MST_BUSY;
+    }
+    if (fifo8_is_empty(&s->rx_fifo)) {
+        status |= I2C_STATUS_RX_EM;
+    }
+    if (fifo8_is_full(&s->rx_fifo)) {
+        status |= I2C_STATUS_RX_FULL;
+    }
+    if (fifo8_is_empty(&s->tx_fifo)) {
+        status |= I2C_STATUS_TX_EM;
+    }
+    if (fifo8_is_full(&s->tx_fifo)) {
+        status |= I2C_STATUS_TX_FULL;
+    }
+    return status;
+}
+
+static uint64_t max78000_i2c_read(void *opaque, hwaddr addr,
+                                  unsigned int size)
+{
+    Max78000I2cState *s = opaque;
+    uint64_t retvalue = 0;
+
+    switch (addr) {
+    case I2C_CTRL:
+        /* The bus lines idle high */
+        retvalue = s->ctrl | I2C_CTRL_SCL | I2C_CTRL_SDA;
+        break;
+
+    case I2C_STATUS:
+        retvalue = max78000_i2c_status(s);
+        break;
+
+    case I2C_INTFL0:
+        retvalue = s->intfl0;
+        break;
+
+    case I2C_INTEN0:
+        retvalue = s->inten0;
+        break;
+
+    case I2C_INTFL1:
+        retvalue = s->intfl1;
+        break;
+
+    case I2C_INTEN1:
+        retvalue = s->inten1;
+        break;
+
+    case I2C_FIFOLEN:
+        retvalue = I2C_FIFO_SIZE | (I2C_FIFO_SIZE << 8);
+        break;
+
+    case I2C_RXCTRL0:
+        retvalue = s->rxctrl0;
+        break;
+
+    case I2C_RXCTRL1:
+        retvalue = s->rxctrl1 |
+                   (fifo8_num_used(&s->rx_fifo) << I2C_RXCTRL1_LVL_SHIFT);
+        break;
+
+    case I2C_TXCTRL0:
+        retvalue = s->txctrl0;
+        break;
+
+    case I2C_TXCTRL1:
+        retvalue = fifo8_num_used(&s->tx_fifo) << I2C_TXCTRL1_LVL_SHIFT;
+        break;
+
+    case I2C_FIFO:
+        if (fifo8_is_empty(&s->rx_fifo)) {
+            retvalue = 0xff;
+        } else {
+            retvalue = fifo8_pop(&s->rx_fifo);
+            max78000_i2c_run(s);
+        }
+        break;
+
+    case I2C_MSTCTRL:
+        retvalue = s->mstctrl;
+        break;
+
+    case I2C_CLKLO:
+        retvalue = s->clklo;
+        break;
+
+    case I2C_CLKHI:
+        retvalue = s->clkhi;
+        break;
+
+    case I2C_HSCLK:
+        retvalue = s->hsclk;
+        break;
+
+    case I2C_TIMEOUT:
+        retvalue = s->timeout;
+        break;
+
+    case I2C_DMA:
+        retvalue = s->dma;
+        break;
+
+    case I2C_SLAVE:
+        retvalue = s->slave;
+        break;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        break;
+    }
+
+    max78000_i2c_update(s);
+    return retvalue;
+}
+
+static void max78000_i2c_write(void *opaque, hwaddr addr,
+                               uint64_t val64, unsigned int size)
+{
+    Max78000I2cState *s = opaque;
+    uint32_t val = val64;
+
+    switch (addr) {
+    case I2C_CTRL:
+        s->ctrl = val;
+        if (!(val & I2C_CTRL_EN) && s->mst_state != I2C_MST_IDLE) {
+            max78000_i2c_stop(s, 0);
+        }
+        if ((val & I2C_CTRL_EN) && !(val & I2C_CTRL_MST_MODE)) {
+            qemu_log_mask(LOG_UNIMP, "%s: slave mode is not supported\n",
+                          __func__);
+        }
+        break;
+
+    case I2C_INTFL0:
+        s->intfl0 &= ~val;
+        break;
+
+    case I2C_INTEN0:
+        s->inten0 = val;
+        break;
+
+    case I2C_INTFL1:
+        s->intfl1 &= ~val;
+        break;
+
+    case I2C_INTEN1:
+        s->inten1 = val;
+        break;
+
+    case I2C_RXCTRL0:
+        if (val & I2C_RXCTRL0_FLUSH) {
+            fifo8_reset(&s->rx_fifo);
+        }
+        s->rxctrl0 = val & ~I2C_RXCTRL0_FLUSH;
+        max78000_i2c_run(s);
+        break;
+
+    case I2C_RXCTRL1:
+        s->rxctrl1 = val & I2C_RXCTRL1_CNT_MASK;
+        break;
+
+    case I2C_TXCTRL0:
+        if (val & I2C_TXCTRL0_FLUSH) {
+            fifo8_reset(&s->tx_fifo);
+        }
+        s->txctrl0 = val & ~I2C_TXCTRL0_FLUSH;
+        break;
+
+    case I2C_TXCTRL1:
+        break;
+
+    case I2C_FIFO:
+        if (fifo8_is_full(&s->tx_fifo)) {
+            qemu_log_mask(LOG_GUEST_ERROR, "%s: TX FIFO overflow\n",
+                          __func__);
+        } else {
+            fifo8_push(&s->tx_fifo, val);
+            max78000_i2c_run(s);
+        }
+        break;
+
+    case I2C_MSTCTRL:
+        s->mstctrl = (s->mstctrl & (I2C_MSTCTRL_START | I2C_MSTCTRL_RESTART |
+                                    I2C_MSTCTRL_STOP)) | val;
+        if ((s->ctrl & (I2C_CTRL_EN | I2C_CTRL_MST_MODE)) !=
+            (I2C_CTRL_EN | I2C_CTRL_MST_MODE)) {
+            s->mstctrl &= ~(I2C_MSTCTRL_START | I2C_MSTCTRL_RESTART |
+                            I2C_MSTCTRL_STOP);
+            break;
+        }
+        if ((val & I2C_MSTCTRL_START) && s->mst_state == I2C_MST_IDLE) {
+            s->mst_state = I2C_MST_ADDR;
+            s->intfl1 |= I2C_INT1_START;
+        } else if (s->mst_state == I2C_MST_IDLE) {
+            s->mstctrl &= ~(I2C_MSTCTRL_RESTART | I2C_MSTCTRL_STOP);
+        }
+        max78000_i2c_run(s);
+        break;
+
+    case I2C_CLKLO:
+        s->clklo = val;
+        break;
+
+    case I2C_CLKHI:
+        s->clkhi = val;
+        break;
+
+    case I2C_HSCLK:
+        s->hsclk = val;
+        break;
+
+    case I2C_TIMEOUT:
+        s->timeout = val;
+        break;
+
+    case I2C_DMA:
+        s->dma = val;
+        break;
+
+    case I2C_SLAVE:
+        s->slave = val;
+        break;
+
+    case I2C_STATUS:
+    case I2C_FIFOLEN:
+        break;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        break;
+    }
+
+    max78000_i2c_update(s);
+}
+
+static void max78000_i2c_clk_update(void *opaque, ClockEvent event)
+{
+    Max78000I2cState *s = opaque;
+
+    max78000_i2c_run(s);
+    max78000_i2c_update(s);
+}
+
+static void max78000_i2c_reset_hold(Object *obj, ResetType type)
+{
+    Max78000I2cState *s = MAX78000_I2C(obj);
+
+    if (s->mst_state != I2C_MST_IDLE) {
+        i2c_end_transfer(s->bus);
+    }
+
+    s->ctrl = 0;
+    s->intfl0 = 0;
+    s->inten0 = 0;
+    s->intfl1 = 0;
+    s->inten1 = 0;
+    s->rxctrl0 = 0;
+    s->rxctrl1 = 0;
+    s->txctrl0 = 0;
+    s->mstctrl = 0;
+    s->clklo = 0;
+    s->clkhi = 0;
+    s->hsclk = 0;
+    s->timeout = 0;
+    s->dma = 0;
+    s->slave = 0;
+    s->mst_state = I2C_MST_IDLE;
+    s->rx_left = 0;
+
+    fifo8_reset(&s->tx_fifo);
+    fifo8_reset(&s->rx_fifo);
+}
+
+static void max78000_i2c_reset_exit(Object *obj, ResetType type)
+{
+    Max78000I2cState *s = MAX78000_I2C(obj);
+
+    max78000_i2c_update(s);
+}
+
+/* The FIFO is commonly accessed bytewise; the rest are word */
+static bool max78000_i2c_accepts(void *opaque, hwaddr addr, unsigned size,
+                                 bool is_write, MemTxAttrs attrs)
+{
+    return size == 4 || addr == I2C_FIFO;
+}
+
+static const MemoryRegionOps max78000_i2c_ops = {
+    .read = max78000_i2c_read,
+    .write = max78000_i2c_write,
+    .endianness = DEVICE_LITTLE_ENDIAN,
+    .valid.min_access_size = 1,
+    .valid.max_access_size = 4,
+    .valid.accepts = max78000_i2c_accepts,
+};
+
+static const VMStateDescription vmstate_max78000_i2c = {
+    .name = TYPE_MAX78000_I2C,
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(ctrl, Max78000I2cState),
+        VMSTATE_UINT32(intfl0, Max78000I2cState),
+        VMSTATE_UINT32(inten0, Max78000I2cState),
+        VMSTATE_UINT32(intfl1, Max78000I2cState),
+        VMSTATE_UINT32(inten1, Max78000I2cState),
+        VMSTATE_UINT32(rxctrl0, Max78000I2cState),
+        VMSTATE_UINT32(rxctrl1, Max78000I2cState),
+        VMSTATE_UINT32(txctrl0, Max78000I2cState),
+        VMSTATE_UINT32(mstctrl, Max78000I2cState),
+        VMSTATE_UINT32(clklo, Max78000I2cState),
+        VMSTATE_UINT32(clkhi, Max78000I2cState),
+        VMSTATE_UINT32(hsclk, Max78000I2cState),
+        VMSTATE_UINT32(timeout, Max78000I2cState),
+        VMSTATE_UINT32(dma, Max78000I2cState),
+        VMSTATE_UINT32(slave, Max78000I2cState),
+        VMSTATE_FIFO8(tx_fifo, Max78000I2cState),
+        VMSTATE_FIFO8(rx_fifo, Max78000I2cState),
+        VMSTATE_UINT32(mst_state, Max78000I2cState),
+        VMSTATE_UINT32(rx_left, Max78000I2cState),
+        VMSTATE_CLOCK(clk, Max78000I2cState),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static void max78000_i2c_init(Object *obj)
+{
+    Max78000I2cState *s = MAX78000_I2C(obj);
+
+    s->bus = i2c_init_bus(DEVICE(obj), "i2c");
+
+    sysbus_init_irq(SYS_BUS_DEVICE(obj), &s->irq);
+    qdev_init_gpio_out_named(DEVICE(obj), &s->dma_tx_req, "dma-tx", 1);
+    qdev_init_gpio_out_named(DEVICE(obj), &s->dma_rx_req, "dma-rx", 1);
+
+    s->clk = qdev_init_clock_in(DEVICE(obj), "clk", max78000_i2c_clk_update,
+                                s, ClockUpdate);
+
+    fifo8_create(&s->tx_fifo, I2C_FIFO_SIZE);
+    fifo8_create(&s->rx_fifo, I2C_FIFO_SIZE);
+
+    memory_region_init_io(&s->mmio, obj, &max78000_i2c_ops, s,
+                          TYPE_MAX78000_I2C, 0x1000);
+    sysbus_init_mmio(SYS_BUS_DEVICE(obj), &s->mmio);
+}
+
+static void max78000_i2c_realize(DeviceState *dev, Error **errp)
+{
+    Max78000I2cState *s = MAX78000_I2C(dev);
+
+    if (!clock_has_source(s->clk)) {
+        error_setg(errp, "MAX78000 I2C: clk must be connected");
+        return;
+    }
+}
+
+static void max78000_i2c_class_init(ObjectClass *klass, const void *data)
+{
+    ResettableClass *rc = RESETTABLE_CLASS(klass);
+    DeviceClass *dc = DEVICE_CLASS(klass);
+
+    rc->phases.hold = max78000_i2c_reset_hold;
+    rc->phases.exit = max78000_i2c_reset_exit;
+    dc->realize = max78000_i2c_realize;
+    dc->vmsd = &vmstate_max78000_i2c;
+}
+
+static const TypeInfo max78000_i2c_info = {
+    .name          = TYPE_MAX78000_I2C,
+    .parent        = TYPE_SYS_BUS_DEVICE,
+    .instance_size = sizeof(Max78000I2cState),
+    .instance_init = max78000_i2c_init,
+    .class_init    = max78000_i2c_class_init,
+};
+
+static void max78000_i2c_register_types(void)
+{
+    type_register_static(&max78000_i2c_info);
+}
+
+type_init(max78000_i2c_register_types)
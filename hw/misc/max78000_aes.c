@@ -10,13 +10,70 @@
 #include "qemu/log.h"
 #include "trace.h"
 #include "hw/irq.h"
+#include "hw/qdev-clock.h"
 #include "migration/vmstate.h"
 #include "hw/misc/max78000_aes.h"
 #include "crypto/aes.h"
 
+static bool max78000_aes_streaming(Max78000AesState *s)
+{
+    return s->ctrl & AES_DMA_TX_EN;
+}
+
+static uint32_t max78000_aes_stream_level(Max78000AesState *s)
+{
+    return s->stream_out_len - s->stream_out_pos;
+}
+
+static void max78000_aes_update_irq(Max78000AesState *s)
+{
+    qemu_set_irq(s->irq, s->intfl & s->inten);
+}
+
+/*
+ * The DMA feeds the input FIFO (TX) while there is room for another
+ * word, and empties the output FIFO (RX) while it holds data. Enabling
+ * TX DMA selects streaming mode, so outside it only RX is requested.
+ */
+static void max78000_aes_update_dma(Max78000AesState *s)
+{
+    if (!clock_is_enabled(s->clk)) {
+        qemu_set_irq(s->dma_tx_req, 0);
+        qemu_set_irq(s->dma_rx_req, 0);
+        return;
+    }
+    if (max78000_aes_streaming(s)) {
+        qemu_set_irq(s->dma_tx_req, s->stream_in_len < AES_STREAM_SIZE);
+        qemu_set_irq(s->dma_rx_req, (s->ctrl & AES_DMA_RX_EN) &&
+                     max78000_aes_stream_level(s) != 0);
+        return;
+    }
+    qemu_set_irq(s->dma_tx_req, 0);
+    qemu_set_irq(s->dma_rx_req, (s->ctrl & AES_DMA_RX_EN) &&
+                 s->result_index != 0);
+}
+
 static void max78000_aes_set_status(Max78000AesState *s)
 {
     s->status = 0;
+    if (max78000_aes_streaming(s)) {
+        if (max78000_aes_stream_level(s) == AES_STREAM_SIZE) {
+            s->status |= OUTPUT_FULL;
+        }
+        if (max78000_aes_stream_level(s) == 0) {
+            s->status |= OUTPUT_EMPTY;
+        }
+        if (s->stream_in_len == AES_STREAM_SIZE) {
+            s->status |= INPUT_FULL;
+        }
+        if (s->stream_in_len == 0) {
+            s->status |= INPUT_EMPTY;
+        }
+        if (s->busy_blocks) {
+            s->status |= BUSY;
+        }
+        return;
+    }
     if (s->result_index >= 16) {
         s->status |= OUTPUT_FULL;
     }
@@ -31,6 +88,260 @@ static void max78000_aes_set_status(Max78000AesState *s)
     }
 }
 
+static void max78000_aes_load_rk(AESState *rk, const AES_KEY *key)
+{
+    int i, j;
+
+    for (i = 0; i <= key->rounds; i++) {
+        for (j = 0; j < 4; j++) {
+            stl_be_p(&rk[i].b[j * 4], key->rd_key[i * 4 + j]);
+        }
+    }
+}
+
+static void max78000_aes_expand_key(Max78000AesState *s)
+{
+    AES_KEY key;
+    int keylen = 256;
+    uint8_t *keydata = s->key;
+
+    if ((s->ctrl & KEY_SIZE) == 0) {
+        keylen = 128;
+        keydata += 16;
+    } else if ((s->ctrl & KEY_SIZE) == 1 << 6) {
+        keylen = 192;
+        keydata += 8;
+    }
+
+    AES_set_encrypt_key(keydata, keylen, &key);
+    AES_set_decrypt_key(keydata, keylen, &s->dec_key);
+    max78000_aes_load_rk(s->enc_rk, &key);
+    max78000_aes_load_rk(s->dec_rk, &s->dec_key);
+    s->key_cached = true;
+}
+
+void max78000_aes_set_key(Max78000AesState *s, const uint8_t *key)
+{
+    if (key) {
+        memcpy(s->key, key, sizeof(s->key));
+    } else {
+        memset(s->key, 0, sizeof(s->key));
+    }
+    s->key_cached = false;
+}
+
+static void max78000_aes_encrypt_block(uint8_t *out, const uint8_t *in,
+                                       const AESState *rk, int rounds)
+{
+    AESState st;
+    int i;
+
+    memcpy(&st, in, sizeof(st));
+    st.v ^= rk[0].v;
+    for (i = 1; i < rounds; i++) {
+        aesenc_SB_SR_MC_AK(&st, &st, &rk[i], false);
+    }
+    aesenc_SB_SR_AK(&st, &st, &rk[rounds], false);
+    memcpy(out, &st, sizeof(st));
+}
+
+/* @rk is a decryption key schedule, as set up by AES_set_decrypt_key() */
+static void max78000_aes_decrypt_block(uint8_t *out, const uint8_t *in,
+                                       const AESState *rk, int rounds)
+{
+    AESState st;
+    int i;
+
+    memcpy(&st, in, sizeof(st));
+    st.v ^= rk[0].v;
+    for (i = 1; i < rounds; i++) {
+        aesdec_ISB_ISR_IMC_AK(&st, &st, &rk[i], false);
+    }
+    aesdec_ISB_ISR_AK(&st, &st, &rk[rounds], false);
+    memcpy(out, &st, sizeof(st));
+}
+
+/* Run @nblocks blocks through the engine as currently configured */
+static void max78000_aes_crypt(Max78000AesState *s, uint8_t *out,
+                               const uint8_t *in, unsigned nblocks)
+{
+    const AESState *rk;
+    int rounds;
+    bool encrypt = false;
+    unsigned i;
+
+    /*
+     * The MAX78000 AES engine stores an internal key, which it uses only
+     * for decryption. Both encryption and decryption with the external
+     * key load it with the decryption schedule of that key. As the
+     * internal key is only replaced when the external key is expanded
+     * again, it can be refreshed together with the cache.
+     */
+    if ((s->ctrl & TYPE) == 0 || (s->ctrl & TYPE) == 1 << 8) {
+        if (!s->key_cached) {
+            max78000_aes_expand_key(s);
+            s->internal_key = s->dec_key;
+            memcpy(s->internal_rk, s->dec_rk, sizeof(s->internal_rk));
+        }
+    }
+
+    if ((s->ctrl & TYPE) == 0) {
+        rk = s->enc_rk;
+        rounds = s->dec_key.rounds;
+        encrypt = true;
+    } else if ((s->ctrl & TYPE) == 1 << 8) {
+        rk = s->dec_rk;
+        rounds = s->dec_key.rounds;
+    } else {
+        rk = s->internal_rk;
+        rounds = s->internal_key.rounds;
+    }
+
+    for (i = 0; i < nblocks; i++) {
+        if (encrypt) {
+            max78000_aes_encrypt_block(out, in, rk, rounds);
+        } else {
+            max78000_aes_decrypt_block(out, in, rk, rounds);
+        }
+        in += AES_BLOCK_SIZE;
+        out += AES_BLOCK_SIZE;
+    }
+}
+
+static void max78000_aes_do_crypto(Max78000AesState *s)
+{
+    max78000_aes_crypt(s, s->result, s->data, 1);
+    s->result_index = 16;
+    s->intfl |= DONE;
+    max78000_aes_update_irq(s);
+}
+
+static int64_t max78000_aes_latency(Max78000AesState *s, unsigned nblocks)
+{
+    unsigned rounds = 14;
+
+    if ((s->ctrl & KEY_SIZE) == 0) {
+        rounds = 10;
+    } else if ((s->ctrl & KEY_SIZE) == 1 << 6) {
+        rounds = 12;
+    }
+    return clock_ticks_to_ns(s->clk,
+                             (uint64_t)nblocks * (rounds + AES_OVERHEAD_CYCLES));
+}
+
+/* Start a batch with every complete input block the output has room for */
+static void max78000_aes_stream_start(Max78000AesState *s)
+{
+    uint32_t level = max78000_aes_stream_level(s);
+    unsigned nblocks;
+
+    if (s->busy_blocks || !clock_is_enabled(s->clk)) {
+        return;
+    }
+    nblocks = MIN(s->stream_in_len, AES_STREAM_SIZE - level) /
+              AES_BLOCK_SIZE;
+    if (!nblocks) {
+        return;
+    }
+
+    memmove(s->stream_out, s->stream_out + s->stream_out_pos, level);
+    s->stream_out_pos = 0;
+    s->stream_out_len = level;
+
+    s->busy_blocks = nblocks;
+    timer_mod(s->done_timer, qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL) +
+              max78000_aes_latency(s, nblocks));
+}
+
+static void max78000_aes_stream_done(void *opaque)
+{
+    Max78000AesState *s = opaque;
+    uint32_t len = s->busy_blocks * AES_BLOCK_SIZE;
+
+    max78000_aes_crypt(s, s->stream_out + s->stream_out_len, s->stream_in,
+                       s->busy_blocks);
+    s->stream_out_len += len;
+    s->stream_in_len -= len;
+    memmove(s->stream_in, s->stream_in + len, s->stream_in_len);
+    s->busy_blocks = 0;
+    s->intfl |= DONE;
+
+    max78000_aes_stream_start(s);
+    max78000_aes_set_status(s);
+    max78000_aes_update_irq(s);
+    max78000_aes_update_dma(s);
+}
+
+/*
+ * Words of a block move through the FIFO in the same order as in
+ * single block mode, last word first.
+ */
+static void max78000_aes_stream_write(Max78000AesState *s, uint32_t val)
+{
+    uint32_t off = s->stream_in_len % AES_BLOCK_SIZE;
+
+    if (s->stream_in_len >= AES_STREAM_SIZE) {
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: input FIFO overflow\n",
+                      __func__);
+        return;
+    }
+    stl_be_p(&s->stream_in[s->stream_in_len - off + 12 - off], val);
+    s->stream_in_len += 4;
+    if (off == 12) {
+        max78000_aes_stream_start(s);
+    }
+}
+
+static uint32_t max78000_aes_stream_read(Max78000AesState *s)
+{
+    uint32_t off = s->stream_out_pos % AES_BLOCK_SIZE;
+    uint32_t val;
+
+    if (max78000_aes_stream_level(s) < 4) {
+        return 0;
+    }
+    val = ldl_be_p(&s->stream_out[s->stream_out_pos - off + 12 - off]);
+    s->stream_out_pos += 4;
+    if (max78000_aes_stream_level(s) == 0) {
+        s->intfl &= ~DONE;
+    }
+
+    max78000_aes_stream_start(s);
+    max78000_aes_set_status(s);
+    max78000_aes_update_irq(s);
+    max78000_aes_update_dma(s);
+    return val;
+}
+
+/*
+ * Gating the clock pauses a batch in progress; it starts over once the
+ * clock returns, and whatever was queued meanwhile is picked up then.
+ */
+static void max78000_aes_clk_update(void *opaque, ClockEvent event)
+{
+    Max78000AesState *s = opaque;
+
+    if (!clock_is_enabled(s->clk)) {
+        timer_del(s->done_timer);
+    } else if (s->busy_blocks) {
+        if (!timer_pending(s->done_timer)) {
+            timer_mod(s->done_timer, qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL) +
+                      max78000_aes_latency(s, s->busy_blocks));
+        }
+    } else {
+        max78000_aes_stream_start(s);
+    }
+    max78000_aes_set_status(s);
+    max78000_aes_update_dma(s);
+}
+
+static void max78000_aes_stream_flush_input(Max78000AesState *s)
+{
+    timer_del(s->done_timer);
+    s->busy_blocks = 0;
+    s->stream_in_len = 0;
+}
+
 static uint64_t max78000_aes_read(void *opaque, hwaddr addr,
                                     unsigned int size)
 {
@@ -49,10 +360,15 @@ static uint64_t max78000_aes_read(void *opaque, hwaddr addr,
         return s->inten;
 
     case FIFO:
+        if (max78000_aes_streaming(s)) {
+            return max78000_aes_stream_read(s);
+        }
         if (s->result_index >= 4) {
             s->intfl &= ~DONE;
             s->result_index -= 4;
             max78000_aes_set_status(s);
+            max78000_aes_update_irq(s);
+            max78000_aes_update_dma(s);
             return ldl_be_p(&s->result[s->result_index]);
         } else{
             return 0;
@@ -67,55 +383,24 @@ static uint64_t max78000_aes_read(void *opaque, hwaddr addr,
     return 0;
 }
 
-static void max78000_aes_do_crypto(Max78000AesState *s)
-{
-    int keylen = 256;
-    uint8_t *keydata = s->key;
-    if ((s->ctrl & KEY_SIZE) == 0) {
-        keylen = 128;
-        keydata += 16;
-    } else if ((s->ctrl & KEY_SIZE) == 1 << 6) {
-        keylen = 192;
-        keydata += 8;
-    }
-
-    /*
-     * The MAX78000 AES engine stores an internal key, which it uses only
-     * for decryption. This results in the slighly odd looking pairs of
-     * set_encrypt and set_decrypt calls below; s->internal_key is
-     * being stored for later use in both cases.
-     */
-    AES_KEY key;
-    if ((s->ctrl & TYPE) == 0) {
-        AES_set_encrypt_key(keydata, keylen, &key);
-        AES_set_decrypt_key(keydata, keylen, &s->internal_key);
-        AES_encrypt(s->data, s->result, &key);
-        s->result_index = 16;
-    } else if ((s->ctrl & TYPE) == 1 << 8) {
-        AES_set_decrypt_key(keydata, keylen, &key);
-        AES_set_decrypt_key(keydata, keylen, &s->internal_key);
-        AES_decrypt(s->data, s->result, &key);
-        s->result_index = 16;
-    } else{
-        AES_decrypt(s->data, s->result, &s->internal_key);
-        s->result_index = 16;
-    }
-    s->intfl |= DONE;
-}
-
 static void max78000_aes_write(void *opaque, hwaddr addr,
                     uint64_t val64, unsigned int size)
 {
     Max78000AesState *s = opaque;
     uint32_t val = val64;
+    uint32_t old_ctrl;
     switch (addr) {
     case CTRL:
+        old_ctrl = s->ctrl;
         if (val & OUTPUT_FLUSH) {
             s->result_index = 0;
+            s->stream_out_pos = 0;
+            s->stream_out_len = 0;
             val &= ~OUTPUT_FLUSH;
         }
         if (val & INPUT_FLUSH) {
             s->data_index = 0;
+            max78000_aes_stream_flush_input(s);
             val &= ~INPUT_FLUSH;
         }
         if (val & START) {
@@ -124,9 +409,25 @@ static void max78000_aes_write(void *opaque, hwaddr addr,
 
         /* Hardware appears to stay enabled even if 0 written */
         s->ctrl = val | (s->ctrl & AES_EN);
+        if ((s->ctrl ^ old_ctrl) & KEY_SIZE) {
+            s->key_cached = false;
+        }
+        max78000_aes_stream_start(s);
+        break;
+
+    case INTFL:
+        s->intfl &= ~val;
+        break;
+
+    case INTEN:
+        s->inten = val;
         break;
 
     case FIFO:
+        if (max78000_aes_streaming(s)) {
+            max78000_aes_stream_write(s, val);
+            break;
+        }
         assert(s->data_index <= 12);
         stl_be_p(&s->data[12 - s->data_index], val);
         s->data_index += 4;
@@ -138,6 +439,7 @@ static void max78000_aes_write(void *opaque, hwaddr addr,
 
     case KEY_BASE ... KEY_END - 4:
         stl_be_p(&s->key[(KEY_END - KEY_BASE - 4) - (addr - KEY_BASE)], val);
+        s->key_cached = false;
         break;
 
     default:
@@ -147,6 +449,8 @@ static void max78000_aes_write(void *opaque, hwaddr addr,
 
     }
     max78000_aes_set_status(s);
+    max78000_aes_update_irq(s);
+    max78000_aes_update_dma(s);
 }
 
 static void max78000_aes_reset_hold(Object *obj, ResetType type)
@@ -164,6 +468,20 @@ static void max78000_aes_reset_hold(Object *obj, ResetType type)
     memset(s->key, 0, sizeof(s->key));
     memset(s->result, 0, sizeof(s->result));
     memset(&s->internal_key, 0, sizeof(s->internal_key));
+    memset(s->internal_rk, 0, sizeof(s->internal_rk));
+    s->key_cached = false;
+
+    max78000_aes_stream_flush_input(s);
+    s->stream_out_pos = 0;
+    s->stream_out_len = 0;
+}
+
+static void max78000_aes_reset_exit(Object *obj, ResetType type)
+{
+    Max78000AesState *s = MAX78000_AES(obj);
+
+    max78000_aes_update_irq(s);
+    max78000_aes_update_dma(s);
 }
 
 static const MemoryRegionOps max78000_aes_ops = {
@@ -174,20 +492,55 @@ static const MemoryRegionOps max78000_aes_ops = {
     .valid.max_access_size = 4,
 };
 
+static int max78000_aes_post_load(void *opaque, int version_id)
+{
+    Max78000AesState *s = opaque;
+
+    if (s->internal_key.rounds < 0 || s->internal_key.rounds > AES_MAXNR) {
+        return -EINVAL;
+    }
+    if (s->data_index > 12 || s->data_index % 4 ||
+        s->result_index > 16 || s->result_index % 4) {
+        return -EINVAL;
+    }
+    if (s->stream_in_len > AES_STREAM_SIZE || s->stream_in_len % 4 ||
+        s->stream_out_len > AES_STREAM_SIZE || s->stream_out_len % 4 ||
+        s->stream_out_pos > s->stream_out_len ||
+        s->busy_blocks * AES_BLOCK_SIZE > s->stream_in_len ||
+        s->busy_blocks * AES_BLOCK_SIZE >
+            AES_STREAM_SIZE - s->stream_out_len) {
+        return -EINVAL;
+    }
+    max78000_aes_load_rk(s->internal_rk, &s->internal_key);
+    s->key_cached = false;
+    return 0;
+}
+
 static const VMStateDescription vmstate_max78000_aes = {
     .name = TYPE_MAX78000_AES,
-    .version_id = 1,
-    .minimum_version_id = 1,
+    .version_id = 3,
+    .minimum_version_id = 3,
+    .post_load = max78000_aes_post_load,
     .fields = (const VMStateField[]) {
         VMSTATE_UINT32(ctrl, Max78000AesState),
         VMSTATE_UINT32(status, Max78000AesState),
         VMSTATE_UINT32(intfl, Max78000AesState),
         VMSTATE_UINT32(inten, Max78000AesState),
+        VMSTATE_UINT32(data_index, Max78000AesState),
         VMSTATE_UINT8_ARRAY(data, Max78000AesState, 16),
         VMSTATE_UINT8_ARRAY(key, Max78000AesState, 32),
+        VMSTATE_UINT32(result_index, Max78000AesState),
         VMSTATE_UINT8_ARRAY(result, Max78000AesState, 16),
         VMSTATE_UINT32_ARRAY(internal_key.rd_key, Max78000AesState, 60),
         VMSTATE_INT32(internal_key.rounds, Max78000AesState),
+        VMSTATE_UINT8_ARRAY(stream_in, Max78000AesState, AES_STREAM_SIZE),
+        VMSTATE_UINT32(stream_in_len, Max78000AesState),
+        VMSTATE_UINT8_ARRAY(stream_out, Max78000AesState, AES_STREAM_SIZE),
+        VMSTATE_UINT32(stream_out_pos, Max78000AesState),
+        VMSTATE_UINT32(stream_out_len, Max78000AesState),
+        VMSTATE_UINT32(busy_blocks, Max78000AesState),
+        VMSTATE_TIMER_PTR(done_timer, Max78000AesState),
+        VMSTATE_CLOCK(clk, Max78000AesState),
         VMSTATE_END_OF_LIST()
     }
 };
@@ -196,11 +549,23 @@ static void max78000_aes_init(Object *obj)
 {
     Max78000AesState *s = MAX78000_AES(obj);
     sysbus_init_irq(SYS_BUS_DEVICE(obj), &s->irq);
+    qdev_init_gpio_out_named(DEVICE(obj), &s->dma_tx_req, "dma-tx", 1);
+    qdev_init_gpio_out_named(DEVICE(obj), &s->dma_rx_req, "dma-rx", 1);
 
     memory_region_init_io(&s->mmio, obj, &max78000_aes_ops, s,
                         TYPE_MAX78000_AES, 0xc00);
     sysbus_init_mmio(SYS_BUS_DEVICE(obj), &s->mmio);
 
+    s->clk = qdev_init_clock_in(DEVICE(s), "clk", max78000_aes_clk_update, s,
+                                ClockUpdate);
+}
+
+static void max78000_aes_realize(DeviceState *dev, Error **errp)
+{
+    Max78000AesState *s = MAX78000_AES(dev);
+
+    s->done_timer = timer_new_ns(QEMU_CLOCK_VIRTUAL,
+                                 max78000_aes_stream_done, s);
 }
 
 static void max78000_aes_class_init(ObjectClass *klass, const void *data)
@@ -209,6 +574,8 @@ static void max78000_aes_class_init(ObjectClass *klass, const void *data)
     DeviceClass *dc = DEVICE_CLASS(klass);
 
     rc->phases.hold = max78000_aes_reset_hold;
+    rc->phases.exit = max78000_aes_reset_exit;
+    dc->realize = max78000_aes_realize;
     dc->vmsd = &vmstate_max78000_aes;
 
 }
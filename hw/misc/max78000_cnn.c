@@ -0,0 +1,625 @@
+/*
+ * MAX78000 CNN Accelerator
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * This is a functional model: rather than stepping the 64 hardware
+ * processors through their pipeline, each layer is computed in one go
+ * once the master quadrant is started. Input channels are gathered
+ * from data SRAM into contiguous padded planes, and the convolution
+ * runs as int8 x int8 -> int32 multiply-accumulates over whole rows,
+ * which the host compiler can vectorize.
+ *
+ * Modeled: 2D convolution with 3x3 or 1x1 kernels, 1D convolution
+ * with kernels of up to 9 taps, max/average pooling with strides,
+ * row/column padding, bias, output scaling, ReLU/abs activation and
+ * pooling-only passthrough layers. Streaming mode, the data FIFOs,
+ * element-wise operations and multi-pass layers (more than 64 input
+ * channels) are not modeled.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/log.h"
+#include "qapi/error.h"
+#include "hw/irq.h"
+#include "migration/vmstate.h"
+#include "hw/misc/max78000_cnn.h"
+
+typedef struct Max78000CnnLayer {
+    int in_rows;
+    int in_cols;
+    int pad_rows;
+    int pad_cols;
+    int pool_rows;
+    int pool_cols;
+    int pool_stride;
+    bool max_pool;
+    int rows;
+    int cols;
+    int k_rows;
+    int k_cols;
+    int out_rows;
+    int out_cols;
+    int n_in;
+    int n_out;
+    int in_proc[CNN_NUM_PROCS];
+    bool passthrough;
+    uint32_t rptr;
+    uint32_t wptr;
+    uint32_t choff;
+    uint32_t mstart;
+    uint32_t post;
+    int bias_quad;
+} Max78000CnnLayer;
+
+static void max78000_cnn_update_irq(Max78000CnnState *s)
+{
+    qemu_set_irq(s->irq, !!(s->quad[0].ctrl & CNN_CTRL_IRQ));
+}
+
+static uint32_t max78000_cnn_lreg(Max78000CnnState *s, int q, int reg,
+                                  int layer)
+{
+    return s->quad[q].lreg[reg][layer];
+}
+
+/* Host pointer to the byte lane of @proc in the first word of its SRAM */
+static uint8_t *max78000_cnn_sram_ptr(Max78000CnnState *s, int proc)
+{
+    Max78000CnnQuadrant *q = &s->quad[proc / CNN_PROCS_PER_QUAD];
+    int p = proc % CNN_PROCS_PER_QUAD;
+    uint8_t *base = memory_region_get_ram_ptr(&q->sram);
+
+    return base + (p / 4) * CNN_SRAM_INST_SIZE + (p % 4);
+}
+
+/*
+ * Kernels occupy 16 bytes of MRAM each; the 9 weights are packed into
+ * the low byte of the first word followed by the next two words,
+ * most significant byte first.
+ */
+static void max78000_cnn_load_kernel(Max78000CnnState *s, int proc,
+                                     uint32_t index, int8_t *kernel)
+{
+    Max78000CnnQuadrant *q = &s->quad[proc / CNN_PROCS_PER_QUAD];
+    uint8_t *slot = memory_region_get_ram_ptr(&q->mram);
+    uint32_t w1, w2;
+
+    slot += (proc % CNN_PROCS_PER_QUAD) * CNN_MRAM_PROC_SIZE;
+    slot += (index % CNN_KERNELS_PER_PROC) * 16;
+
+    w1 = ldl_le_p(slot + 4);
+    w2 = ldl_le_p(slot + 8);
+    kernel[0] = slot[0];
+    kernel[1] = w1 >> 24;
+    kernel[2] = w1 >> 16;
+    kernel[3] = w1 >> 8;
+    kernel[4] = w1;
+    kernel[5] = w2 >> 24;
+    kernel[6] = w2 >> 16;
+    kernel[7] = w2 >> 8;
+    kernel[8] = w2;
+}
+
+static int8_t max78000_cnn_load_bias(Max78000CnnState *s, int quad,
+                                     uint32_t index)
+{
+    uint8_t *bias = memory_region_get_ram_ptr(&s->quad[quad].bias);
+
+    return bias[(index * 4) % CNN_BIAS_SIZE];
+}
+
+static bool max78000_cnn_decode_layer(Max78000CnnState *s, int l,
+                                      Max78000CnnLayer *layer)
+{
+    uint32_t rcnt = max78000_cnn_lreg(s, 0, CNN_LREG_RCNT, l);
+    uint32_t ccnt = max78000_cnn_lreg(s, 0, CNN_LREG_CCNT, l);
+    uint32_t oned = max78000_cnn_lreg(s, 0, CNN_LREG_ONED, l);
+    uint32_t lctrl0 = max78000_cnn_lreg(s, 0, CNN_LREG_LCTRL0, l);
+    uint32_t mcnt = max78000_cnn_lreg(s, 0, CNN_LREG_MCNT, l);
+    uint32_t mend;
+    bool kernels = false;
+    int q, p;
+
+    memset(layer, 0, sizeof(*layer));
+
+    layer->pad_rows = (rcnt >> CNN_CNT_PAD_SHIFT) & CNN_CNT_PAD_MASK;
+    layer->pad_cols = (ccnt >> CNN_CNT_PAD_SHIFT) & CNN_CNT_PAD_MASK;
+    layer->in_rows = (rcnt & CNN_CNT_MASK) + 1 - 2 * layer->pad_rows;
+    layer->in_cols = (ccnt & CNN_CNT_MASK) + 1 - 2 * layer->pad_cols;
+
+    if (lctrl0 & CNN_LCTRL0_POOL_EN) {
+        layer->pool_rows = (max78000_cnn_lreg(s, 0, CNN_LREG_PRCNT, l)
+                            & 0xf) + 1;
+        layer->pool_cols = (max78000_cnn_lreg(s, 0, CNN_LREG_PCCNT, l)
+                            & 0xf) + 1;
+        layer->pool_stride = (max78000_cnn_lreg(s, 0, CNN_LREG_STRIDE, l)
+                              & 0x3) + 1;
+        layer->max_pool = lctrl0 & CNN_LCTRL0_MAXPL_EN;
+    } else {
+        layer->pool_rows = 1;
+        layer->pool_cols = 1;
+        layer->pool_stride = 1;
+    }
+
+    if (layer->in_rows < layer->pool_rows ||
+        layer->in_cols < layer->pool_cols) {
+        qemu_log_mask(LOG_GUEST_ERROR,
+                      "%s: layer %d has invalid dimensions %dx%d\n",
+                      __func__, l, layer->in_rows, layer->in_cols);
+        return false;
+    }
+
+    layer->rows = (layer->in_rows - layer->pool_rows) /
+                  layer->pool_stride + 1;
+    layer->cols = (layer->in_cols - layer->pool_cols) /
+                  layer->pool_stride + 1;
+
+    if (oned & CNN_ONED_EN) {
+        layer->k_rows = 1;
+        layer->k_cols = (oned & CNN_ONED_KSIZE_MASK) + 1;
+        if (layer->k_cols > CNN_KERNEL_BYTES) {
+            layer->k_cols = CNN_KERNEL_BYTES;
+        }
+    } else if (oned & CNN_ONED_K1X1) {
+        layer->k_rows = 1;
+        layer->k_cols = 1;
+    } else {
+        layer->k_rows = 3;
+        layer->k_cols = 3;
+    }
+
+    for (q = 0; q < CNN_NUM_QUADRANTS; q++) {
+        uint32_t en = max78000_cnn_lreg(s, q, CNN_LREG_EN, l);
+
+        for (p = 0; p < CNN_PROCS_PER_QUAD; p++) {
+            if (en & (1 << p)) {
+                layer->in_proc[layer->n_in++] = q * CNN_PROCS_PER_QUAD + p;
+            }
+        }
+        kernels |= (en >> 16) != 0;
+
+        if (layer->post == 0 &&
+            (max78000_cnn_lreg(s, q, CNN_LREG_POST, l) & CNN_POST_BIAS_EN)) {
+            layer->post = max78000_cnn_lreg(s, q, CNN_LREG_POST, l);
+            layer->bias_quad = q;
+        }
+    }
+    if (layer->post == 0) {
+        layer->post = max78000_cnn_lreg(s, 0, CNN_LREG_POST, l);
+    }
+
+    if (layer->n_in == 0) {
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: layer %d has no processors\n",
+                      __func__, l);
+        return false;
+    }
+
+    layer->passthrough = !kernels;
+    if (layer->passthrough) {
+        layer->k_rows = 1;
+        layer->k_cols = 1;
+        layer->n_out = layer->n_in;
+    } else {
+        layer->mstart = (mcnt >> CNN_MCNT_START_SHIFT) & CNN_MCNT_START_MASK;
+        mend = mcnt & CNN_MCNT_END_MASK;
+        if (mend < layer->mstart) {
+            qemu_log_mask(LOG_GUEST_ERROR,
+                          "%s: layer %d mask end precedes mask start\n",
+                          __func__, l);
+            return false;
+        }
+        layer->n_out = mend - layer->mstart + 1;
+    }
+
+    layer->out_rows = layer->rows + 2 * layer->pad_rows - layer->k_rows + 1;
+    layer->out_cols = layer->cols + 2 * layer->pad_cols - layer->k_cols + 1;
+    if (layer->out_rows <= 0 || layer->out_cols <= 0) {
+        qemu_log_mask(LOG_GUEST_ERROR,
+                      "%s: layer %d kernel larger than its input\n",
+                      __func__, l);
+        return false;
+    }
+
+    layer->rptr = max78000_cnn_lreg(s, 0, CNN_LREG_RPTR_BASE, l) &
+                  CNN_PTR_MASK;
+    layer->wptr = max78000_cnn_lreg(s, 0, CNN_LREG_WPTR_BASE, l) &
+                  CNN_PTR_MASK;
+    layer->choff = max78000_cnn_lreg(s, 0, CNN_LREG_WPTR_CHOFF, l) &
+                   CNN_PTR_MASK;
+    return true;
+}
+
+/*
+ * Gather one input channel from SRAM, pool it, and store it in the
+ * middle of a zeroed plane sized for the layer's padding.
+ */
+static void max78000_cnn_load_channel(Max78000CnnState *s,
+                                      const Max78000CnnLayer *layer,
+                                      int proc, int8_t *raw, int8_t *plane)
+{
+    const uint8_t *src = max78000_cnn_sram_ptr(s, proc);
+    int plane_cols = layer->cols + 2 * layer->pad_cols;
+    int n = layer->in_rows * layer->in_cols;
+    int y, x, py, px, i;
+
+    for (i = 0; i < n; i++) {
+        raw[i] = src[((layer->rptr + i) & CNN_PTR_MASK) * 4];
+    }
+
+    for (y = 0; y < layer->rows; y++) {
+        int8_t *dst = plane + (y + layer->pad_rows) * plane_cols +
+                      layer->pad_cols;
+
+        for (x = 0; x < layer->cols; x++) {
+            const int8_t *win = raw + y * layer->pool_stride * layer->in_cols +
+                                x * layer->pool_stride;
+            int val = layer->max_pool ? INT8_MIN : 0;
+
+            for (py = 0; py < layer->pool_rows; py++) {
+                for (px = 0; px < layer->pool_cols; px++) {
+                    int v = win[py * layer->in_cols + px];
+                    if (layer->max_pool) {
+                        val = MAX(val, v);
+                    } else {
+                        val += v;
+                    }
+                }
+            }
+            if (!layer->max_pool) {
+                val /= layer->pool_rows * layer->pool_cols;
+            }
+            dst[x] = val;
+        }
+    }
+}
+
+/* acc[i] += w * in[i]; kept trivial so the compiler vectorizes it */
+static void max78000_cnn_mac(int32_t *restrict acc,
+                             const int8_t *restrict in, int32_t w, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++) {
+        acc[i] += w * in[i];
+    }
+}
+
+static int8_t max78000_cnn_postprocess(int64_t acc, uint32_t post)
+{
+    int scale = (post >> CNN_POST_SCALE_SHIFT) & CNN_POST_SCALE_MASK;
+
+    if (post & CNN_POST_SCALE_LEFT) {
+        acc <<= scale;
+    } else {
+        acc >>= scale;
+    }
+    /* Weights are Q7 fixed point */
+    acc >>= 7;
+    acc = MIN(MAX(acc, INT8_MIN), INT8_MAX);
+
+    switch ((post >> CNN_POST_ACT_SHIFT) & CNN_POST_ACT_MASK) {
+    case CNN_ACT_RELU:
+        acc = MAX(acc, 0);
+        break;
+    case CNN_ACT_ABS:
+        acc = MIN(ABS(acc), INT8_MAX);
+        break;
+    }
+    return acc;
+}
+
+static void max78000_cnn_run_layer(Max78000CnnState *s, int l)
+{
+    Max78000CnnLayer layer;
+    int plane_rows, plane_cols, plane_size, out_size;
+    int8_t *raw, *planes, *weights;
+    int32_t *acc;
+    int c, o, ky, kx, y, i;
+
+    if (!max78000_cnn_decode_layer(s, l, &layer)) {
+        return;
+    }
+
+    plane_rows = layer.rows + 2 * layer.pad_rows;
+    plane_cols = layer.cols + 2 * layer.pad_cols;
+    plane_size = plane_rows * plane_cols;
+    out_size = layer.out_rows * layer.out_cols;
+
+    raw = g_new(int8_t, layer.in_rows * layer.in_cols);
+    planes = g_new0(int8_t, layer.n_in * plane_size);
+    acc = g_new(int32_t, out_size);
+    weights = NULL;
+
+    for (c = 0; c < layer.n_in; c++) {
+        max78000_cnn_load_channel(s, &layer, layer.in_proc[c], raw,
+                                  planes + c * plane_size);
+    }
+
+    if (!layer.passthrough) {
+        weights = g_new(int8_t, layer.n_out * layer.n_in * CNN_KERNEL_BYTES);
+        for (o = 0; o < layer.n_out; o++) {
+            for (c = 0; c < layer.n_in; c++) {
+                max78000_cnn_load_kernel(s, layer.in_proc[c],
+                        layer.mstart + o,
+                        weights + (o * layer.n_in + c) * CNN_KERNEL_BYTES);
+            }
+        }
+    }
+
+    for (o = 0; o < layer.n_out; o++) {
+        uint8_t *dst = max78000_cnn_sram_ptr(s, o % CNN_NUM_PROCS);
+        uint32_t wptr = layer.wptr + (o / CNN_NUM_PROCS) * layer.choff;
+
+        if (layer.passthrough) {
+            const int8_t *in = planes + o * plane_size;
+
+            /* Output is the padded plane itself, as for a 1x1 kernel */
+            for (i = 0; i < out_size; i++) {
+                acc[i] = in[i] * 128;
+            }
+        } else {
+            int32_t bias = 0;
+
+            if (layer.post & CNN_POST_BIAS_EN) {
+                bias = max78000_cnn_load_bias(s, layer.bias_quad,
+                        (layer.post & CNN_POST_BPTR_MASK) + o) * 128;
+            }
+            for (i = 0; i < out_size; i++) {
+                acc[i] = bias;
+            }
+
+            for (c = 0; c < layer.n_in; c++) {
+                const int8_t *in = planes + c * plane_size;
+                const int8_t *k = weights +
+                                  (o * layer.n_in + c) * CNN_KERNEL_BYTES;
+
+                for (ky = 0; ky < layer.k_rows; ky++) {
+                    for (kx = 0; kx < layer.k_cols; kx++) {
+                        int32_t w = k[ky * layer.k_cols + kx];
+
+                        if (w == 0) {
+                            continue;
+                        }
+                        for (y = 0; y < layer.out_rows; y++) {
+                            max78000_cnn_mac(acc + y * layer.out_cols,
+                                             in + (y + ky) * plane_cols + kx,
+                                             w, layer.out_cols);
+                        }
+                    }
+                }
+            }
+        }
+
+        for (i = 0; i < out_size; i++) {
+            dst[((wptr + i) & CNN_PTR_MASK) * 4] =
+                max78000_cnn_postprocess(acc[i], layer.post);
+        }
+    }
+
+    g_free(raw);
+    g_free(planes);
+    g_free(acc);
+    g_free(weights);
+}
+
+static void max78000_cnn_run(Max78000CnnState *s)
+{
+    int last = s->quad[0].lcnt_max & (CNN_MAX_LAYERS - 1);
+    int l, q;
+
+    for (l = 0; l <= last; l++) {
+        max78000_cnn_run_layer(s, l);
+    }
+
+    for (q = 0; q < CNN_NUM_QUADRANTS; q++) {
+        memory_region_set_dirty(&s->quad[q].sram, 0, CNN_SRAM_SIZE);
+    }
+
+    s->quad[0].ctrl |= CNN_CTRL_IRQ;
+    max78000_cnn_update_irq(s);
+}
+
+static uint64_t max78000_cnn_read(void *opaque, hwaddr addr,
+                                    unsigned int size)
+{
+    Max78000CnnQuadrant *q = opaque;
+
+    switch (addr) {
+    case CNN_CTRL:
+        return q->ctrl;
+
+    case CNN_SRAM:
+        return q->sram_ctrl;
+
+    case CNN_LCNT_MAX:
+        return q->lcnt_max;
+
+    case CNN_TEST:
+        return q->test;
+
+    case CNN_LREG_BASE ... CNN_LREG_BASE + CNN_NUM_LREGS * 0x80 - 4:
+        addr -= CNN_LREG_BASE;
+        return q->lreg[addr / 0x80][(addr % 0x80) / 4];
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        return 0;
+    }
+}
+
+static void max78000_cnn_write(void *opaque, hwaddr addr,
+                    uint64_t val64, unsigned int size)
+{
+    Max78000CnnQuadrant *q = opaque;
+    Max78000CnnState *s = q->cnn;
+    uint32_t val = val64;
+    uint32_t old;
+
+    switch (addr) {
+    case CNN_CTRL:
+        old = q->ctrl;
+        q->ctrl = val;
+        /* Starting the master quadrant runs the whole network */
+        if (q->index == 0 && (val & CNN_CTRL_EN) && !(old & CNN_CTRL_EN)) {
+            max78000_cnn_run(s);
+        }
+        max78000_cnn_update_irq(s);
+        break;
+
+    case CNN_SRAM:
+        q->sram_ctrl = val;
+        break;
+
+    case CNN_LCNT_MAX:
+        q->lcnt_max = val;
+        break;
+
+    case CNN_TEST:
+        q->test = val;
+        break;
+
+    case CNN_LREG_BASE ... CNN_LREG_BASE + CNN_NUM_LREGS * 0x80 - 4:
+        addr -= CNN_LREG_BASE;
+        q->lreg[addr / 0x80][(addr % 0x80) / 4] = val;
+        break;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        break;
+    }
+}
+
+static void max78000_cnn_reset_hold(Object *obj, ResetType type)
+{
+    Max78000CnnState *s = MAX78000_CNN(obj);
+    int i;
+
+    for (i = 0; i < CNN_NUM_QUADRANTS; i++) {
+        Max78000CnnQuadrant *q = &s->quad[i];
+
+        q->ctrl = 0;
+        q->sram_ctrl = 0;
+        q->lcnt_max = 0;
+        q->test = 0;
+        memset(q->lreg, 0, sizeof(q->lreg));
+    }
+}
+
+static void max78000_cnn_reset_exit(Object *obj, ResetType type)
+{
+    Max78000CnnState *s = MAX78000_CNN(obj);
+
+    max78000_cnn_update_irq(s);
+}
+
+static const MemoryRegionOps max78000_cnn_ops = {
+    .read = max78000_cnn_read,
+    .write = max78000_cnn_write,
+    .endianness = DEVICE_LITTLE_ENDIAN,
+    .valid.min_access_size = 4,
+    .valid.max_access_size = 4,
+};
+
+static const VMStateDescription vmstate_max78000_cnn_quad = {
+    .name = TYPE_MAX78000_CNN "-quadrant",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(ctrl, Max78000CnnQuadrant),
+        VMSTATE_UINT32(sram_ctrl, Max78000CnnQuadrant),
+        VMSTATE_UINT32(lcnt_max, Max78000CnnQuadrant),
+        VMSTATE_UINT32(test, Max78000CnnQuadrant),
+        VMSTATE_UINT32_2DARRAY(lreg, Max78000CnnQuadrant,
+                               CNN_NUM_LREGS, CNN_MAX_LAYERS),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static const VMStateDescription vmstate_max78000_cnn = {
+    .name = TYPE_MAX78000_CNN,
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_STRUCT_ARRAY(quad, Max78000CnnState, CNN_NUM_QUADRANTS, 1,
+                             vmstate_max78000_cnn_quad, Max78000CnnQuadrant),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static void max78000_cnn_init(Object *obj)
+{
+    Max78000CnnState *s = MAX78000_CNN(obj);
+    int i;
+
+    sysbus_init_irq(SYS_BUS_DEVICE(obj), &s->irq);
+
+    for (i = 0; i < CNN_NUM_QUADRANTS; i++) {
+        Max78000CnnQuadrant *q = &s->quad[i];
+        g_autofree char *name = g_strdup_printf("max78000-cnn.quad%d", i);
+
+        q->cnn = s;
+        q->index = i;
+
+        memory_region_init(&q->container, obj, name, CNN_QUAD_SIZE);
+        memory_region_init_io(&q->regs, obj, &max78000_cnn_ops, q,
+                              TYPE_MAX78000_CNN, CNN_REGS_SIZE);
+        memory_region_add_subregion(&q->container, 0, &q->regs);
+        sysbus_init_mmio(SYS_BUS_DEVICE(obj), &q->container);
+    }
+}
+
+static void max78000_cnn_realize(DeviceState *dev, Error **errp)
+{
+    Max78000CnnState *s = MAX78000_CNN(dev);
+    int i;
+
+    for (i = 0; i < CNN_NUM_QUADRANTS; i++) {
+        Max78000CnnQuadrant *q = &s->quad[i];
+        g_autofree char *bias = g_strdup_printf("max78000-cnn.bias%d", i);
+        g_autofree char *mram = g_strdup_printf("max78000-cnn.mram%d", i);
+        g_autofree char *sram = g_strdup_printf("max78000-cnn.sram%d", i);
+
+        if (!memory_region_init_ram(&q->bias, OBJECT(dev), bias,
+                                    CNN_BIAS_SIZE, errp) ||
+            !memory_region_init_ram(&q->mram, OBJECT(dev), mram,
+                                    CNN_MRAM_SIZE, errp) ||
+            !memory_region_init_ram(&q->sram, OBJECT(dev), sram,
+                                    CNN_SRAM_SIZE, errp)) {
+            return;
+        }
+        memory_region_add_subregion(&q->container, CNN_BIAS_OFFSET, &q->bias);
+        memory_region_add_subregion(&q->container, CNN_MRAM_OFFSET, &q->mram);
+        memory_region_add_subregion(&q->container, CNN_SRAM_OFFSET, &q->sram);
+    }
+}
+
+static void max78000_cnn_class_init(ObjectClass *klass, const void *data)
+{
+    ResettableClass *rc = RESETTABLE_CLASS(klass);
+    DeviceClass *dc = DEVICE_CLASS(klass);
+
+    rc->phases.hold = max78000_cnn_reset_hold;
+    rc->phases.exit = max78000_cnn_reset_exit;
+    dc->realize = max78000_cnn_realize;
+    dc->vmsd = &vmstate_max78000_cnn;
+}
+
+static const TypeInfo max78000_cnn_info = {
+    .name          = TYPE_MAX78000_CNN,
+    .parent        = TYPE_SYS_BUS_DEVICE,
+    .instance_size = sizeof(Max78000CnnState),
+    .instance_init = max78000_cnn_init,
+    .class_init    = max78000_cnn_class_init,
+};
+
+static void max78000_cnn_register_types(void)
+{
+    type_register_static(&max78000_cnn_info);
+}
+
+type_init(max78000_cnn_register_types)
@@ -0,0 +1,269 @@
+/*
+ * MAX78000 CRC
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * A 32 bit CRC engine with a programmable polynomial. Data written to
+ * DATAIN, by the CPU or by DMA, is folded into VAL one byte at a time,
+ * least significant bit first unless CTRL.MSB is set; VAL holds the raw
+ * shift register, without any final inversion. The common reflected
+ * CRC-32 and CRC-32C polynomials are handed to zlib's crc32() (which
+ * uses the host's carry-less multiply or CRC instructions when zlib is
+ * built with them) and util/crc32c.c; any other polynomial goes through
+ * a table built when POLY or the bit order changes.
+ */
+
+#include "qemu/osdep.h"
+#include <zlib.h>
+#include "qemu/log.h"
+#include "qemu/bswap.h"
+#include "qemu/crc32c.h"
+#include "qapi/error.h"
+#include "trace.h"
+#include "hw/irq.h"
+#include "hw/qdev-clock.h"
+#include "migration/vmstate.h"
+#include "hw/misc/max78000_crc.h"
+
+static void max78000_crc_build_table(Max78000CrcState *s)
+{
+    bool msb = s->ctrl & CRC_CTRL_MSB;
+    uint32_t crc;
+    int i, bit;
+
+    for (i = 0; i < 256; i++) {
+        if (msb) {
+            crc = (uint32_t)i << 24;
+            for (bit = 0; bit < 8; bit++) {
+                crc = (crc << 1) ^ ((crc & 0x80000000) ? s->poly : 0);
+            }
+        } else {
+            crc = i;
+            for (bit = 0; bit < 8; bit++) {
+                crc = (crc >> 1) ^ ((crc & 1) ? s->poly : 0);
+            }
+        }
+        s->table[i] = crc;
+    }
+}
+
+static uint32_t max78000_crc_compute(Max78000CrcState *s, uint32_t crc,
+                                     const uint8_t *buf, size_t len)
+{
+    size_t i;
+
+    if (s->ctrl & CRC_CTRL_MSB) {
+        for (i = 0; i < len; i++) {
+            crc = s->table[(crc >> 24) ^ buf[i]] ^ (crc << 8);
+        }
+        return crc;
+    }
+
+    switch (s->poly) {
+    case CRC_POLY_CRC32:
+        /* zlib inverts the CRC on the way in and out */
+        return ~crc32(crc ^ 0xffffffff, buf, len);
+    case CRC_POLY_CRC32C:
+        /* crc32c() only inverts on the way out */
+        return ~crc32c(crc, buf, len);
+    default:
+        for (i = 0; i < len; i++) {
+            crc = s->table[(crc ^ buf[i]) & 0xff] ^ (crc >> 8);
+        }
+        return crc;
+    }
+}
+
+static void max78000_crc_update_dma(Max78000CrcState *s)
+{
+    /* The engine keeps up with any DMA rate, so it always requests */
+    qemu_set_irq(s->dma_req, clock_is_enabled(s->clk) &&
+                 (s->ctrl & (CRC_CTRL_EN | CRC_CTRL_DMA_EN)) ==
+                 (CRC_CTRL_EN | CRC_CTRL_DMA_EN));
+}
+
+static uint64_t max78000_crc_read(void *opaque, hwaddr addr,
+                                  unsigned int size)
+{
+    Max78000CrcState *s = opaque;
+
+    switch (addr) {
+    case CRC_CTRL:
+        return s->ctrl;
+
+    case CRC_DATAIN ... CRC_DATAIN + 3:
+        return 0;
+
+    case CRC_POLY:
+        return s->poly;
+
+    case CRC_VAL:
+        return (s->ctrl & CRC_CTRL_BYTE_SWAP_OUT) ? bswap32(s->val) : s->val;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        return 0;
+    }
+}
+
+static void max78000_crc_write(void *opaque, hwaddr addr,
+                               uint64_t val64, unsigned int size)
+{
+    Max78000CrcState *s = opaque;
+    uint32_t val = val64;
+    uint8_t buf[4];
+
+    switch (addr) {
+    case CRC_CTRL:
+        if ((s->ctrl ^ val) & CRC_CTRL_MSB) {
+            s->ctrl = val & ~CRC_CTRL_BUSY;
+            max78000_crc_build_table(s);
+        } else {
+            s->ctrl = val & ~CRC_CTRL_BUSY;
+        }
+        break;
+
+    case CRC_DATAIN ... CRC_DATAIN + 3:
+        if (!(s->ctrl & CRC_CTRL_EN) || !clock_is_enabled(s->clk)) {
+            break;
+        }
+        if (s->ctrl & CRC_CTRL_BYTE_SWAP_IN) {
+            stn_be_p(buf, size, val);
+        } else {
+            stn_le_p(buf, size, val);
+        }
+        s->val = max78000_crc_compute(s, s->val, buf, size);
+        break;
+
+    case CRC_POLY:
+        s->poly = val;
+        max78000_crc_build_table(s);
+        break;
+
+    case CRC_VAL:
+        s->val = val;
+        break;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        return;
+    }
+
+    max78000_crc_update_dma(s);
+}
+
+static void max78000_crc_clk_update(void *opaque, ClockEvent event)
+{
+    Max78000CrcState *s = opaque;
+
+    max78000_crc_update_dma(s);
+}
+
+static void max78000_crc_reset_hold(Object *obj, ResetType type)
+{
+    Max78000CrcState *s = MAX78000_CRC(obj);
+
+    s->ctrl = 0;
+    s->poly = CRC_POLY_CRC32;
+    s->val = 0xffffffff;
+    max78000_crc_build_table(s);
+}
+
+static void max78000_crc_reset_exit(Object *obj, ResetType type)
+{
+    Max78000CrcState *s = MAX78000_CRC(obj);
+
+    max78000_crc_update_dma(s);
+}
+
+static int max78000_crc_post_load(void *opaque, int version_id)
+{
+    Max78000CrcState *s = opaque;
+
+    max78000_crc_build_table(s);
+    return 0;
+}
+
+/* DATAIN takes byte, halfword and word writes; the rest are word */
+static bool max78000_crc_accepts(void *opaque, hwaddr addr, unsigned size,
+                                 bool is_write, MemTxAttrs attrs)
+{
+    return size == 4 || (addr >= CRC_DATAIN && addr < CRC_DATAIN + 4);
+}
+
+static const MemoryRegionOps max78000_crc_ops = {
+    .read = max78000_crc_read,
+    .write = max78000_crc_write,
+    .endianness = DEVICE_LITTLE_ENDIAN,
+    .valid.min_access_size = 1,
+    .valid.max_access_size = 4,
+    .valid.accepts = max78000_crc_accepts,
+};
+
+static const VMStateDescription vmstate_max78000_crc = {
+    .name = TYPE_MAX78000_CRC,
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .post_load = max78000_crc_post_load,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(ctrl, Max78000CrcState),
+        VMSTATE_UINT32(poly, Max78000CrcState),
+        VMSTATE_UINT32(val, Max78000CrcState),
+        VMSTATE_CLOCK(clk, Max78000CrcState),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static void max78000_crc_init(Object *obj)
+{
+    Max78000CrcState *s = MAX78000_CRC(obj);
+
+    qdev_init_gpio_out_named(DEVICE(obj), &s->dma_req, "dma-tx", 1);
+
+    s->clk = qdev_init_clock_in(DEVICE(obj), "clk", max78000_crc_clk_update,
+                                s, ClockUpdate);
+
+    memory_region_init_io(&s->mmio, obj, &max78000_crc_ops, s,
+                          TYPE_MAX78000_CRC, 0x1000);
+    sysbus_init_mmio(SYS_BUS_DEVICE(obj), &s->mmio);
+}
+
+static void max78000_crc_realize(DeviceState *dev, Error **errp)
+{
+    Max78000CrcState *s = MAX78000_CRC(dev);
+
+    if (!clock_has_source(s->clk)) {
+        error_setg(errp, "MAX78000 CRC: clk must be connected");
+        return;
+    }
+}
+
+static void max78000_crc_class_init(ObjectClass *klass, const void *data)
+{
+    ResettableClass *rc = RESETTABLE_CLASS(klass);
+    DeviceClass *dc = DEVICE_CLASS(klass);
+
+    rc->phases.hold = max78000_crc_reset_hold;
+    rc->phases.exit = max78000_crc_reset_exit;
+    dc->realize = max78000_crc_realize;
+    dc->vmsd = &vmstate_max78000_crc;
+}
+
+static const TypeInfo max78000_crc_info = {
+    .name          = TYPE_MAX78000_CRC,
+    .parent        = TYPE_SYS_BUS_DEVICE,
+    .instance_size = sizeof(Max78000CrcState),
+    .instance_init = max78000_crc_init,
+    .class_init    = max78000_crc_class_init,
+};
+
+static void max78000_crc_register_types(void)
+{
+    type_register_static(&max78000_crc_info);
+}
+
+type_init(max78000_crc_register_types)
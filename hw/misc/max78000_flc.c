@@ -0,0 +1,314 @@
+/*
+ * MAX78000 Flash Controller
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Programs 128 bit words and erases pages or the whole of the internal
+ * flash. Every operation completes immediately. The flash array itself
+ * is owned by the SoC and is read-only to the CPU; the controller writes
+ * it with address_space_write_rom(), which also invalidates any code
+ * translated from the modified range. If a block backend is attached,
+ * it is loaded into the array at realize and every change is written
+ * through to it.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/log.h"
+#include "qemu/error-report.h"
+#include "qapi/error.h"
+#include "trace.h"
+#include "hw/irq.h"
+#include "hw/block/block.h"
+#include "hw/qdev-properties.h"
+#include "hw/qdev-properties-system.h"
+#include "migration/vmstate.h"
+#include "hw/misc/max78000_flc.h"
+
+static void max78000_flc_update_irq(Max78000FlcState *s)
+{
+    bool level = ((s->intr & FLC_INTR_DONE) && (s->intr & FLC_INTR_DONEIE)) ||
+                 ((s->intr & FLC_INTR_AF) && (s->intr & FLC_INTR_AFIE));
+
+    qemu_set_irq(s->irq, level);
+}
+
+/* Store a range of the array and write it through to the backend */
+static void max78000_flc_store(Max78000FlcState *s, hwaddr offset,
+                               const void *buf, hwaddr len)
+{
+    uint8_t *storage = memory_region_get_ram_ptr(s->flash);
+    int ret;
+
+    address_space_write_rom(&s->flash_as, offset, MEMTXATTRS_UNSPECIFIED,
+                            buf, len);
+    if (!s->blk || s->ro) {
+        return;
+    }
+    ret = blk_pwrite(s->blk, offset, len, storage + offset, 0);
+    if (ret < 0) {
+        error_report("Could not update MAX78000 flash: %s", strerror(-ret));
+    }
+}
+
+static void max78000_flc_write128(Max78000FlcState *s, hwaddr offset)
+{
+    uint8_t buf[FLC_WRITE_SIZE];
+    int i;
+
+    /* Programming can only clear bits */
+    address_space_read(&s->flash_as, offset, MEMTXATTRS_UNSPECIFIED,
+                       buf, sizeof(buf));
+    for (i = 0; i < FLC_WRITE_SIZE; i++) {
+        buf[i] &= s->data[i / 4] >> ((i % 4) * 8);
+    }
+    max78000_flc_store(s, offset, buf, sizeof(buf));
+}
+
+static void max78000_flc_erase(Max78000FlcState *s, hwaddr offset,
+                               hwaddr len)
+{
+    g_autofree uint8_t *buf = g_malloc(len);
+
+    memset(buf, 0xff, len);
+    max78000_flc_store(s, offset, buf, len);
+}
+
+static void max78000_flc_command(Max78000FlcState *s)
+{
+    uint32_t size = memory_region_size(s->flash);
+    uint32_t unlock = (s->ctrl >> FLC_CTRL_UNLOCK_SHIFT) &
+                      FLC_CTRL_UNLOCK_MASK;
+    uint32_t code = (s->ctrl >> FLC_CTRL_ERASE_CODE_SHIFT) &
+                    FLC_CTRL_ERASE_CODE_MASK;
+    /* Both the flash offset and its address in the memory map work */
+    hwaddr offset = s->addr & (size - 1);
+    uint32_t cmd = s->ctrl & (FLC_CTRL_WR | FLC_CTRL_ME | FLC_CTRL_PGE);
+
+    s->ctrl &= ~cmd;
+
+    if (unlock != FLC_UNLOCK_KEY || s->ro ||
+        ((cmd & FLC_CTRL_ME) && code != FLC_ERASE_CODE_MASS) ||
+        ((cmd & FLC_CTRL_PGE) && code != FLC_ERASE_CODE_PAGE)) {
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: flash operation rejected\n",
+                      __func__);
+        s->intr |= FLC_INTR_AF;
+        return;
+    }
+
+    if (cmd & FLC_CTRL_ME) {
+        max78000_flc_erase(s, 0, size);
+    } else if (cmd & FLC_CTRL_PGE) {
+        max78000_flc_erase(s, QEMU_ALIGN_DOWN(offset, FLC_PAGE_SIZE),
+                           FLC_PAGE_SIZE);
+    } else {
+        max78000_flc_write128(s, QEMU_ALIGN_DOWN(offset, FLC_WRITE_SIZE));
+    }
+    s->intr |= FLC_INTR_DONE;
+}
+
+static uint64_t max78000_flc_read(void *opaque, hwaddr addr,
+                                  unsigned int size)
+{
+    Max78000FlcState *s = opaque;
+
+    switch (addr) {
+    case FLC_ADDR:
+        return s->addr;
+
+    case FLC_CLKDIV:
+        return s->clkdiv;
+
+    case FLC_CTRL:
+        return s->ctrl;
+
+    case FLC_INTR:
+        return s->intr;
+
+    case FLC_ECCDATA:
+        return s->eccdata;
+
+    case FLC_DATA0:
+    case FLC_DATA1:
+    case FLC_DATA2:
+    case FLC_DATA3:
+        return s->data[(addr - FLC_DATA0) / 4];
+
+    case FLC_ACTNL:
+        return s->actnl;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        return 0;
+    }
+}
+
+static void max78000_flc_write(void *opaque, hwaddr addr,
+                               uint64_t val64, unsigned int size)
+{
+    Max78000FlcState *s = opaque;
+    uint32_t val = val64;
+
+    switch (addr) {
+    case FLC_ADDR:
+        s->addr = val;
+        break;
+
+    case FLC_CLKDIV:
+        s->clkdiv = val;
+        break;
+
+    case FLC_CTRL:
+        s->ctrl = val & ~(FLC_CTRL_PEND | FLC_CTRL_LVE);
+        if (val & (FLC_CTRL_WR | FLC_CTRL_ME | FLC_CTRL_PGE)) {
+            max78000_flc_command(s);
+        }
+        break;
+
+    case FLC_INTR:
+        /* DONE and AF are cleared by writing 0 */
+        s->intr = (s->intr & val & (FLC_INTR_DONE | FLC_INTR_AF)) |
+                  (val & (FLC_INTR_DONEIE | FLC_INTR_AFIE));
+        break;
+
+    case FLC_ECCDATA:
+        s->eccdata = val;
+        break;
+
+    case FLC_DATA0:
+    case FLC_DATA1:
+    case FLC_DATA2:
+    case FLC_DATA3:
+        s->data[(addr - FLC_DATA0) / 4] = val;
+        break;
+
+    case FLC_ACTNL:
+        s->actnl = val;
+        break;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        return;
+    }
+
+    max78000_flc_update_irq(s);
+}
+
+static void max78000_flc_reset_hold(Object *obj, ResetType type)
+{
+    Max78000FlcState *s = MAX78000_FLC(obj);
+
+    s->addr = 0;
+    s->clkdiv = 0x64;
+    s->ctrl = 0;
+    s->intr = 0;
+    s->eccdata = 0;
+    memset(s->data, 0, sizeof(s->data));
+    s->actnl = 0;
+}
+
+static void max78000_flc_reset_exit(Object *obj, ResetType type)
+{
+    Max78000FlcState *s = MAX78000_FLC(obj);
+
+    max78000_flc_update_irq(s);
+}
+
+static const MemoryRegionOps max78000_flc_ops = {
+    .read = max78000_flc_read,
+    .write = max78000_flc_write,
+    .endianness = DEVICE_LITTLE_ENDIAN,
+    .valid.min_access_size = 4,
+    .valid.max_access_size = 4,
+};
+
+static const VMStateDescription vmstate_max78000_flc = {
+    .name = TYPE_MAX78000_FLC,
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(addr, Max78000FlcState),
+        VMSTATE_UINT32(clkdiv, Max78000FlcState),
+        VMSTATE_UINT32(ctrl, Max78000FlcState),
+        VMSTATE_UINT32(intr, Max78000FlcState),
+        VMSTATE_UINT32(eccdata, Max78000FlcState),
+        VMSTATE_UINT32_ARRAY(data, Max78000FlcState, 4),
+        VMSTATE_UINT32(actnl, Max78000FlcState),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static const Property max78000_flc_properties[] = {
+    DEFINE_PROP_LINK("flash", Max78000FlcState, flash,
+                     TYPE_MEMORY_REGION, MemoryRegion*),
+    DEFINE_PROP_DRIVE("drive", Max78000FlcState, blk),
+};
+
+static void max78000_flc_init(Object *obj)
+{
+    Max78000FlcState *s = MAX78000_FLC(obj);
+
+    sysbus_init_irq(SYS_BUS_DEVICE(obj), &s->irq);
+
+    memory_region_init_io(&s->mmio, obj, &max78000_flc_ops, s,
+                          TYPE_MAX78000_FLC, 0x400);
+    sysbus_init_mmio(SYS_BUS_DEVICE(obj), &s->mmio);
+}
+
+static void max78000_flc_realize(DeviceState *dev, Error **errp)
+{
+    Max78000FlcState *s = MAX78000_FLC(dev);
+
+    if (!s->flash) {
+        error_setg(errp, "MAX78000 FLC: flash must be connected");
+        return;
+    }
+
+    address_space_init(&s->flash_as, s->flash, "max78000-flash");
+
+    if (s->blk) {
+        uint64_t perm;
+
+        s->ro = !blk_supports_write_perm(s->blk);
+        perm = BLK_PERM_CONSISTENT_READ | (s->ro ? 0 : BLK_PERM_WRITE);
+        if (blk_set_perm(s->blk, perm, BLK_PERM_ALL, errp) < 0) {
+            return;
+        }
+        if (!blk_check_size_and_read_all(s->blk, dev,
+                                         memory_region_get_ram_ptr(s->flash),
+                                         memory_region_size(s->flash),
+                                         errp)) {
+            return;
+        }
+    }
+}
+
+static void max78000_flc_class_init(ObjectClass *klass, const void *data)
+{
+    ResettableClass *rc = RESETTABLE_CLASS(klass);
+    DeviceClass *dc = DEVICE_CLASS(klass);
+
+    rc->phases.hold = max78000_flc_reset_hold;
+    rc->phases.exit = max78000_flc_reset_exit;
+    dc->realize = max78000_flc_realize;
+    dc->vmsd = &vmstate_max78000_flc;
+    device_class_set_props(dc, max78000_flc_properties);
+}
+
+static const TypeInfo max78000_flc_info = {
+    .name          = TYPE_MAX78000_FLC,
+    .parent        = TYPE_SYS_BUS_DEVICE,
+    .instance_size = sizeof(Max78000FlcState),
+    .instance_init = max78000_flc_init,
+    .class_init    = max78000_flc_class_init,
+};
+
+static void max78000_flc_register_types(void)
+{
+    type_register_static(&max78000_flc_info);
+}
+
+type_init(max78000_flc_register_types)
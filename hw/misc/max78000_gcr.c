@@ -10,14 +10,132 @@
 #include "qemu/log.h"
 #include "trace.h"
 #include "hw/irq.h"
+#include "hw/core/cpu.h"
+#include "exec/cpu-interrupt.h"
 #include "system/runstate.h"
 #include "migration/vmstate.h"
 #include "hw/qdev-properties.h"
+#include "hw/qdev-clock.h"
 #include "hw/char/max78000_uart.h"
 #include "hw/misc/max78000_trng.h"
 #include "hw/misc/max78000_aes.h"
+#include "hw/misc/max78000_cnn.h"
+#include "hw/dma/max78000_dma.h"
+#include "hw/timer/max78000_tmr.h"
+#include "hw/gpio/max78000_gpio.h"
+#include "hw/ssi/max78000_spi.h"
+#include "hw/i2c/max78000_i2c.h"
+#include "hw/misc/max78000_crc.h"
+#include "hw/misc/max78000_sema.h"
+#include "hw/audio/max78000_i2s.h"
+#include "hw/adc/max78000_adc.h"
+#include "hw/watchdog/max78000_wdt.h"
+#include "hw/rtc/max78000_rtc.h"
+#include "hw/misc/max78000_pt.h"
+#include "hw/misc/max78000_owm.h"
 #include "hw/misc/max78000_gcr.h"
 
+/*
+ * SLEEP and the Cortex-M4 deep sleep are entered with WFI, which
+ * already halts the vCPU until an interrupt arrives. The modes entered
+ * through PM.MODE halt it here instead, and an enabled wakeup source
+ * brings it back. An exception the NVIC presents to the core ends the
+ * vCPU halt regardless, so it always counts as a wakeup source too.
+ * Waking from BACKUP goes through a system reset; SRAM is not cleared
+ * by reset, which models its retention.
+ */
+static uint32_t max78000_gcr_wake_enabled(Max78000GcrState *s)
+{
+    uint32_t en = BIT(GCR_WAKE_NVIC);
+
+    if (s->pm & PM_GPIO_WE) {
+        en |= BIT(GCR_WAKE_GPIO) | BIT(GCR_WAKE_UART0) |
+              BIT(GCR_WAKE_UART1) | BIT(GCR_WAKE_UART2) |
+              BIT(GCR_WAKE_UART3);
+    }
+    if (s->pm & PM_RTC_WE) {
+        en |= BIT(GCR_WAKE_RTC);
+    }
+    if (s->pm & PM_WUT_WE) {
+        en |= BIT(GCR_WAKE_WUT);
+    }
+    return en;
+}
+
+/*
+ * Nothing but the always-on domain observes time while the SoC sleeps,
+ * so with fast-forward enabled the counters there skip ahead to just
+ * before the earliest deadline among the enabled wakeup sources. They
+ * all move by the same amount, so they stay in step with each other.
+ */
+static void max78000_gcr_fast_forward(Max78000GcrState *s)
+{
+    uint32_t en = max78000_gcr_wake_enabled(s);
+    int64_t skip = INT64_MAX;
+
+    if (en & BIT(GCR_WAKE_WUT)) {
+        skip = MIN(skip, max78000_wut_next_deadline(s->wut));
+    }
+    if (en & BIT(GCR_WAKE_RTC)) {
+        skip = MIN(skip, max78000_rtc_next_deadline(MAX78000_RTC(s->rtc)));
+    }
+    if (skip == INT64_MAX || skip <= 1) {
+        return;
+    }
+
+    max78000_wut_skip(s->wut, skip - 1);
+    max78000_rtc_skip(MAX78000_RTC(s->rtc), skip - 1);
+}
+
+static void max78000_gcr_update_power(Max78000GcrState *s)
+{
+    uint32_t mode = s->pm & PM_MODE_MASK;
+
+    if (!s->sleeping) {
+        switch (mode) {
+        case PM_MODE_STANDBY:
+        case PM_MODE_BACKUP:
+        case PM_MODE_LPM:
+        case PM_MODE_UPM:
+            break;
+        case PM_MODE_POWERDOWN:
+            /* Only a power cycle leaves POWERDOWN */
+            qemu_system_shutdown_request(SHUTDOWN_CAUSE_GUEST_SHUTDOWN);
+            return;
+        default:
+            return;
+        }
+        s->sleeping = true;
+        if (s->cpu) {
+            cpu_interrupt(s->cpu, CPU_INTERRUPT_HALT);
+        }
+    }
+
+    if (s->wake_level & max78000_gcr_wake_enabled(s)) {
+        s->sleeping = false;
+        s->pm &= ~PM_MODE_MASK;
+        if (mode == PM_MODE_BACKUP) {
+            qemu_system_reset_request(SHUTDOWN_CAUSE_GUEST_RESET);
+        } else if (s->cpu) {
+            cpu_interrupt(s->cpu, CPU_INTERRUPT_EXITTB);
+        }
+        return;
+    }
+
+    if (s->fast_forward) {
+        max78000_gcr_fast_forward(s);
+    }
+}
+
+static void max78000_gcr_wakeup(void *opaque, int n, int level)
+{
+    Max78000GcrState *s = opaque;
+
+    s->wake_level = deposit32(s->wake_level, n, 1, level != 0);
+    if (s->sleeping) {
+        max78000_gcr_update_power(s);
+    }
+}
 
 static void max78000_gcr_reset_hold(Object *obj, ResetType type)
 {
@@ -42,6 +160,70 @@ static void max78000_gcr_reset_hold(Object *obj, ResetType type)
     s->ecced = 0;
     s->eccie = 0;
     s->eccaddr = 0;
+    s->sleeping = false;
+}
+
+static const struct {
+    const char *name;
+    int bit;
+} max78000_gcr_clocks[GCR_NUM_CLK_OUT] = {
+    { "uart0-clk", GCR_CLK_UART0 },
+    { "uart1-clk", GCR_CLK_UART1 },
+    { "uart2-clk", GCR_CLK_UART2 },
+    { "trng-clk", GCR_CLK_TRNG },
+    { "aes-clk", GCR_CLK_AES },
+    { "tmr0-clk", GCR_CLK_TMR0 },
+    { "tmr1-clk", GCR_CLK_TMR1 },
+    { "tmr2-clk", GCR_CLK_TMR2 },
+    { "tmr3-clk", GCR_CLK_TMR3 },
+    { "gpio0-clk", GCR_CLK_GPIO0 },
+    { "gpio1-clk", GCR_CLK_GPIO1 },
+    { "spi0-clk", GCR_CLK_SPI0 },
+    { "spi1-clk", GCR_CLK_SPI1 },
+    { "i2c0-clk", GCR_CLK_I2C0 },
+    { "i2c1-clk", GCR_CLK_I2C1 },
+    { "i2c2-clk", GCR_CLK_I2C2 },
+    { "crc-clk", GCR_CLK_CRC },
+    { "pcif-clk", GCR_CLK_PCIF },
+    { "i2s-clk", GCR_CLK_I2S },
+    { "adc-clk", GCR_CLK_ADC },
+    { "wdt0-clk", GCR_CLK_WDT0 },
+    { "pt-clk", GCR_CLK_PT },
+    { "owm-clk", GCR_CLK_OWM },
+};
+
+/*
+ * Stopping a peripheral's clock lets the device itself go idle: it
+ * cancels its timers and stops taking input until the clock returns.
+ */
+static void max78000_gcr_update_clocks(Max78000GcrState *s)
+{
+    uint64_t dis = deposit64(s->pclkdis0, 32, 32, s->pckdis1);
+    int i;
+
+    for (i = 0; i < GCR_NUM_CLK_OUT; i++) {
+        bool gated = extract64(dis, max78000_gcr_clocks[i].bit, 1);
+        uint64_t period = clock_get(s->pclk);
+
+        if (max78000_gcr_clocks[i].bit == GCR_CLK_ADC) {
+            /* ADCFRQ values below 2 are reserved */
+            period *= MAX((s->pclkdiv >> PCLKDIV_ADCFRQ_SHIFT) &
+                          PCLKDIV_ADCFRQ_MASK, 2);
+        }
+        clock_update(s->clk_out[i], gated ? 0 : period);
+    }
+}
+
+static void max78000_gcr_pclk_update(void *opaque, ClockEvent event)
+{
+    max78000_gcr_update_clocks(opaque);
+}
+
+static void max78000_gcr_reset_exit(Object *obj, ResetType type)
+{
+    Max78000GcrState *s = MAX78000_GCR(obj);
+
+    max78000_gcr_update_clocks(s);
 }
 
 static uint64_t max78000_gcr_read(void *opaque, hwaddr addr,
@@ -104,6 +286,9 @@ static uint64_t max78000_gcr_read(void *opaque, hwaddr addr,
     case ECCADDR:
         return s->eccaddr;
 
+    case READY:
+        return 0;
+
     default:
         qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
             HWADDR_PRIx "\n", __func__, addr);
@@ -112,12 +297,70 @@ static uint64_t max78000_gcr_read(void *opaque, hwaddr addr,
     }
 }
 
+/*
+ * Zero a SYSRAM bank with a single memset on the host mapping of the
+ * RAM. Unmapping marks the range dirty for migration and display and
+ * invalidates any translated code in it, as a guest store would.
+ */
+static void max78000_gcr_zero_sram(Max78000GcrState *s, hwaddr start,
+                                   hwaddr size)
+{
+    hwaddr addr = start - SYSRAM0_START;
+
+    while (size) {
+        hwaddr len = size;
+        void *ptr = address_space_map(&s->sram_as, addr, &len, true,
+                                      MEMTXATTRS_UNSPECIFIED);
+
+        if (!ptr) {
+            qemu_log_mask(LOG_GUEST_ERROR, "%s: cannot map SYSRAM at 0x%"
+                          HWADDR_PRIx "\n", __func__, start);
+            return;
+        }
+        memset(ptr, 0, len);
+        address_space_unmap(&s->sram_as, ptr, len, true, len);
+        addr += len;
+        size -= len;
+    }
+}
+
+/* Reset the devices behind the RST1 bits set in @val */
+static void max78000_gcr_reset_rst1(Max78000GcrState *s, uint32_t val)
+{
+    if (val & SPI0_RESET) {
+        device_cold_reset(s->spi0);
+    }
+    if (val & AES_RESET) {
+        device_cold_reset(s->aes);
+    }
+    if (val & CRC_RESET) {
+        device_cold_reset(s->crc);
+    }
+    if (val & SMPHR_RESET) {
+        device_cold_reset(s->sema);
+    }
+    if (val & I2S_RESET) {
+        device_cold_reset(s->i2s);
+    }
+    if (val & I2C2_RESET) {
+        device_cold_reset(s->i2c2);
+    }
+    if (val & OWM_RESET) {
+        device_cold_reset(s->owm);
+    }
+    if (val & PT_RESET) {
+        device_cold_reset(s->pt);
+    }
+    if (val & I2C1_RESET) {
+        device_cold_reset(s->i2c1);
+    }
+}
+
 static void max78000_gcr_write(void *opaque, hwaddr addr,
                        uint64_t val64, unsigned int size)
 {
     Max78000GcrState *s = opaque;
     uint32_t val = val64;
-    uint8_t zero[0xc000] = {0};
     switch (addr) {
     case SYSCTRL:
         /* Checksum calculations always pass immediately */
@@ -128,6 +371,10 @@ static void max78000_gcr_write(void *opaque, hwaddr addr,
         if (val & SYSTEM_RESET) {
             qemu_system_reset_request(SHUTDOWN_CAUSE_GUEST_RESET);
         }
+        if (val & (PERIPHERAL_RESET | SOFT_RESET)) {
+            /* Both also reset every peripheral in RST1 */
+            max78000_gcr_reset_rst1(s, RST1_PERIPHERALS);
+        }
         if (val & PERIPHERAL_RESET) {
             /*
              * Peripheral reset resets all peripherals. The CPU
@@ -137,15 +384,15 @@ static void max78000_gcr_write(void *opaque, hwaddr addr,
              */
             val = UART2_RESET | UART1_RESET | UART0_RESET |
                     ADC_RESET | CNN_RESET | TRNG_RESET |
-                    RTC_RESET | I2C0_RESET | SPI1_RESET |
+                    I2C0_RESET | SPI1_RESET |
                     TMR3_RESET | TMR2_RESET | TMR1_RESET |
-                    TMR0_RESET | WDT0_RESET | DMA_RESET;
+                    TMR0_RESET | DMA_RESET;
         }
         if (val & SOFT_RESET) {
             /* Soft reset also resets GPIO */
             val = UART2_RESET | UART1_RESET | UART0_RESET |
                     ADC_RESET | CNN_RESET | TRNG_RESET |
-                    RTC_RESET | I2C0_RESET | SPI1_RESET |
+                    I2C0_RESET | SPI1_RESET |
                     TMR3_RESET | TMR2_RESET | TMR1_RESET |
                     TMR0_RESET | GPIO1_RESET | GPIO0_RESET |
                     DMA_RESET;
@@ -162,10 +409,45 @@ static void max78000_gcr_write(void *opaque, hwaddr addr,
         if (val & TRNG_RESET) {
             device_cold_reset(s->trng);
         }
-        if (val & AES_RESET) {
-            device_cold_reset(s->aes);
+        if (val & CNN_RESET) {
+            device_cold_reset(s->cnn);
+        }
+        if (val & DMA_RESET) {
+            device_cold_reset(s->dma);
+        }
+        if (val & SPI1_RESET) {
+            device_cold_reset(s->spi1);
+        }
+        if (val & I2C0_RESET) {
+            device_cold_reset(s->i2c0);
+        }
+        if (val & TMR3_RESET) {
+            device_cold_reset(s->tmr3);
+        }
+        if (val & TMR2_RESET) {
+            device_cold_reset(s->tmr2);
+        }
+        if (val & TMR1_RESET) {
+            device_cold_reset(s->tmr1);
+        }
+        if (val & TMR0_RESET) {
+            device_cold_reset(s->tmr0);
+        }
+        if (val & GPIO1_RESET) {
+            device_cold_reset(s->gpio1);
+        }
+        if (val & GPIO0_RESET) {
+            device_cold_reset(s->gpio0);
+        }
+        if (val & ADC_RESET) {
+            device_cold_reset(s->adc);
+        }
+        if (val & WDT0_RESET) {
+            device_cold_reset(s->wdt0);
+        }
+        if (val & RTC_RESET) {
+            device_cold_reset(s->rtc);
         }
-        /* TODO: As other devices are implemented, add them here */
         break;
 
     case CLKCTRL:
@@ -174,14 +456,17 @@ static void max78000_gcr_write(void *opaque, hwaddr addr,
 
     case PM:
         s->pm = val;
+        max78000_gcr_update_power(s);
         break;
 
     case PCLKDIV:
         s->pclkdiv = val;
+        max78000_gcr_update_clocks(s);
         break;
 
     case PCLKDIS0:
         s->pclkdis0 = val;
+        max78000_gcr_update_clocks(s);
         break;
 
     case MEMCTRL:
@@ -190,20 +475,16 @@ static void max78000_gcr_write(void *opaque, hwaddr addr,
 
     case MEMZ:
         if (val & ram0) {
-            address_space_write(&s->sram_as, SYSRAM0_START,
-                                MEMTXATTRS_UNSPECIFIED, zero, 0x8000);
+            max78000_gcr_zero_sram(s, SYSRAM0_START, 0x8000);
         }
         if (val & ram1) {
-            address_space_write(&s->sram_as, SYSRAM1_START,
-                                MEMTXATTRS_UNSPECIFIED, zero, 0x8000);
+            max78000_gcr_zero_sram(s, SYSRAM1_START, 0x8000);
         }
         if (val & ram2) {
-            address_space_write(&s->sram_as, SYSRAM2_START,
-                                MEMTXATTRS_UNSPECIFIED, zero, 0xC000);
+            max78000_gcr_zero_sram(s, SYSRAM2_START, 0xC000);
         }
         if (val & ram3) {
-            address_space_write(&s->sram_as, SYSRAM3_START,
-                                MEMTXATTRS_UNSPECIFIED, zero, 0x4000);
+            max78000_gcr_zero_sram(s, SYSRAM3_START, 0x4000);
         }
         break;
 
@@ -212,12 +493,16 @@ static void max78000_gcr_write(void *opaque, hwaddr addr,
         break;
 
     case RST1:
-        /* TODO: As other devices are implemented, add them here */
-        s->rst1 = val;
+        max78000_gcr_reset_rst1(s, val);
         break;
 
     case PCKDIS1:
+        if ((s->pckdis1 & ~val) & BIT(GCR_CLK_CPU1 - 32)) {
+            qemu_log_mask(LOG_UNIMP, "%s: the RISC-V core is not modeled "
+                          "and will not run\n", __func__);
+        }
         s->pckdis1 = val;
+        max78000_gcr_update_clocks(s);
         break;
 
     case EVENTEN:
@@ -248,6 +533,12 @@ static void max78000_gcr_write(void *opaque, hwaddr addr,
         s->eccaddr = val;
         break;
 
+    case READY:
+        if (val == GCR_READY_MAGIC) {
+            qemu_irq_pulse(s->ready_irq);
+        }
+        break;
+
     default:
         qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%" HWADDR_PRIx "\n",
                       __func__, addr);
@@ -269,6 +560,53 @@ static const Property max78000_gcr_properties[] = {
                         TYPE_MAX78000_TRNG, DeviceState*),
     DEFINE_PROP_LINK("aes", Max78000GcrState, aes,
                         TYPE_MAX78000_AES, DeviceState*),
+    DEFINE_PROP_LINK("cnn", Max78000GcrState, cnn,
+                        TYPE_MAX78000_CNN, DeviceState*),
+    DEFINE_PROP_LINK("dma", Max78000GcrState, dma,
+                        TYPE_MAX78000_DMA, DeviceState*),
+    DEFINE_PROP_LINK("tmr0", Max78000GcrState, tmr0,
+                        TYPE_MAX78000_TMR, DeviceState*),
+    DEFINE_PROP_LINK("tmr1", Max78000GcrState, tmr1,
+                        TYPE_MAX78000_TMR, DeviceState*),
+    DEFINE_PROP_LINK("tmr2", Max78000GcrState, tmr2,
+                        TYPE_MAX78000_TMR, DeviceState*),
+    DEFINE_PROP_LINK("tmr3", Max78000GcrState, tmr3,
+                        TYPE_MAX78000_TMR, DeviceState*),
+    DEFINE_PROP_LINK("gpio0", Max78000GcrState, gpio0,
+                        TYPE_MAX78000_GPIO, DeviceState*),
+    DEFINE_PROP_LINK("gpio1", Max78000GcrState, gpio1,
+                        TYPE_MAX78000_GPIO, DeviceState*),
+    DEFINE_PROP_LINK("spi0", Max78000GcrState, spi0,
+                        TYPE_MAX78000_SPI, DeviceState*),
+    DEFINE_PROP_LINK("spi1", Max78000GcrState, spi1,
+                        TYPE_MAX78000_SPI, DeviceState*),
+    DEFINE_PROP_LINK("i2c0", Max78000GcrState, i2c0,
+                        TYPE_MAX78000_I2C, DeviceState*),
+    DEFINE_PROP_LINK("i2c1", Max78000GcrState, i2c1,
+                        TYPE_MAX78000_I2C, DeviceState*),
+    DEFINE_PROP_LINK("i2c2", Max78000GcrState, i2c2,
+                        TYPE_MAX78000_I2C, DeviceState*),
+    DEFINE_PROP_LINK("crc", Max78000GcrState, crc,
+                        TYPE_MAX78000_CRC, DeviceState*),
+    DEFINE_PROP_LINK("sema", Max78000GcrState, sema,
+                        TYPE_MAX78000_SEMA, DeviceState*),
+    DEFINE_PROP_LINK("i2s", Max78000GcrState, i2s,
+                        TYPE_MAX78000_I2S, DeviceState*),
+    DEFINE_PROP_LINK("adc", Max78000GcrState, adc,
+                        TYPE_MAX78000_ADC, DeviceState*),
+    DEFINE_PROP_LINK("wdt0", Max78000GcrState, wdt0,
+                        TYPE_MAX78000_WDT, DeviceState*),
+    DEFINE_PROP_LINK("rtc", Max78000GcrState, rtc,
+                        TYPE_MAX78000_RTC, DeviceState*),
+    DEFINE_PROP_LINK("wut", Max78000GcrState, wut,
+                        TYPE_MAX78000_WUT, Max78000WutState*),
+    DEFINE_PROP_LINK("pt", Max78000GcrState, pt,
+                        TYPE_MAX78000_PT, DeviceState*),
+    DEFINE_PROP_LINK("owm", Max78000GcrState, owm,
+                        TYPE_MAX78000_OWM, DeviceState*),
+    DEFINE_PROP_LINK("cpu", Max78000GcrState, cpu,
+                        TYPE_CPU, CPUState*),
+    DEFINE_PROP_BOOL("fast-forward", Max78000GcrState, fast_forward, false),
 };
 
 static const MemoryRegionOps max78000_gcr_ops = {
@@ -281,8 +619,8 @@ static const MemoryRegionOps max78000_gcr_ops = {
 
 static const VMStateDescription vmstate_max78000_gcr = {
     .name = TYPE_MAX78000_GCR,
-    .version_id = 1,
-    .minimum_version_id = 1,
+    .version_id = 3,
+    .minimum_version_id = 3,
     .fields = (const VMStateField[]) {
         VMSTATE_UINT32(sysctrl, Max78000GcrState),
         VMSTATE_UINT32(rst0, Max78000GcrState),
@@ -302,6 +640,10 @@ static const VMStateDescription vmstate_max78000_gcr = {
         VMSTATE_UINT32(ecced, Max78000GcrState),
         VMSTATE_UINT32(eccie, Max78000GcrState),
         VMSTATE_UINT32(eccaddr, Max78000GcrState),
+        VMSTATE_UINT32(wake_level, Max78000GcrState),
+        VMSTATE_BOOL(sleeping, Max78000GcrState),
+        VMSTATE_CLOCK(pclk, Max78000GcrState),
+        VMSTATE_ARRAY_CLOCK(clk_out, Max78000GcrState, GCR_NUM_CLK_OUT),
         VMSTATE_END_OF_LIST()
     }
 };
@@ -309,11 +651,22 @@ static const VMStateDescription vmstate_max78000_gcr = {
 static void max78000_gcr_init(Object *obj)
 {
     Max78000GcrState *s = MAX78000_GCR(obj);
+    int i;
 
     memory_region_init_io(&s->mmio, obj, &max78000_gcr_ops, s,
                           TYPE_MAX78000_GCR, 0x400);
     sysbus_init_mmio(SYS_BUS_DEVICE(obj), &s->mmio);
 
+    qdev_init_gpio_in_named(DEVICE(obj), max78000_gcr_wakeup, "wakeup",
+                            GCR_NUM_WAKE);
+    qdev_init_gpio_out_named(DEVICE(obj), &s->ready_irq, "ready", 1);
+
+    s->pclk = qdev_init_clock_in(DEVICE(obj), "pclk",
+                                 max78000_gcr_pclk_update, s, ClockUpdate);
+    for (i = 0; i < GCR_NUM_CLK_OUT; i++) {
+        s->clk_out[i] = qdev_init_clock_out(DEVICE(obj),
+                                            max78000_gcr_clocks[i].name);
+    }
 }
 
 static void max78000_gcr_realize(DeviceState *dev, Error **errp)
@@ -333,6 +686,7 @@ static void max78000_gcr_class_init(ObjectClass *klass, const void *data)
     dc->realize = max78000_gcr_realize;
     dc->vmsd = &vmstate_max78000_gcr;
     rc->phases.hold = max78000_gcr_reset_hold;
+    rc->phases.exit = max78000_gcr_reset_exit;
 }
 
 static const TypeInfo max78000_gcr_info = {
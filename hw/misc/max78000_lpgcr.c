@@ -0,0 +1,197 @@
+/*
+ * MAX78000 Low Power Global Control Registers
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Reset and clock control for the peripherals in the low power domain.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/log.h"
+#include "trace.h"
+#include "migration/vmstate.h"
+#include "hw/qdev-properties.h"
+#include "hw/qdev-clock.h"
+#include "hw/timer/max78000_tmr.h"
+#include "hw/gpio/max78000_gpio.h"
+#include "hw/watchdog/max78000_wdt.h"
+#include "hw/char/max78000_uart.h"
+#include "hw/misc/max78000_lpgcr.h"
+
+static const struct {
+    const char *name;
+    uint32_t bit;
+} max78000_lpgcr_clocks[LPGCR_NUM_CLK_OUT] = {
+    { "tmr4-clk", LPGCR_TMR4 },
+    { "tmr5-clk", LPGCR_TMR5 },
+    { "gpio2-clk", LPGCR_GPIO2 },
+    { "wdt1-clk", LPGCR_WDT1 },
+    { "uart3-clk", LPGCR_UART3 },
+};
+
+/* Each "*-clk" output follows PCLK while its PCLKDIS bit is clear */
+static void max78000_lpgcr_update_clocks(Max78000LpgcrState *s)
+{
+    int i;
+
+    for (i = 0; i < LPGCR_NUM_CLK_OUT; i++) {
+        bool gated = s->pclkdis & max78000_lpgcr_clocks[i].bit;
+
+        clock_update(s->clk_out[i], gated ? 0 : clock_get(s->pclk));
+    }
+}
+
+static void max78000_lpgcr_pclk_update(void *opaque, ClockEvent event)
+{
+    max78000_lpgcr_update_clocks(opaque);
+}
+
+static uint64_t max78000_lpgcr_read(void *opaque, hwaddr addr,
+                                    unsigned int size)
+{
+    Max78000LpgcrState *s = opaque;
+
+    switch (addr) {
+    case LPGCR_RST:
+        /* Resets complete immediately */
+        return 0;
+
+    case LPGCR_PCLKDIS:
+        return s->pclkdis;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        return 0;
+    }
+}
+
+static void max78000_lpgcr_write(void *opaque, hwaddr addr,
+                                 uint64_t val64, unsigned int size)
+{
+    Max78000LpgcrState *s = opaque;
+    uint32_t val = val64;
+
+    switch (addr) {
+    case LPGCR_RST:
+        if (val & LPGCR_TMR4) {
+            device_cold_reset(s->tmr4);
+        }
+        if (val & LPGCR_TMR5) {
+            device_cold_reset(s->tmr5);
+        }
+        if (val & LPGCR_GPIO2) {
+            device_cold_reset(s->gpio2);
+        }
+        if (val & LPGCR_WDT1) {
+            device_cold_reset(s->wdt1);
+        }
+        if (val & LPGCR_UART3) {
+            device_cold_reset(s->uart3);
+        }
+        break;
+
+    case LPGCR_PCLKDIS:
+        s->pclkdis = val;
+        max78000_lpgcr_update_clocks(s);
+        break;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        break;
+    }
+}
+
+static void max78000_lpgcr_reset_hold(Object *obj, ResetType type)
+{
+    Max78000LpgcrState *s = MAX78000_LPGCR(obj);
+
+    s->pclkdis = LPGCR_GPIO2 | LPGCR_WDT1 | LPGCR_TMR4 | LPGCR_TMR5 |
+                 LPGCR_UART3 | LPGCR_LPCOMP;
+}
+
+static void max78000_lpgcr_reset_exit(Object *obj, ResetType type)
+{
+    Max78000LpgcrState *s = MAX78000_LPGCR(obj);
+
+    max78000_lpgcr_update_clocks(s);
+}
+
+static const Property max78000_lpgcr_properties[] = {
+    DEFINE_PROP_LINK("tmr4", Max78000LpgcrState, tmr4,
+                     TYPE_MAX78000_TMR, DeviceState*),
+    DEFINE_PROP_LINK("tmr5", Max78000LpgcrState, tmr5,
+                     TYPE_MAX78000_TMR, DeviceState*),
+    DEFINE_PROP_LINK("gpio2", Max78000LpgcrState, gpio2,
+                     TYPE_MAX78000_GPIO, DeviceState*),
+    DEFINE_PROP_LINK("wdt1", Max78000LpgcrState, wdt1,
+                     TYPE_MAX78000_WDT, DeviceState*),
+    DEFINE_PROP_LINK("uart3", Max78000LpgcrState, uart3,
+                     TYPE_MAX78000_UART, DeviceState*),
+};
+
+static const MemoryRegionOps max78000_lpgcr_ops = {
+    .read = max78000_lpgcr_read,
+    .write = max78000_lpgcr_write,
+    .endianness = DEVICE_LITTLE_ENDIAN,
+    .valid.min_access_size = 4,
+    .valid.max_access_size = 4,
+};
+
+static const VMStateDescription vmstate_max78000_lpgcr = {
+    .name = TYPE_MAX78000_LPGCR,
+    .version_id = 2,
+    .minimum_version_id = 2,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(pclkdis, Max78000LpgcrState),
+        VMSTATE_CLOCK(pclk, Max78000LpgcrState),
+        VMSTATE_ARRAY_CLOCK(clk_out, Max78000LpgcrState, LPGCR_NUM_CLK_OUT),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static void max78000_lpgcr_init(Object *obj)
+{
+    Max78000LpgcrState *s = MAX78000_LPGCR(obj);
+    int i;
+
+    memory_region_init_io(&s->mmio, obj, &max78000_lpgcr_ops, s,
+                          TYPE_MAX78000_LPGCR, 0x400);
+    sysbus_init_mmio(SYS_BUS_DEVICE(obj), &s->mmio);
+
+    s->pclk = qdev_init_clock_in(DEVICE(obj), "pclk",
+                                 max78000_lpgcr_pclk_update, s, ClockUpdate);
+    for (i = 0; i < LPGCR_NUM_CLK_OUT; i++) {
+        s->clk_out[i] = qdev_init_clock_out(DEVICE(obj),
+                                            max78000_lpgcr_clocks[i].name);
+    }
+}
+
+static void max78000_lpgcr_class_init(ObjectClass *klass, const void *data)
+{
+    ResettableClass *rc = RESETTABLE_CLASS(klass);
+    DeviceClass *dc = DEVICE_CLASS(klass);
+
+    rc->phases.hold = max78000_lpgcr_reset_hold;
+    rc->phases.exit = max78000_lpgcr_reset_exit;
+    device_class_set_props(dc, max78000_lpgcr_properties);
+    dc->vmsd = &vmstate_max78000_lpgcr;
+}
+
+static const TypeInfo max78000_lpgcr_info = {
+    .name          = TYPE_MAX78000_LPGCR,
+    .parent        = TYPE_SYS_BUS_DEVICE,
+    .instance_size = sizeof(Max78000LpgcrState),
+    .instance_init = max78000_lpgcr_init,
+    .class_init    = max78000_lpgcr_class_init,
+};
+
+static void max78000_lpgcr_register_types(void)
+{
+    type_register_static(&max78000_lpgcr_info);
+}
+
+type_init(max78000_lpgcr_register_types)
@@ -0,0 +1,673 @@
+/*
+ * MAX78000 1-Wire Master
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Resets and byte or single bit transfers, at standard or overdrive
+ * speed. Each takes the virtual time its time slots would take on the
+ * wire. Bit-bang mode and the search ROM accelerator are not modeled.
+ *
+ * With "ds18b20" set, a DS18B20 temperature sensor is attached to the
+ * bus. Its "temperature" property, in millidegrees Celsius, can be
+ * changed at any time.
+ *
+ * Like the pulse train engine, every reset or transfer is described by
+ * one run-length record of the bus level on the "chardev" backend and
+ * the max78000_owm_record trace event:
+ *
+ *   owm <start ns> <unit ns> 1 0 <run> [<run>...]
+ *
+ * The runs alternate between low and high, starting low, and include
+ * the slave's presence pulse and the bits it sends.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/bswap.h"
+#include "qemu/log.h"
+#include "qemu/timer.h"
+#include "qapi/error.h"
+#include "qapi/visitor.h"
+#include "trace.h"
+#include "hw/irq.h"
+#include "hw/qdev-clock.h"
+#include "hw/qdev-properties.h"
+#include "hw/qdev-properties-system.h"
+#include "migration/vmstate.h"
+#include "hw/misc/max78000_owm.h"
+
+/* Bus timings, in units of OWM_UNIT_NS, at standard and overdrive speed */
+#define OWM_UNIT_NS 500
+
+typedef struct {
+    /* Time slots: low then high for a 1, low then high for a 0 */
+    uint32_t low1, high1, low0, high0;
+    /* Reset: low, then the slave's presence pulse within the recovery */
+    uint32_t reset_low, presence_wait, presence_low, recovery;
+} Max78000OwmTiming;
+
+static const Max78000OwmTiming max78000_owm_timing[2] = {
+    { 12, 128, 120, 20, 960, 60, 240, 960 },
+    { 2, 15, 15, 5, 140, 4, 16, 97 },
+};
+
+#define DS18B20_FAMILY 0x28
+
+/* DS18B20 ROM and function commands */
+#define DS18B20_READ_ROM            0x33
+#define DS18B20_MATCH_ROM_CMD       0x55
+#define DS18B20_SKIP_ROM            0xcc
+#define DS18B20_SEARCH_ROM_CMD      0xf0
+#define DS18B20_ALARM_SEARCH        0xec
+#define DS18B20_CONVERT_T           0x44
+#define DS18B20_WRITE_SCRATCHPAD_CMD 0x4e
+#define DS18B20_READ_SCRATCHPAD     0xbe
+
+/* Scratchpad */
+#define DS18B20_TH      2
+#define DS18B20_TL      3
+#define DS18B20_CONFIG  4
+#define DS18B20_CRC     8
+
+/* Dallas/Maxim CRC-8, x^8 + x^5 + x^4 + 1, as used for the ROM and data */
+static uint8_t ds18b20_crc8(const uint8_t *buf, size_t len)
+{
+    uint8_t crc = 0;
+    uint8_t b;
+    int i;
+
+    while (len--) {
+        b = *buf++;
+        for (i = 0; i < 8; i++) {
+            crc = ((crc ^ b) & 1) ? (crc >> 1) ^ 0x8c : crc >> 1;
+            b >>= 1;
+        }
+    }
+    return crc;
+}
+
+static void ds18b20_enter(Ds18b20State *d, Ds18b20Phase phase)
+{
+    d->phase = phase;
+    d->bits = 0;
+    d->shift = 0;
+}
+
+static void ds18b20_send(Ds18b20State *d, const uint8_t *buf, uint32_t len,
+                         Ds18b20Phase next)
+{
+    memcpy(d->tx, buf, len);
+    d->tx_len = len;
+    d->next_phase = next;
+    ds18b20_enter(d, DS18B20_SEND);
+}
+
+static void ds18b20_power_on(Ds18b20State *d)
+{
+    static const uint8_t scratchpad[9] = {
+        0x50, 0x05, 0x4b, 0x46, 0x7f, 0xff, 0x0c, 0x10
+    };
+
+    memcpy(d->scratchpad, scratchpad, sizeof(scratchpad));
+    ds18b20_enter(d, DS18B20_IDLE);
+}
+
+/* Latch the temperature at the configured 9-12 bit resolution */
+static void ds18b20_convert(Max78000OwmState *s)
+{
+    Ds18b20State *d = &s->dev;
+    int res = 9 + ((d->scratchpad[DS18B20_CONFIG] >> 5) & 3);
+    uint16_t raw = (int16_t)(s->temperature * 16 / 1000);
+
+    raw &= ~((1 << (12 - res)) - 1);
+    d->scratchpad[0] = raw;
+    d->scratchpad[1] = raw >> 8;
+    trace_max78000_owm_ds18b20_convert(s->temperature);
+}
+
+static bool ds18b20_alarm(Ds18b20State *d)
+{
+    int8_t t = (int16_t)(d->scratchpad[0] | d->scratchpad[1] << 8) >> 4;
+
+    return t >= (int8_t)d->scratchpad[DS18B20_TH] ||
+           t <= (int8_t)d->scratchpad[DS18B20_TL];
+}
+
+static void ds18b20_rom_command(Max78000OwmState *s, uint8_t cmd)
+{
+    Ds18b20State *d = &s->dev;
+    uint8_t rom[8];
+
+    switch (cmd) {
+    case DS18B20_READ_ROM:
+        stq_le_p(rom, s->ds18b20_rom);
+        ds18b20_send(d, rom, sizeof(rom), DS18B20_FUNC_CMD);
+        break;
+    case DS18B20_MATCH_ROM_CMD:
+        ds18b20_enter(d, DS18B20_MATCH_ROM);
+        break;
+    case DS18B20_SKIP_ROM:
+        ds18b20_enter(d, DS18B20_FUNC_CMD);
+        break;
+    case DS18B20_SEARCH_ROM_CMD:
+        ds18b20_enter(d, DS18B20_SEARCH_ROM);
+        break;
+    case DS18B20_ALARM_SEARCH:
+        ds18b20_enter(d, ds18b20_alarm(d) ? DS18B20_SEARCH_ROM :
+                                            DS18B20_IDLE);
+        break;
+    default:
+        ds18b20_enter(d, DS18B20_IDLE);
+        break;
+    }
+}
+
+/*
+ * Copy scratchpad, recall EEPROM and read power supply need no data
+ * phase: the sensor stays quiet, so read slots return 1 for "done" and
+ * "externally powered".
+ */
+static void ds18b20_function_command(Max78000OwmState *s, uint8_t cmd)
+{
+    Ds18b20State *d = &s->dev;
+
+    switch (cmd) {
+    case DS18B20_CONVERT_T:
+        ds18b20_convert(s);
+        ds18b20_enter(d, DS18B20_IDLE);
+        break;
+    case DS18B20_READ_SCRATCHPAD:
+        d->scratchpad[DS18B20_CRC] = ds18b20_crc8(d->scratchpad, 8);
+        ds18b20_send(d, d->scratchpad, sizeof(d->scratchpad), DS18B20_IDLE);
+        break;
+    case DS18B20_WRITE_SCRATCHPAD_CMD:
+        ds18b20_enter(d, DS18B20_WRITE_SCRATCHPAD);
+        break;
+    default:
+        ds18b20_enter(d, DS18B20_IDLE);
+        break;
+    }
+}
+
+/* One time slot in which the master sends @bit; returns the bus level */
+static bool ds18b20_slot(Max78000OwmState *s, bool bit)
+{
+    Ds18b20State *d = &s->dev;
+    bool out = true;
+    uint32_t i;
+
+    switch (d->phase) {
+    case DS18B20_ROM_CMD:
+    case DS18B20_FUNC_CMD:
+    case DS18B20_MATCH_ROM:
+    case DS18B20_WRITE_SCRATCHPAD:
+        d->shift |= (uint64_t)bit << d->bits++;
+        if (d->phase == DS18B20_ROM_CMD && d->bits == 8) {
+            ds18b20_rom_command(s, d->shift);
+        } else if (d->phase == DS18B20_FUNC_CMD && d->bits == 8) {
+            ds18b20_function_command(s, d->shift);
+        } else if (d->phase == DS18B20_MATCH_ROM && d->bits == 64) {
+            ds18b20_enter(d, d->shift == s->ds18b20_rom ? DS18B20_FUNC_CMD :
+                                                          DS18B20_IDLE);
+        } else if (d->phase == DS18B20_WRITE_SCRATCHPAD && d->bits == 24) {
+            d->scratchpad[DS18B20_TH] = d->shift;
+            d->scratchpad[DS18B20_TL] = d->shift >> 8;
+            d->scratchpad[DS18B20_CONFIG] = ((d->shift >> 16) & 0x60) | 0x1f;
+            ds18b20_enter(d, DS18B20_IDLE);
+        }
+        break;
+
+    case DS18B20_SEARCH_ROM:
+        /* Each ROM bit is sent, then its complement, then the master's */
+        i = d->bits / 3;
+        out = extract64(s->ds18b20_rom, i, 1);
+        switch (d->bits++ % 3) {
+        case 1:
+            out = !out;
+            break;
+        case 2:
+            if (bit != out) {
+                ds18b20_enter(d, DS18B20_IDLE);
+            } else if (i == 63) {
+                ds18b20_enter(d, DS18B20_FUNC_CMD);
+            }
+            out = true;
+            break;
+        }
+        break;
+
+    case DS18B20_SEND:
+        out = (d->tx[d->bits / 8] >> (d->bits % 8)) & 1;
+        if (++d->bits == d->tx_len * 8) {
+            ds18b20_enter(d, d->next_phase);
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    return bit && out;
+}
+
+static void max78000_owm_update_irq(Max78000OwmState *s)
+{
+    qemu_set_irq(s->irq, s->intfl & s->inten);
+}
+
+static bool max78000_owm_recording(Max78000OwmState *s)
+{
+    return qemu_chr_fe_backend_connected(&s->chr) ||
+           trace_event_get_state_backends(TRACE_MAX78000_OWM_RECORD);
+}
+
+static const Max78000OwmTiming *max78000_owm_timing_for(Max78000OwmState *s)
+{
+    return &max78000_owm_timing[!!(s->cfg & OWM_CFG_OVERDRIVE)];
+}
+
+/*
+ * Emit the record for an operation made of @n runs, and complete the
+ * operation once they have gone by.
+ */
+static void max78000_owm_finish(Max78000OwmState *s, const uint32_t *runs,
+                                int n, uint32_t intfl)
+{
+    int64_t now = qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
+    g_autoptr(GString) rec = NULL;
+    uint64_t units = 0;
+    int i;
+
+    if (max78000_owm_recording(s)) {
+        rec = g_string_new(NULL);
+        g_string_printf(rec, "owm %" PRId64 " %d 1 0", now, OWM_UNIT_NS);
+        for (i = 0; i < n; i++) {
+            g_string_append_printf(rec, " %u", runs[i]);
+        }
+        trace_max78000_owm_record(rec->str);
+        g_string_append_c(rec, '\n');
+        qemu_chr_fe_write_all(&s->chr, (const uint8_t *)rec->str, rec->len);
+    }
+
+    for (i = 0; i < n; i++) {
+        units += runs[i];
+    }
+    s->pending_intfl = intfl;
+    timer_mod(s->timer, now + units * OWM_UNIT_NS);
+}
+
+static void max78000_owm_reset_bus(Max78000OwmState *s)
+{
+    const Max78000OwmTiming *t = max78000_owm_timing_for(s);
+    uint32_t runs[4];
+    int n = 0;
+
+    runs[n++] = t->reset_low;
+    if (s->ds18b20) {
+        ds18b20_enter(&s->dev, DS18B20_ROM_CMD);
+        s->ctrl_stat |= OWM_CTRL_PRESENCE_DETECT;
+        runs[n++] = t->presence_wait;
+        runs[n++] = t->presence_low;
+        runs[n++] = t->recovery - t->presence_wait - t->presence_low;
+    } else {
+        s->ctrl_stat &= ~OWM_CTRL_PRESENCE_DETECT;
+        runs[n++] = t->recovery;
+    }
+
+    s->ctrl_stat |= OWM_CTRL_START_OW_RESET;
+    max78000_owm_finish(s, runs, n, OWM_INT_RESET_DONE);
+}
+
+/* Send the byte, or the bit, in @val and read back the bus */
+static void max78000_owm_transfer(Max78000OwmState *s, uint8_t val)
+{
+    const Max78000OwmTiming *t = max78000_owm_timing_for(s);
+    int nbits = (s->cfg & OWM_CFG_SINGLE_BIT_MODE) ? 1 : 8;
+    uint32_t runs[16];
+    uint8_t rx = 0;
+    bool bus;
+    int i;
+
+    for (i = 0; i < nbits; i++) {
+        bus = extract32(val, i, 1);
+        if (s->ds18b20) {
+            bus = ds18b20_slot(s, bus);
+        }
+        rx |= bus << i;
+        runs[2 * i] = bus ? t->low1 : t->low0;
+        runs[2 * i + 1] = bus ? t->high1 : t->high0;
+    }
+
+    s->data = rx;
+    max78000_owm_finish(s, runs, 2 * nbits,
+                        OWM_INT_TX_DATA_EMPTY | OWM_INT_RX_DATA_READY);
+}
+
+static void max78000_owm_done(void *opaque)
+{
+    Max78000OwmState *s = opaque;
+
+    s->ctrl_stat &= ~OWM_CTRL_START_OW_RESET;
+    s->intfl |= s->pending_intfl;
+    s->pending_intfl = 0;
+    max78000_owm_update_irq(s);
+}
+
+/* Stopping the clock abandons an operation in progress on the bus */
+static void max78000_owm_clk_update(void *opaque, ClockEvent event)
+{
+    Max78000OwmState *s = opaque;
+
+    if (s->timer && !clock_is_enabled(s->clk) && timer_pending(s->timer)) {
+        timer_del(s->timer);
+        s->ctrl_stat &= ~OWM_CTRL_START_OW_RESET;
+        s->pending_intfl = 0;
+    }
+}
+
+static bool max78000_owm_can_start(Max78000OwmState *s)
+{
+    if (!clock_is_enabled(s->clk)) {
+        return false;
+    }
+    if (timer_pending(s->timer)) {
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: 1-Wire bus is busy\n", __func__);
+        return false;
+    }
+    return true;
+}
+
+static uint64_t max78000_owm_read(void *opaque, hwaddr addr,
+                                  unsigned int size)
+{
+    Max78000OwmState *s = opaque;
+
+    switch (addr) {
+    case OWM_CFG:
+        return s->cfg;
+
+    case OWM_CLK_DIV_1US:
+        return s->clk_div_1us;
+
+    case OWM_CTRL_STAT:
+        /* The bus idles high */
+        return s->ctrl_stat | OWM_CTRL_OW_INPUT;
+
+    case OWM_DATA:
+        return s->data;
+
+    case OWM_INTFL:
+        return s->intfl;
+
+    case OWM_INTEN:
+        return s->inten;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        return 0;
+    }
+}
+
+static void max78000_owm_write(void *opaque, hwaddr addr,
+                               uint64_t val64, unsigned int size)
+{
+    Max78000OwmState *s = opaque;
+    uint32_t val = val64;
+
+    switch (addr) {
+    case OWM_CFG:
+        if (val & OWM_CFG_BIT_BANG_EN) {
+            qemu_log_mask(LOG_UNIMP, "%s: Bit-bang mode not implemented\n",
+                          __func__);
+        }
+        s->cfg = val & 0xff;
+        break;
+
+    case OWM_CLK_DIV_1US:
+        s->clk_div_1us = val & 0xff;
+        break;
+
+    case OWM_CTRL_STAT:
+        if (val & OWM_CTRL_SRA_MODE) {
+            qemu_log_mask(LOG_UNIMP, "%s: Search ROM accelerator not "
+                          "implemented\n", __func__);
+        }
+        s->ctrl_stat = (s->ctrl_stat & (OWM_CTRL_START_OW_RESET |
+                                        OWM_CTRL_PRESENCE_DETECT)) |
+                       (val & (OWM_CTRL_SRA_MODE | OWM_CTRL_BIT_BANG_OE |
+                               OWM_CTRL_OD_SPEC_MODE));
+        if ((val & OWM_CTRL_START_OW_RESET) && max78000_owm_can_start(s)) {
+            max78000_owm_reset_bus(s);
+        }
+        break;
+
+    case OWM_DATA:
+        if (max78000_owm_can_start(s)) {
+            max78000_owm_transfer(s, val);
+        }
+        break;
+
+    case OWM_INTFL:
+        s->intfl &= ~val;
+        max78000_owm_update_irq(s);
+        break;
+
+    case OWM_INTEN:
+        s->inten = val & OWM_INT_ALL;
+        max78000_owm_update_irq(s);
+        break;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        break;
+    }
+}
+
+static void max78000_owm_get_temperature(Object *obj, Visitor *v,
+                                         const char *name, void *opaque,
+                                         Error **errp)
+{
+    Max78000OwmState *s = MAX78000_OWM(obj);
+    int64_t value = s->temperature;
+
+    visit_type_int(v, name, &value, errp);
+}
+
+static void max78000_owm_set_temperature(Object *obj, Visitor *v,
+                                         const char *name, void *opaque,
+                                         Error **errp)
+{
+    Max78000OwmState *s = MAX78000_OWM(obj);
+    int64_t temp;
+
+    if (!visit_type_int(v, name, &temp, errp)) {
+        return;
+    }
+    if (temp < -55000 || temp > 125000) {
+        error_setg(errp, "value %" PRId64 " millidegrees C is out of range",
+                   temp);
+        return;
+    }
+    s->temperature = temp;
+}
+
+static void max78000_owm_reset_hold(Object *obj, ResetType type)
+{
+    Max78000OwmState *s = MAX78000_OWM(obj);
+
+    s->cfg = 0;
+    s->clk_div_1us = 0;
+    s->ctrl_stat = 0;
+    s->data = 0;
+    s->intfl = 0;
+    s->inten = 0;
+    s->pending_intfl = 0;
+    if (s->timer) {
+        timer_del(s->timer);
+    }
+    ds18b20_power_on(&s->dev);
+}
+
+static void max78000_owm_reset_exit(Object *obj, ResetType type)
+{
+    Max78000OwmState *s = MAX78000_OWM(obj);
+
+    max78000_owm_update_irq(s);
+}
+
+static const MemoryRegionOps max78000_owm_ops = {
+    .read = max78000_owm_read,
+    .write = max78000_owm_write,
+    .endianness = DEVICE_LITTLE_ENDIAN,
+    .valid.min_access_size = 4,
+    .valid.max_access_size = 4,
+};
+
+static const Property max78000_owm_properties[] = {
+    DEFINE_PROP_CHR("chardev", Max78000OwmState, chr),
+    DEFINE_PROP_BOOL("ds18b20", Max78000OwmState, ds18b20, false),
+    DEFINE_PROP_UINT64("ds18b20-serial", Max78000OwmState, ds18b20_serial,
+                       1),
+};
+
+/* Slots index tx[] and the ROM by the bit count, so bound it by phase */
+static int ds18b20_post_load(void *opaque, int version_id)
+{
+    Ds18b20State *d = opaque;
+    uint32_t max_bits;
+
+    if (d->next_phase >= DS18B20_SEND || d->tx_len > sizeof(d->tx)) {
+        return -EINVAL;
+    }
+
+    switch (d->phase) {
+    case DS18B20_IDLE:
+        return 0;
+    case DS18B20_ROM_CMD:
+    case DS18B20_FUNC_CMD:
+        max_bits = 8;
+        break;
+    case DS18B20_MATCH_ROM:
+        max_bits = 64;
+        break;
+    case DS18B20_SEARCH_ROM:
+        max_bits = 3 * 64;
+        break;
+    case DS18B20_WRITE_SCRATCHPAD:
+        max_bits = 24;
+        break;
+    case DS18B20_SEND:
+        max_bits = d->tx_len * 8;
+        break;
+    default:
+        return -EINVAL;
+    }
+
+    return d->bits < max_bits ? 0 : -EINVAL;
+}
+
+static const VMStateDescription vmstate_ds18b20 = {
+    .name = "ds18b20",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .post_load = ds18b20_post_load,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(phase, Ds18b20State),
+        VMSTATE_UINT32(bits, Ds18b20State),
+        VMSTATE_UINT64(shift, Ds18b20State),
+        VMSTATE_UINT8_ARRAY(tx, Ds18b20State, 9),
+        VMSTATE_UINT32(tx_len, Ds18b20State),
+        VMSTATE_UINT32(next_phase, Ds18b20State),
+        VMSTATE_UINT8_ARRAY(scratchpad, Ds18b20State, 9),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static const VMStateDescription vmstate_max78000_owm = {
+    .name = TYPE_MAX78000_OWM,
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(cfg, Max78000OwmState),
+        VMSTATE_UINT32(clk_div_1us, Max78000OwmState),
+        VMSTATE_UINT32(ctrl_stat, Max78000OwmState),
+        VMSTATE_UINT32(data, Max78000OwmState),
+        VMSTATE_UINT32(intfl, Max78000OwmState),
+        VMSTATE_UINT32(inten, Max78000OwmState),
+        VMSTATE_UINT32(pending_intfl, Max78000OwmState),
+        VMSTATE_TIMER_PTR(timer, Max78000OwmState),
+        VMSTATE_INT32(temperature, Max78000OwmState),
+        VMSTATE_STRUCT(dev, Max78000OwmState, 1, vmstate_ds18b20,
+                       Ds18b20State),
+        VMSTATE_CLOCK(clk, Max78000OwmState),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static void max78000_owm_init(Object *obj)
+{
+    Max78000OwmState *s = MAX78000_OWM(obj);
+
+    sysbus_init_irq(SYS_BUS_DEVICE(obj), &s->irq);
+
+    memory_region_init_io(&s->mmio, obj, &max78000_owm_ops, s,
+                          TYPE_MAX78000_OWM, 0x1000);
+    sysbus_init_mmio(SYS_BUS_DEVICE(obj), &s->mmio);
+
+    s->clk = qdev_init_clock_in(DEVICE(obj), "clk", max78000_owm_clk_update,
+                                s, ClockUpdate);
+
+    s->temperature = 25000;
+    object_property_add(obj, "temperature", "int",
+                        max78000_owm_get_temperature,
+                        max78000_owm_set_temperature, NULL, NULL);
+}
+
+static void max78000_owm_realize(DeviceState *dev, Error **errp)
+{
+    Max78000OwmState *s = MAX78000_OWM(dev);
+    uint8_t rom[8];
+
+    if (!clock_has_source(s->clk)) {
+        error_setg(errp, "MAX78000 OWM: clk must be connected");
+        return;
+    }
+
+    /* Family code, 48-bit serial number, CRC */
+    stq_le_p(rom, DS18B20_FAMILY |
+             (extract64(s->ds18b20_serial, 0, 48) << 8));
+    rom[7] = ds18b20_crc8(rom, 7);
+    s->ds18b20_rom = ldq_le_p(rom);
+
+    s->timer = timer_new_ns(QEMU_CLOCK_VIRTUAL, max78000_owm_done, s);
+}
+
+static void max78000_owm_class_init(ObjectClass *klass, const void *data)
+{
+    ResettableClass *rc = RESETTABLE_CLASS(klass);
+    DeviceClass *dc = DEVICE_CLASS(klass);
+
+    rc->phases.hold = max78000_owm_reset_hold;
+    rc->phases.exit = max78000_owm_reset_exit;
+    dc->realize = max78000_owm_realize;
+    dc->vmsd = &vmstate_max78000_owm;
+    device_class_set_props(dc, max78000_owm_properties);
+}
+
+static const TypeInfo max78000_owm_info = {
+    .name          = TYPE_MAX78000_OWM,
+    .parent        = TYPE_SYS_BUS_DEVICE,
+    .instance_size = sizeof(Max78000OwmState),
+    .instance_init = max78000_owm_init,
+    .class_init    = max78000_owm_class_init,
+};
+
+static void max78000_owm_register_types(void)
+{
+    type_register_static(&max78000_owm_info);
+}
+
+type_init(max78000_owm_register_types)
@@ -0,0 +1,406 @@
+/*
+ * MAX78000 Parallel Camera Interface
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * There is no sensor on the other side of the pins; instead whole frames
+ * are taken from a host-side source at "fps" frames per second of
+ * virtual time:
+ *
+ *  - a "frames" file of raw frames of "frame-size" bytes each, mapped
+ *    into QEMU and played in a loop, or
+ *  - a "chardev" stream of back to back frames, for a live feed.
+ *
+ * Frames hold the data exactly as FIFO_DATA returns it, little endian
+ * 32 bit words already packed for the configured DATA_WIDTH. A frame is
+ * latched at the start of each frame period (VSYNC) and read straight
+ * out of the mapping or the receive buffer: nothing is copied until the
+ * DMA, or the CPU, drains FIFO_DATA into guest memory. A new frame that
+ * arrives while the previous one is still being read is dropped, as it
+ * would overflow the FIFO on hardware. IMG_DONE is raised once the last
+ * word of a frame has been read; there are no separate line interrupts.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/log.h"
+#include "qemu/timer.h"
+#include "qapi/error.h"
+#include "trace.h"
+#include "hw/irq.h"
+#include "hw/qdev-clock.h"
+#include "hw/qdev-properties.h"
+#include "hw/qdev-properties-system.h"
+#include "migration/vmstate.h"
+#include "hw/misc/max78000_pcif.h"
+
+static bool max78000_pcif_has_source(Max78000PcifState *s)
+{
+    return s->frames || qemu_chr_fe_backend_connected(&s->chr);
+}
+
+static uint32_t max78000_pcif_level(Max78000PcifState *s)
+{
+    return MIN((s->frame_size - s->pos) / 4, PCIF_FIFO_DEPTH);
+}
+
+static void max78000_pcif_update(Max78000PcifState *s)
+{
+    uint32_t thrsh = (s->ctrl >> PCIF_CTRL_FIFO_THRSH_SHIFT) &
+                     PCIF_CTRL_FIFO_THRSH_MASK;
+    uint32_t level = max78000_pcif_level(s);
+
+    if (level) {
+        s->int_fl |= PCIF_INT_FIFO_NOT_EMPTY;
+    }
+    if (level && level >= thrsh) {
+        s->int_fl |= PCIF_INT_FIFO_THRESH;
+    }
+    if (level == PCIF_FIFO_DEPTH) {
+        s->int_fl |= PCIF_INT_FIFO_FULL;
+    }
+
+    qemu_set_irq(s->irq, s->int_fl & s->int_en);
+    qemu_set_irq(s->dma_req, level != 0);
+}
+
+static void max78000_pcif_update_timer(Max78000PcifState *s)
+{
+    if (!s->vsync_timer) {
+        /* Not realized yet; reset starts the timer */
+        return;
+    }
+    if (!max78000_pcif_has_source(s) || !clock_is_enabled(s->clk)) {
+        timer_del(s->vsync_timer);
+    } else if (!timer_pending(s->vsync_timer)) {
+        timer_mod(s->vsync_timer, qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL) +
+                  NANOSECONDS_PER_SECOND / s->fps);
+    }
+}
+
+static bool max78000_pcif_capturing(Max78000PcifState *s)
+{
+    if (!(s->ctrl & PCIF_CTRL_PCIF_SYS)) {
+        return false;
+    }
+    return (s->ctrl & PCIF_CTRL_READ_MODE_MASK) ==
+           PCIF_CTRL_READ_MODE_CONTINUOUS || !s->captured;
+}
+
+static void max78000_pcif_vsync(void *opaque)
+{
+    Max78000PcifState *s = opaque;
+    const uint8_t *frame = NULL;
+    bool busy = s->pos < s->frame_size;
+
+    if (s->frames) {
+        frame = (const uint8_t *)g_mapped_file_get_contents(s->frames) +
+                (size_t)s->next * s->frame_size;
+        if (max78000_pcif_capturing(s) && !busy) {
+            s->cur = s->next;
+        }
+        s->next = (s->next + 1) % s->num_frames;
+    } else if (s->chr_len == s->frame_size) {
+        /* The receive buffer becomes the frame; keep filling the other */
+        frame = s->chr_frame[0];
+        if (max78000_pcif_capturing(s) && !busy) {
+            s->chr_frame[0] = s->chr_frame[1];
+            s->chr_frame[1] = (uint8_t *)frame;
+        }
+        s->chr_len = 0;
+        qemu_chr_fe_accept_input(&s->chr);
+    }
+
+    if (frame && max78000_pcif_capturing(s)) {
+        if (busy) {
+            trace_max78000_pcif_overrun(s->pos, s->frame_size);
+        } else {
+            trace_max78000_pcif_frame(s->cur);
+            s->frame = s->frames ? frame : s->chr_frame[1];
+            s->pos = 0;
+            s->captured = true;
+        }
+    }
+
+    max78000_pcif_update_timer(s);
+    max78000_pcif_update(s);
+}
+
+static int max78000_pcif_can_receive(void *opaque)
+{
+    Max78000PcifState *s = opaque;
+
+    return s->frame_size - s->chr_len;
+}
+
+static void max78000_pcif_receive(void *opaque, const uint8_t *buf, int size)
+{
+    Max78000PcifState *s = opaque;
+
+    memcpy(s->chr_frame[0] + s->chr_len, buf, size);
+    s->chr_len += size;
+}
+
+static uint32_t max78000_pcif_pop(Max78000PcifState *s)
+{
+    uint32_t val;
+
+    if (s->pos >= s->frame_size) {
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: FIFO empty\n", __func__);
+        return 0;
+    }
+    val = ldl_le_p(s->frame + s->pos);
+    s->pos += 4;
+    if (s->pos == s->frame_size) {
+        s->int_fl |= PCIF_INT_IMG_DONE;
+    }
+    return val;
+}
+
+static uint64_t max78000_pcif_read(void *opaque, hwaddr addr,
+                                   unsigned int size)
+{
+    Max78000PcifState *s = opaque;
+    uint32_t val;
+
+    switch (addr) {
+    case PCIF_CTRL:
+        return s->ctrl;
+
+    case PCIF_INT_EN:
+        return s->int_en;
+
+    case PCIF_INT_FL:
+        return s->int_fl;
+
+    case PCIF_DS_TIMING_CODES:
+        return s->ds_timing_codes;
+
+    case PCIF_FIFO_DATA:
+        val = max78000_pcif_pop(s);
+        max78000_pcif_update(s);
+        return val;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        return 0;
+    }
+}
+
+static void max78000_pcif_write(void *opaque, hwaddr addr,
+                                uint64_t val64, unsigned int size)
+{
+    Max78000PcifState *s = opaque;
+    uint32_t val = val64;
+
+    switch (addr) {
+    case PCIF_CTRL:
+        if (!(val & PCIF_CTRL_PCIF_SYS)) {
+            /* Stopping the interface flushes the FIFO */
+            s->pos = s->frame_size;
+            s->captured = false;
+        }
+        s->ctrl = val;
+        break;
+
+    case PCIF_INT_EN:
+        s->int_en = val & PCIF_INT_ALL;
+        break;
+
+    case PCIF_INT_FL:
+        s->int_fl &= ~val;
+        break;
+
+    case PCIF_DS_TIMING_CODES:
+        s->ds_timing_codes = val;
+        break;
+
+    case PCIF_FIFO_DATA:
+        break;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        return;
+    }
+
+    max78000_pcif_update(s);
+}
+
+static void max78000_pcif_clk_update(void *opaque, ClockEvent event)
+{
+    Max78000PcifState *s = opaque;
+
+    max78000_pcif_update_timer(s);
+}
+
+static void max78000_pcif_reset_hold(Object *obj, ResetType type)
+{
+    Max78000PcifState *s = MAX78000_PCIF(obj);
+
+    s->ctrl = 0;
+    s->int_en = 0;
+    s->int_fl = 0;
+    s->ds_timing_codes = 0;
+    s->pos = s->frame_size;
+    s->captured = false;
+}
+
+static void max78000_pcif_reset_exit(Object *obj, ResetType type)
+{
+    Max78000PcifState *s = MAX78000_PCIF(obj);
+
+    max78000_pcif_update_timer(s);
+    max78000_pcif_update(s);
+}
+
+static int max78000_pcif_post_load(void *opaque, int version_id)
+{
+    Max78000PcifState *s = opaque;
+
+    /* FIFO_DATA reads move through the frame a word at a time */
+    if (s->pos > s->frame_size || s->pos % 4) {
+        return -EINVAL;
+    }
+
+    if (s->frames && s->cur < s->num_frames && s->next < s->num_frames) {
+        s->frame = (const uint8_t *)g_mapped_file_get_contents(s->frames) +
+                   (size_t)s->cur * s->frame_size;
+    } else {
+        /* A streamed frame is host-side input and is not migrated */
+        s->cur = 0;
+        s->next = 0;
+        s->pos = s->frame_size;
+    }
+    return 0;
+}
+
+static const MemoryRegionOps max78000_pcif_ops = {
+    .read = max78000_pcif_read,
+    .write = max78000_pcif_write,
+    .endianness = DEVICE_LITTLE_ENDIAN,
+    .valid.min_access_size = 4,
+    .valid.max_access_size = 4,
+};
+
+static const Property max78000_pcif_properties[] = {
+    DEFINE_PROP_CHR("chardev", Max78000PcifState, chr),
+    DEFINE_PROP_STRING("frames", Max78000PcifState, frames_path),
+    DEFINE_PROP_UINT32("frame-size", Max78000PcifState, frame_size, 0),
+    DEFINE_PROP_UINT32("fps", Max78000PcifState, fps, 30),
+};
+
+static const VMStateDescription vmstate_max78000_pcif = {
+    .name = TYPE_MAX78000_PCIF,
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .post_load = max78000_pcif_post_load,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(ctrl, Max78000PcifState),
+        VMSTATE_UINT32(int_en, Max78000PcifState),
+        VMSTATE_UINT32(int_fl, Max78000PcifState),
+        VMSTATE_UINT32(ds_timing_codes, Max78000PcifState),
+        VMSTATE_UINT32(pos, Max78000PcifState),
+        VMSTATE_UINT32(cur, Max78000PcifState),
+        VMSTATE_UINT32(next, Max78000PcifState),
+        VMSTATE_BOOL(captured, Max78000PcifState),
+        VMSTATE_TIMER_PTR(vsync_timer, Max78000PcifState),
+        VMSTATE_CLOCK(clk, Max78000PcifState),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static void max78000_pcif_init(Object *obj)
+{
+    Max78000PcifState *s = MAX78000_PCIF(obj);
+
+    sysbus_init_irq(SYS_BUS_DEVICE(obj), &s->irq);
+    qdev_init_gpio_out_named(DEVICE(obj), &s->dma_req, "dma-rx", 1);
+
+    s->clk = qdev_init_clock_in(DEVICE(obj), "clk", max78000_pcif_clk_update,
+                                s, ClockUpdate);
+
+    memory_region_init_io(&s->mmio, obj, &max78000_pcif_ops, s,
+                          TYPE_MAX78000_PCIF, 0x1000);
+    sysbus_init_mmio(SYS_BUS_DEVICE(obj), &s->mmio);
+}
+
+static void max78000_pcif_realize(DeviceState *dev, Error **errp)
+{
+    Max78000PcifState *s = MAX78000_PCIF(dev);
+    g_autoptr(GError) gerr = NULL;
+    bool chr = qemu_chr_fe_backend_connected(&s->chr);
+
+    if (!clock_has_source(s->clk)) {
+        error_setg(errp, "MAX78000 PCIF: clk must be connected");
+        return;
+    }
+    if (s->frames_path && chr) {
+        error_setg(errp, "MAX78000 PCIF: frames and chardev are exclusive");
+        return;
+    }
+    if ((s->frames_path || chr) &&
+        (s->frame_size == 0 || s->frame_size % 4)) {
+        error_setg(errp, "MAX78000 PCIF: frame-size must be a non-zero "
+                   "multiple of 4");
+        return;
+    }
+    if (s->fps == 0) {
+        error_setg(errp, "MAX78000 PCIF: fps must not be 0");
+        return;
+    }
+
+    if (s->frames_path) {
+        s->frames = g_mapped_file_new(s->frames_path, false, &gerr);
+        if (!s->frames) {
+            error_setg(errp, "MAX78000 PCIF: could not map '%s': %s",
+                       s->frames_path, gerr->message);
+            return;
+        }
+        s->num_frames = g_mapped_file_get_length(s->frames) / s->frame_size;
+        if (s->num_frames == 0) {
+            error_setg(errp, "MAX78000 PCIF: '%s' is smaller than a frame",
+                       s->frames_path);
+            g_mapped_file_unref(s->frames);
+            s->frames = NULL;
+            return;
+        }
+    } else if (chr) {
+        s->chr_frame[0] = g_malloc(s->frame_size);
+        s->chr_frame[1] = g_malloc(s->frame_size);
+        qemu_chr_fe_set_handlers(&s->chr, max78000_pcif_can_receive,
+                                 max78000_pcif_receive, NULL, NULL,
+                                 s, NULL, true);
+    }
+
+    s->vsync_timer = timer_new_ns(QEMU_CLOCK_VIRTUAL, max78000_pcif_vsync, s);
+}
+
+static void max78000_pcif_class_init(ObjectClass *klass, const void *data)
+{
+    ResettableClass *rc = RESETTABLE_CLASS(klass);
+    DeviceClass *dc = DEVICE_CLASS(klass);
+
+    rc->phases.hold = max78000_pcif_reset_hold;
+    rc->phases.exit = max78000_pcif_reset_exit;
+    device_class_set_props(dc, max78000_pcif_properties);
+    dc->realize = max78000_pcif_realize;
+    dc->vmsd = &vmstate_max78000_pcif;
+}
+
+static const TypeInfo max78000_pcif_info = {
+    .name          = TYPE_MAX78000_PCIF,
+    .parent        = TYPE_SYS_BUS_DEVICE,
+    .instance_size = sizeof(Max78000PcifState),
+    .instance_init = max78000_pcif_init,
+    .class_init    = max78000_pcif_class_init,
+};
+
+static void max78000_pcif_register_types(void)
+{
+    type_register_static(&max78000_pcif_info);
+}
+
+type_init(max78000_pcif_register_types)
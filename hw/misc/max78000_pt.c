@@ -0,0 +1,457 @@
+/*
+ * MAX78000 Pulse Train Engine
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Four pulse trains, each shifting out a 2-32 bit pattern (LSB first)
+ * or a square wave, one bit per RATE PCLK cycles, for a number of loops
+ * with an optional delay between them.
+ *
+ * The output pins are not modeled. Instead, whenever a pulse train
+ * starts, its whole waveform is described by one run-length record on
+ * the "chardev" backend and the max78000_pt_record trace event:
+ *
+ *   pt<n> <start ns> <unit ns> <loops> <first level> <run> [<run>...]
+ *
+ * The runs are lengths in units, alternating in level from the first
+ * one, and the sequence repeats <loops> times, or until the next record
+ * for the same pulse train if <loops> is 0. When a pulse train stops,
+ * "pt<n> <time ns> stop" follows. The only timer is the one that ends
+ * trains with a finite loop count, so a fast pulse train costs no more
+ * to emulate than a slow one.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/log.h"
+#include "qemu/timer.h"
+#include "qapi/error.h"
+#include "trace.h"
+#include "hw/irq.h"
+#include "hw/qdev-clock.h"
+#include "hw/qdev-properties.h"
+#include "hw/qdev-properties-system.h"
+#include "migration/vmstate.h"
+#include "hw/misc/max78000_pt.h"
+
+static void max78000_pt_update_irq(Max78000PtState *s)
+{
+    qemu_set_irq(s->irq, s->intfl & s->inten);
+}
+
+static bool max78000_pt_recording(Max78000PtState *s)
+{
+    return qemu_chr_fe_backend_connected(&s->chr) ||
+           trace_event_get_state_backends(TRACE_MAX78000_PT_RECORD);
+}
+
+static void max78000_pt_emit(Max78000PtState *s, GString *rec)
+{
+    trace_max78000_pt_record(rec->str);
+    g_string_append_c(rec, '\n');
+    qemu_chr_fe_write_all(&s->chr, (const uint8_t *)rec->str, rec->len);
+}
+
+/* The pattern length in bits; a square wave is one high and one low bit */
+static unsigned max78000_pt_length(Max78000PtChannel *ch)
+{
+    unsigned mode = ch->rate_length >> PT_MODE_SHIFT;
+
+    switch (mode) {
+    case PT_MODE_32BIT:
+        return 32;
+    case PT_MODE_SQUARE:
+        return 2;
+    default:
+        return mode;
+    }
+}
+
+static bool max78000_pt_bit(Max78000PtChannel *ch, unsigned i)
+{
+    if ((ch->rate_length >> PT_MODE_SHIFT) == PT_MODE_SQUARE) {
+        return i == 0;
+    }
+    return extract32(ch->train, i, 1);
+}
+
+static unsigned max78000_pt_delay(Max78000PtChannel *ch)
+{
+    return (ch->loop >> PT_LOOP_DELAY_SHIFT) & PT_LOOP_DELAY_MASK;
+}
+
+static void max78000_pt_record_start(Max78000PtState *s, int n, int64_t now,
+                                     int64_t unit_ns)
+{
+    Max78000PtChannel *ch = &s->ch[n];
+    g_autoptr(GString) rec = g_string_new(NULL);
+    bool level = max78000_pt_bit(ch, 0);
+    unsigned run = 0;
+    unsigned i;
+
+    g_string_printf(rec, "pt%d %" PRId64 " %" PRId64 " %u %d",
+                    n, now, unit_ns, ch->loop & PT_LOOP_COUNT_MASK, level);
+    for (i = 0; i < max78000_pt_length(ch); i++) {
+        if (max78000_pt_bit(ch, i) != level) {
+            g_string_append_printf(rec, " %u", run);
+            level = !level;
+            run = 0;
+        }
+        run++;
+    }
+    /* The output holds its last level through the delay */
+    g_string_append_printf(rec, " %u", run + max78000_pt_delay(ch));
+    max78000_pt_emit(s, rec);
+}
+
+static void max78000_pt_start(Max78000PtState *s, int n, int64_t now)
+{
+    Max78000PtChannel *ch = &s->ch[n];
+    int64_t unit_ns = clock_ticks_to_ns(s->clk,
+                                        ch->rate_length & PT_RATE_MASK);
+    uint64_t loops = ch->loop & PT_LOOP_COUNT_MASK;
+    uint64_t units = max78000_pt_length(ch) + max78000_pt_delay(ch);
+
+    trace_max78000_pt_start(n, unit_ns, loops);
+    if (max78000_pt_recording(s)) {
+        max78000_pt_record_start(s, n, now, unit_ns);
+    }
+    ch->end_ns = loops ? now + MIN(loops * units * unit_ns, INT64_MAX / 2) :
+                 INT64_MAX;
+}
+
+static void max78000_pt_stop(Max78000PtState *s, int n, int64_t now)
+{
+    g_autoptr(GString) rec = NULL;
+
+    s->ch[n].end_ns = INT64_MAX;
+    if (max78000_pt_recording(s)) {
+        rec = g_string_new(NULL);
+        g_string_printf(rec, "pt%d %" PRId64 " stop", n, now);
+        max78000_pt_emit(s, rec);
+    }
+}
+
+/* A pulse train runs while it is enabled, clocked and has a rate */
+static bool max78000_pt_should_run(Max78000PtState *s, int n)
+{
+    return (s->enable & BIT(n)) && clock_is_enabled(s->clk) &&
+           (s->ch[n].rate_length & PT_RATE_MASK);
+}
+
+/*
+ * Start and stop pulse trains to match their enables; those in @restart
+ * that keep running start their waveform over. Then arm the timer for
+ * the first train to run out of loops.
+ */
+static void max78000_pt_update(Max78000PtState *s, uint32_t restart)
+{
+    int64_t now = qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
+    int64_t next = INT64_MAX;
+    bool run;
+    int n;
+
+    for (n = 0; n < PT_NUM_CHANNELS; n++) {
+        run = max78000_pt_should_run(s, n);
+        if (run && ((restart & BIT(n)) || !(s->running & BIT(n)))) {
+            max78000_pt_start(s, n, now);
+        } else if (!run && (s->running & BIT(n))) {
+            max78000_pt_stop(s, n, now);
+        }
+        s->running = deposit32(s->running, n, 1, run);
+        if (run) {
+            next = MIN(next, s->ch[n].end_ns);
+        }
+    }
+
+    if (!s->timer) {
+        return;
+    }
+    if (next == INT64_MAX) {
+        timer_del(s->timer);
+    } else {
+        timer_mod(s->timer, next);
+    }
+}
+
+static void max78000_pt_expire(void *opaque)
+{
+    Max78000PtState *s = opaque;
+    int64_t now = qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
+    uint32_t restart = 0;
+    uint32_t sel;
+    int n, m;
+
+    for (n = 0; n < PT_NUM_CHANNELS; n++) {
+        if (!(s->running & BIT(n)) || s->ch[n].end_ns > now) {
+            continue;
+        }
+        s->enable &= ~BIT(n);
+        s->intfl |= BIT(n);
+
+        /* Start the pulse trains that are set to follow this one */
+        for (m = 0; m < PT_NUM_CHANNELS; m++) {
+            sel = (s->ch[m].restart >> PT_RESTART_X_SHIFT) &
+                  PT_RESTART_SEL_MASK;
+            if ((s->ch[m].restart & PT_RESTART_X_EXIT) && sel == n) {
+                restart |= BIT(m);
+            }
+            sel = (s->ch[m].restart >> PT_RESTART_Y_SHIFT) &
+                  PT_RESTART_SEL_MASK;
+            if ((s->ch[m].restart & PT_RESTART_Y_EXIT) && sel == n) {
+                restart |= BIT(m);
+            }
+        }
+    }
+
+    s->enable |= restart;
+    max78000_pt_update(s, restart);
+    max78000_pt_update_irq(s);
+}
+
+static uint64_t max78000_pt_read(void *opaque, hwaddr addr,
+                                 unsigned int size)
+{
+    Max78000PtState *s = opaque;
+    Max78000PtChannel *ch;
+
+    switch (addr) {
+    case PTG_ENABLE:
+        return s->enable;
+
+    case PTG_RESYNC:
+    case PTG_SAFE_EN:
+    case PTG_SAFE_DIS:
+        return 0;
+
+    case PTG_INTFL:
+        return s->intfl;
+
+    case PTG_INTEN:
+        return s->inten;
+
+    case PT_BASE ... PT_BASE + PT_NUM_CHANNELS * PT_STRIDE - 1:
+        ch = &s->ch[(addr - PT_BASE) / PT_STRIDE];
+        switch ((addr - PT_BASE) % PT_STRIDE) {
+        case PT_RATE_LENGTH:
+            return ch->rate_length;
+        case PT_TRAIN:
+            return ch->train;
+        case PT_LOOP:
+            return ch->loop;
+        case PT_RESTART:
+            return ch->restart;
+        }
+        /* fall through */
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        return 0;
+    }
+}
+
+static void max78000_pt_write(void *opaque, hwaddr addr,
+                              uint64_t val64, unsigned int size)
+{
+    Max78000PtState *s = opaque;
+    uint32_t val = val64;
+    uint32_t mask = MAKE_64BIT_MASK(0, PT_NUM_CHANNELS);
+    Max78000PtChannel *ch;
+    int n;
+
+    switch (addr) {
+    case PTG_ENABLE:
+        s->enable = val & mask;
+        max78000_pt_update(s, 0);
+        break;
+
+    case PTG_RESYNC:
+        max78000_pt_update(s, val & mask);
+        break;
+
+    case PTG_INTFL:
+        s->intfl &= ~val;
+        max78000_pt_update_irq(s);
+        break;
+
+    case PTG_INTEN:
+        s->inten = val & mask;
+        max78000_pt_update_irq(s);
+        break;
+
+    case PTG_SAFE_EN:
+        s->enable |= val & mask;
+        max78000_pt_update(s, 0);
+        break;
+
+    case PTG_SAFE_DIS:
+        s->enable &= ~val;
+        max78000_pt_update(s, 0);
+        break;
+
+    case PT_BASE ... PT_BASE + PT_NUM_CHANNELS * PT_STRIDE - 1:
+        n = (addr - PT_BASE) / PT_STRIDE;
+        ch = &s->ch[n];
+        switch ((addr - PT_BASE) % PT_STRIDE) {
+        case PT_RATE_LENGTH:
+            ch->rate_length = val;
+            break;
+        case PT_TRAIN:
+            ch->train = val;
+            break;
+        case PT_LOOP:
+            ch->loop = val;
+            break;
+        case PT_RESTART:
+            ch->restart = val;
+            return;
+        default:
+            qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+                HWADDR_PRIx "\n", __func__, addr);
+            return;
+        }
+        /* A running pulse train starts over with its new waveform */
+        max78000_pt_update(s, BIT(n));
+        break;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        break;
+    }
+}
+
+/* The pulse trains stop while PCLK is gated, and start over after */
+static void max78000_pt_clk_update(void *opaque, ClockEvent event)
+{
+    Max78000PtState *s = opaque;
+
+    max78000_pt_update(s, 0);
+}
+
+static void max78000_pt_reset_hold(Object *obj, ResetType type)
+{
+    Max78000PtState *s = MAX78000_PT(obj);
+    int n;
+
+    s->enable = 0;
+    s->intfl = 0;
+    s->inten = 0;
+    for (n = 0; n < PT_NUM_CHANNELS; n++) {
+        s->ch[n].rate_length = 0;
+        s->ch[n].train = 0;
+        s->ch[n].loop = 0;
+        s->ch[n].restart = 0;
+    }
+    max78000_pt_update(s, 0);
+}
+
+static void max78000_pt_reset_exit(Object *obj, ResetType type)
+{
+    Max78000PtState *s = MAX78000_PT(obj);
+
+    max78000_pt_update_irq(s);
+}
+
+static const MemoryRegionOps max78000_pt_ops = {
+    .read = max78000_pt_read,
+    .write = max78000_pt_write,
+    .endianness = DEVICE_LITTLE_ENDIAN,
+    .valid.min_access_size = 4,
+    .valid.max_access_size = 4,
+};
+
+static const Property max78000_pt_properties[] = {
+    DEFINE_PROP_CHR("chardev", Max78000PtState, chr),
+};
+
+static const VMStateDescription vmstate_max78000_pt_channel = {
+    .name = TYPE_MAX78000_PT "-channel",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(rate_length, Max78000PtChannel),
+        VMSTATE_UINT32(train, Max78000PtChannel),
+        VMSTATE_UINT32(loop, Max78000PtChannel),
+        VMSTATE_UINT32(restart, Max78000PtChannel),
+        VMSTATE_INT64(end_ns, Max78000PtChannel),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static const VMStateDescription vmstate_max78000_pt = {
+    .name = TYPE_MAX78000_PT,
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(enable, Max78000PtState),
+        VMSTATE_UINT32(intfl, Max78000PtState),
+        VMSTATE_UINT32(inten, Max78000PtState),
+        VMSTATE_STRUCT_ARRAY(ch, Max78000PtState, PT_NUM_CHANNELS, 1,
+                             vmstate_max78000_pt_channel, Max78000PtChannel),
+        VMSTATE_UINT32(running, Max78000PtState),
+        VMSTATE_TIMER_PTR(timer, Max78000PtState),
+        VMSTATE_CLOCK(clk, Max78000PtState),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static void max78000_pt_init(Object *obj)
+{
+    Max78000PtState *s = MAX78000_PT(obj);
+    int n;
+
+    sysbus_init_irq(SYS_BUS_DEVICE(obj), &s->irq);
+
+    memory_region_init_io(&s->mmio, obj, &max78000_pt_ops, s,
+                          TYPE_MAX78000_PT, 0xa0);
+    sysbus_init_mmio(SYS_BUS_DEVICE(obj), &s->mmio);
+
+    s->clk = qdev_init_clock_in(DEVICE(obj), "clk", max78000_pt_clk_update,
+                                s, ClockUpdate);
+
+    for (n = 0; n < PT_NUM_CHANNELS; n++) {
+        s->ch[n].end_ns = INT64_MAX;
+    }
+}
+
+static void max78000_pt_realize(DeviceState *dev, Error **errp)
+{
+    Max78000PtState *s = MAX78000_PT(dev);
+
+    if (!clock_has_source(s->clk)) {
+        error_setg(errp, "MAX78000 PT: clk must be connected");
+        return;
+    }
+
+    s->timer = timer_new_ns(QEMU_CLOCK_VIRTUAL, max78000_pt_expire, s);
+}
+
+static void max78000_pt_class_init(ObjectClass *klass, const void *data)
+{
+    ResettableClass *rc = RESETTABLE_CLASS(klass);
+    DeviceClass *dc = DEVICE_CLASS(klass);
+
+    rc->phases.hold = max78000_pt_reset_hold;
+    rc->phases.exit = max78000_pt_reset_exit;
+    dc->realize = max78000_pt_realize;
+    dc->vmsd = &vmstate_max78000_pt;
+    device_class_set_props(dc, max78000_pt_properties);
+}
+
+static const TypeInfo max78000_pt_info = {
+    .name          = TYPE_MAX78000_PT,
+    .parent        = TYPE_SYS_BUS_DEVICE,
+    .instance_size = sizeof(Max78000PtState),
+    .instance_init = max78000_pt_init,
+    .class_init    = max78000_pt_class_init,
+};
+
+static void max78000_pt_register_types(void)
+{
+    type_register_static(&max78000_pt_info);
+}
+
+type_init(max78000_pt_register_types)
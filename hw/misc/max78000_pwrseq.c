@@ -0,0 +1,238 @@
+/*
+ * MAX78000 Power Sequencer
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * The power sequencer latches GPIO wakeup events. Its "wakeup" output
+ * feeds the GCR, which decides whether a wakeup ends a low power mode;
+ * the same level drives the GPIOWAKE interrupt.
+ * Memory shutdown and VDD power down controls are stored but have no
+ * effect.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/log.h"
+#include "trace.h"
+#include "hw/irq.h"
+#include "migration/vmstate.h"
+#include "hw/misc/max78000_pwrseq.h"
+
+static void max78000_pwrseq_update(Max78000PwrseqState *s)
+{
+    bool level = s->lppwkfl & s->lppwken;
+    int i;
+
+    for (i = 0; i < PWRSEQ_NUM_PORTS; i++) {
+        if (s->lpwkfl[i] & s->lpwken[i]) {
+            level = true;
+        }
+    }
+    qemu_set_irq(s->irq, level);
+    qemu_set_irq(s->wakeup, level);
+}
+
+static void max78000_pwrseq_gpio_wake(void *opaque, int n, int level)
+{
+    Max78000PwrseqState *s = opaque;
+    int port = n / PWRSEQ_PINS_PER_PORT;
+    uint32_t pin = 1u << (n % PWRSEQ_PINS_PER_PORT);
+
+    if (level && (s->lpwken[port] & pin)) {
+        s->lpwkfl[port] |= pin;
+        max78000_pwrseq_update(s);
+    }
+}
+
+static uint64_t max78000_pwrseq_read(void *opaque, hwaddr addr,
+                                     unsigned int size)
+{
+    Max78000PwrseqState *s = opaque;
+
+    switch (addr) {
+    case PWRSEQ_LPCTRL:
+        return s->lpctrl;
+
+    case PWRSEQ_LPWKFL0:
+    case PWRSEQ_LPWKFL1:
+    case PWRSEQ_LPWKFL2:
+    case PWRSEQ_LPWKFL3:
+        return s->lpwkfl[(addr - PWRSEQ_LPWKFL0) / 8];
+
+    case PWRSEQ_LPWKEN0:
+    case PWRSEQ_LPWKEN1:
+    case PWRSEQ_LPWKEN2:
+    case PWRSEQ_LPWKEN3:
+        return s->lpwken[(addr - PWRSEQ_LPWKEN0) / 8];
+
+    case PWRSEQ_LPPWKFL:
+        return s->lppwkfl;
+
+    case PWRSEQ_LPPWKEN:
+        return s->lppwken;
+
+    case PWRSEQ_LPMEMSD:
+        return s->lpmemsd;
+
+    case PWRSEQ_LPVDDPD:
+        return s->lpvddpd;
+
+    case PWRSEQ_GP0:
+        return s->gp0;
+
+    case PWRSEQ_GP1:
+        return s->gp1;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        return 0;
+    }
+}
+
+static void max78000_pwrseq_write(void *opaque, hwaddr addr,
+                                  uint64_t val64, unsigned int size)
+{
+    Max78000PwrseqState *s = opaque;
+    uint32_t val = val64;
+
+    switch (addr) {
+    case PWRSEQ_LPCTRL:
+        s->lpctrl = val;
+        break;
+
+    case PWRSEQ_LPWKFL0:
+    case PWRSEQ_LPWKFL1:
+    case PWRSEQ_LPWKFL2:
+    case PWRSEQ_LPWKFL3:
+        s->lpwkfl[(addr - PWRSEQ_LPWKFL0) / 8] &= ~val;
+        break;
+
+    case PWRSEQ_LPWKEN0:
+    case PWRSEQ_LPWKEN1:
+    case PWRSEQ_LPWKEN2:
+    case PWRSEQ_LPWKEN3:
+        s->lpwken[(addr - PWRSEQ_LPWKEN0) / 8] = val;
+        break;
+
+    case PWRSEQ_LPPWKFL:
+        s->lppwkfl &= ~val;
+        break;
+
+    case PWRSEQ_LPPWKEN:
+        s->lppwken = val;
+        break;
+
+    case PWRSEQ_LPMEMSD:
+        s->lpmemsd = val;
+        break;
+
+    case PWRSEQ_LPVDDPD:
+        s->lpvddpd = val;
+        break;
+
+    case PWRSEQ_GP0:
+        s->gp0 = val;
+        break;
+
+    case PWRSEQ_GP1:
+        s->gp1 = val;
+        break;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        return;
+    }
+
+    max78000_pwrseq_update(s);
+}
+
+static void max78000_pwrseq_reset_hold(Object *obj, ResetType type)
+{
+    Max78000PwrseqState *s = MAX78000_PWRSEQ(obj);
+
+    s->lpctrl = 0;
+    memset(s->lpwkfl, 0, sizeof(s->lpwkfl));
+    memset(s->lpwken, 0, sizeof(s->lpwken));
+    s->lppwkfl = 0;
+    s->lppwken = 0;
+    s->lpmemsd = 0;
+    s->lpvddpd = 0;
+    s->gp0 = 0;
+    s->gp1 = 0;
+}
+
+static void max78000_pwrseq_reset_exit(Object *obj, ResetType type)
+{
+    Max78000PwrseqState *s = MAX78000_PWRSEQ(obj);
+
+    max78000_pwrseq_update(s);
+}
+
+static const MemoryRegionOps max78000_pwrseq_ops = {
+    .read = max78000_pwrseq_read,
+    .write = max78000_pwrseq_write,
+    .endianness = DEVICE_LITTLE_ENDIAN,
+    .valid.min_access_size = 4,
+    .valid.max_access_size = 4,
+};
+
+static const VMStateDescription vmstate_max78000_pwrseq = {
+    .name = TYPE_MAX78000_PWRSEQ,
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(lpctrl, Max78000PwrseqState),
+        VMSTATE_UINT32_ARRAY(lpwkfl, Max78000PwrseqState, PWRSEQ_NUM_PORTS),
+        VMSTATE_UINT32_ARRAY(lpwken, Max78000PwrseqState, PWRSEQ_NUM_PORTS),
+        VMSTATE_UINT32(lppwkfl, Max78000PwrseqState),
+        VMSTATE_UINT32(lppwken, Max78000PwrseqState),
+        VMSTATE_UINT32(lpmemsd, Max78000PwrseqState),
+        VMSTATE_UINT32(lpvddpd, Max78000PwrseqState),
+        VMSTATE_UINT32(gp0, Max78000PwrseqState),
+        VMSTATE_UINT32(gp1, Max78000PwrseqState),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static void max78000_pwrseq_init(Object *obj)
+{
+    Max78000PwrseqState *s = MAX78000_PWRSEQ(obj);
+
+    sysbus_init_irq(SYS_BUS_DEVICE(obj), &s->irq);
+    qdev_init_gpio_in_named(DEVICE(obj), max78000_pwrseq_gpio_wake,
+                            "gpio-wake",
+                            PWRSEQ_NUM_PORTS * PWRSEQ_PINS_PER_PORT);
+    qdev_init_gpio_out_named(DEVICE(obj), &s->wakeup, "wakeup", 1);
+
+    memory_region_init_io(&s->mmio, obj, &max78000_pwrseq_ops, s,
+                          TYPE_MAX78000_PWRSEQ, 0x400);
+    sysbus_init_mmio(SYS_BUS_DEVICE(obj), &s->mmio);
+}
+
+static void max78000_pwrseq_class_init(ObjectClass *klass, const void *data)
+{
+    ResettableClass *rc = RESETTABLE_CLASS(klass);
+    DeviceClass *dc = DEVICE_CLASS(klass);
+
+    rc->phases.hold = max78000_pwrseq_reset_hold;
+    rc->phases.exit = max78000_pwrseq_reset_exit;
+    dc->vmsd = &vmstate_max78000_pwrseq;
+}
+
+static const TypeInfo max78000_pwrseq_info = {
+    .name          = TYPE_MAX78000_PWRSEQ,
+    .parent        = TYPE_SYS_BUS_DEVICE,
+    .instance_size = sizeof(Max78000PwrseqState),
+    .instance_init = max78000_pwrseq_init,
+    .class_init    = max78000_pwrseq_class_init,
+};
+
+static void max78000_pwrseq_register_types(void)
+{
+    type_register_static(&max78000_pwrseq_info);
+}
+
+type_init(max78000_pwrseq_register_types)
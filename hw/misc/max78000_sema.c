@@ -0,0 +1,222 @@
+/*
+ * MAX78000 Semaphores
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Eight hardware semaphores: reading one returns its previous value
+ * and sets it, writing 0 releases it. MMIO is dispatched with the BQL
+ * held, so the read-and-set is atomic with respect to every vCPU and
+ * to DMA even under MTTCG.
+ *
+ * IRQ0 and MAIL0 carry messages to the Cortex-M4, IRQ1 and MAIL1 to
+ * the RISC-V core. Only the Cortex-M4 side is wired to an interrupt.
+ *
+ * The max78000_sema_* trace events report failed acquisitions and, on
+ * release, how long a semaphore was held and how many attempts to take
+ * it failed in the meantime.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/log.h"
+#include "qemu/timer.h"
+#include "trace.h"
+#include "hw/irq.h"
+#include "migration/vmstate.h"
+#include "hw/misc/max78000_sema.h"
+
+static void max78000_sema_update_irq(Max78000SemaState *s)
+{
+    qemu_set_irq(s->irq, (s->irq0 & (SEMA_IRQ_EN | SEMA_IRQ_PEND)) ==
+                         (SEMA_IRQ_EN | SEMA_IRQ_PEND));
+}
+
+static uint32_t max78000_sema_take(Max78000SemaState *s, int n)
+{
+    uint32_t taken = extract32(s->sema, n, 1);
+
+    if (taken) {
+        s->spins[n]++;
+        trace_max78000_sema_busy(n, s->spins[n]);
+    } else {
+        s->sema |= BIT(n);
+        s->taken_at[n] = qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
+        s->spins[n] = 0;
+        trace_max78000_sema_take(n);
+    }
+    return taken;
+}
+
+static void max78000_sema_give(Max78000SemaState *s, int n)
+{
+    if (!extract32(s->sema, n, 1)) {
+        return;
+    }
+    s->sema &= ~BIT(n);
+    trace_max78000_sema_give(n, qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL) -
+                             s->taken_at[n], s->spins[n]);
+}
+
+static uint64_t max78000_sema_read(void *opaque, hwaddr addr,
+                                   unsigned int size)
+{
+    Max78000SemaState *s = opaque;
+
+    switch (addr) {
+    case SEMA_SEMAPHORES ... SEMA_SEMAPHORES + 4 * SEMA_NUM - 1:
+        if (addr & 3) {
+            break;
+        }
+        return max78000_sema_take(s, addr / 4);
+
+    case SEMA_IRQ0:
+        return s->irq0;
+
+    case SEMA_MAIL0:
+        return s->mail0;
+
+    case SEMA_IRQ1:
+        return s->irq1;
+
+    case SEMA_MAIL1:
+        return s->mail1;
+
+    case SEMA_STATUS:
+        return s->sema;
+
+    default:
+        break;
+    }
+
+    qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+        HWADDR_PRIx "\n", __func__, addr);
+    return 0;
+}
+
+static void max78000_sema_write(void *opaque, hwaddr addr,
+                                uint64_t val64, unsigned int size)
+{
+    Max78000SemaState *s = opaque;
+    uint32_t val = val64;
+
+    switch (addr) {
+    case SEMA_SEMAPHORES ... SEMA_SEMAPHORES + 4 * SEMA_NUM - 1:
+        if (addr & 3) {
+            goto bad_offset;
+        }
+        if (!(val & 1)) {
+            max78000_sema_give(s, addr / 4);
+        }
+        break;
+
+    case SEMA_IRQ0:
+        s->irq0 = val & (SEMA_IRQ_EN | SEMA_IRQ_PEND);
+        break;
+
+    case SEMA_MAIL0:
+        s->mail0 = val;
+        break;
+
+    case SEMA_IRQ1:
+        s->irq1 = val & (SEMA_IRQ_EN | SEMA_IRQ_PEND);
+        if ((s->irq1 & (SEMA_IRQ_EN | SEMA_IRQ_PEND)) ==
+            (SEMA_IRQ_EN | SEMA_IRQ_PEND)) {
+            qemu_log_mask(LOG_UNIMP, "%s: the RISC-V core is not modeled\n",
+                          __func__);
+        }
+        break;
+
+    case SEMA_MAIL1:
+        s->mail1 = val;
+        break;
+
+    case SEMA_STATUS:
+        break;
+
+    default:
+    bad_offset:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        return;
+    }
+
+    max78000_sema_update_irq(s);
+}
+
+static void max78000_sema_reset_hold(Object *obj, ResetType type)
+{
+    Max78000SemaState *s = MAX78000_SEMA(obj);
+
+    s->sema = 0;
+    s->irq0 = 0;
+    s->mail0 = 0;
+    s->irq1 = 0;
+    s->mail1 = 0;
+    memset(s->spins, 0, sizeof(s->spins));
+}
+
+static void max78000_sema_reset_exit(Object *obj, ResetType type)
+{
+    Max78000SemaState *s = MAX78000_SEMA(obj);
+
+    max78000_sema_update_irq(s);
+}
+
+static const MemoryRegionOps max78000_sema_ops = {
+    .read = max78000_sema_read,
+    .write = max78000_sema_write,
+    .endianness = DEVICE_LITTLE_ENDIAN,
+    .valid.min_access_size = 4,
+    .valid.max_access_size = 4,
+};
+
+static const VMStateDescription vmstate_max78000_sema = {
+    .name = TYPE_MAX78000_SEMA,
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(sema, Max78000SemaState),
+        VMSTATE_UINT32(irq0, Max78000SemaState),
+        VMSTATE_UINT32(mail0, Max78000SemaState),
+        VMSTATE_UINT32(irq1, Max78000SemaState),
+        VMSTATE_UINT32(mail1, Max78000SemaState),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static void max78000_sema_init(Object *obj)
+{
+    Max78000SemaState *s = MAX78000_SEMA(obj);
+
+    sysbus_init_irq(SYS_BUS_DEVICE(obj), &s->irq);
+
+    memory_region_init_io(&s->mmio, obj, &max78000_sema_ops, s,
+                          TYPE_MAX78000_SEMA, 0x1000);
+    sysbus_init_mmio(SYS_BUS_DEVICE(obj), &s->mmio);
+}
+
+static void max78000_sema_class_init(ObjectClass *klass, const void *data)
+{
+    ResettableClass *rc = RESETTABLE_CLASS(klass);
+    DeviceClass *dc = DEVICE_CLASS(klass);
+
+    rc->phases.hold = max78000_sema_reset_hold;
+    rc->phases.exit = max78000_sema_reset_exit;
+    dc->vmsd = &vmstate_max78000_sema;
+}
+
+static const TypeInfo max78000_sema_info = {
+    .name          = TYPE_MAX78000_SEMA,
+    .parent        = TYPE_SYS_BUS_DEVICE,
+    .instance_size = sizeof(Max78000SemaState),
+    .instance_init = max78000_sema_init,
+    .class_init    = max78000_sema_class_init,
+};
+
+static void max78000_sema_register_types(void)
+{
+    type_register_static(&max78000_sema_info);
+}
+
+type_init(max78000_sema_register_types)
@@ -8,11 +8,70 @@
 
 #include "qemu/osdep.h"
 #include "qemu/log.h"
+#include "qapi/error.h"
 #include "trace.h"
 #include "hw/irq.h"
+#include "hw/qdev-properties.h"
+#include "hw/qdev-clock.h"
 #include "migration/vmstate.h"
 #include "hw/misc/max78000_trng.h"
 #include "qemu/guest-random.h"
+#include "system/replay.h"
+
+/*
+ * Fetching entropy can cost a syscall on the host, so rather than going
+ * to qemu_guest_getrandom for every word the pool is refilled in one
+ * go once it runs dry. Refills only ever happen from a guest access,
+ * never from reset, so they stay on the vCPU thread: with -seed the
+ * pool sees the same deterministic stream, and record/replay logs one
+ * event per refill at the same point in both runs.
+ */
+static void max78000_trng_get(Max78000TrngState *s, void *buf, size_t len)
+{
+    uint8_t *out = buf;
+    size_t n;
+
+    while (len) {
+        if (s->pool_pos == TRNG_POOL_SIZE) {
+            qemu_guest_getrandom_nofail(s->pool, sizeof(s->pool));
+            s->pool_pos = 0;
+        }
+        n = MIN(len, TRNG_POOL_SIZE - s->pool_pos);
+        memcpy(out, &s->pool[s->pool_pos], n);
+        s->pool_pos += n;
+        out += n;
+        len -= n;
+    }
+}
+
+/*
+ * This device models random number generation as taking 0 time, so
+ * while it is clocked a new number is always ready and the RND
+ * interrupt condition always holds. With its clock gated nothing is
+ * generated at all.
+ */
+static void max78000_trng_update_irq(Max78000TrngState *s)
+{
+    qemu_set_irq(s->irq, clock_is_enabled(s->clk) && (s->ctrl & RND_IE));
+}
+
+static void max78000_trng_clk_update(void *opaque, ClockEvent event)
+{
+    max78000_trng_update_irq(opaque);
+}
+
+static void max78000_trng_keygen(Max78000TrngState *s)
+{
+    uint8_t key[sizeof(s->aes->key)];
+
+    if (!s->aes) {
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: no AES engine attached\n",
+                      __func__);
+        return;
+    }
+    max78000_trng_get(s, key, sizeof(key));
+    max78000_aes_set_key(s->aes, key);
+}
 
 static uint64_t max78000_trng_read(void *opaque, hwaddr addr,
                                     unsigned int size)
@@ -25,16 +84,19 @@ static uint64_t max78000_trng_read(void *opaque, hwaddr addr,
         return s->ctrl;
 
     case STATUS:
-        return 1;
+        return clock_is_enabled(s->clk) ? TRNG_RDY : 0;
 
     case DATA:
         /*
          * When interrupts are enabled, reading random data should cause a
          * new interrupt to be generated; since there's always a random number
-         * available, we could qemu_set_irq(s->irq, s->ctrl & RND_IE). Because
-         * of how trng_write is set up, this is always a noop, so don't
+         * available, the interrupt line simply stays asserted.
          */
-        qemu_guest_getrandom_nofail(&data, sizeof(data));
+        if (!clock_is_enabled(s->clk)) {
+            return 0;
+        }
+        max78000_trng_get(s, &data, sizeof(data));
+        s->data = data;
         return data;
 
     default:
@@ -52,19 +114,22 @@ static void max78000_trng_write(void *opaque, hwaddr addr,
     uint32_t val = val64;
     switch (addr) {
     case CTRL:
-        /* TODO: implement AES keygen */
-        s->ctrl = val;
-
         /*
-         * This device models random number generation as taking 0 time.
-         * A new random number is always available, so the condition for the
-         * RND interrupt is always fulfilled; we can just set irq to 1.
+         * Key generation and wiping write straight into the AES key
+         * registers and complete immediately, so neither bit stays set.
+         * Without a clock neither happens.
          */
-        if (val & RND_IE) {
-            qemu_set_irq(s->irq, 1);
-        } else{
-            qemu_set_irq(s->irq, 0);
+        if (clock_is_enabled(s->clk)) {
+            if (val & TRNG_KEYWIPE) {
+                if (s->aes) {
+                    max78000_aes_set_key(s->aes, NULL);
+                }
+            } else if (val & TRNG_KEYGEN) {
+                max78000_trng_keygen(s);
+            }
         }
+        s->ctrl = val & ~(TRNG_KEYGEN | TRNG_KEYWIPE);
+        max78000_trng_update_irq(s);
         break;
 
     default:
@@ -80,6 +145,35 @@ static void max78000_trng_reset_hold(Object *obj, ResetType type)
     s->ctrl = 0;
     s->status = 0;
     s->data = 0;
+
+    /* Leave the pool empty; it is refilled on the first guest access */
+    s->pool_pos = TRNG_POOL_SIZE;
+}
+
+static void max78000_trng_reset_exit(Object *obj, ResetType type)
+{
+    Max78000TrngState *s = MAX78000_TRNG(obj);
+
+    max78000_trng_update_irq(s);
+}
+
+static int max78000_trng_post_load(void *opaque, int version_id)
+{
+    Max78000TrngState *s = opaque;
+
+    if (s->pool_pos > TRNG_POOL_SIZE) {
+        return -EINVAL;
+    }
+
+    /*
+     * Every restore of the same snapshot would otherwise hand the guest
+     * the same leftover entropy. Drop it so the next access refills the
+     * pool; a replay has to see the recorded pool, so it keeps it.
+     */
+    if (replay_mode == REPLAY_MODE_NONE) {
+        s->pool_pos = TRNG_POOL_SIZE;
+    }
+    return 0;
 }
 
 static const MemoryRegionOps max78000_trng_ops = {
@@ -92,16 +186,25 @@ static const MemoryRegionOps max78000_trng_ops = {
 
 static const VMStateDescription max78000_trng_vmstate = {
     .name = TYPE_MAX78000_TRNG,
-    .version_id = 1,
-    .minimum_version_id = 1,
+    .version_id = 3,
+    .minimum_version_id = 3,
+    .post_load = max78000_trng_post_load,
     .fields = (const VMStateField[]) {
         VMSTATE_UINT32(ctrl, Max78000TrngState),
         VMSTATE_UINT32(status, Max78000TrngState),
         VMSTATE_UINT32(data, Max78000TrngState),
+        VMSTATE_UINT8_ARRAY(pool, Max78000TrngState, TRNG_POOL_SIZE),
+        VMSTATE_UINT32(pool_pos, Max78000TrngState),
+        VMSTATE_CLOCK(clk, Max78000TrngState),
         VMSTATE_END_OF_LIST()
     }
 };
 
+static const Property max78000_trng_properties[] = {
+    DEFINE_PROP_LINK("aes", Max78000TrngState, aes,
+                     TYPE_MAX78000_AES, Max78000AesState *),
+};
+
 static void max78000_trng_init(Object *obj)
 {
     Max78000TrngState *s = MAX78000_TRNG(obj);
@@ -111,6 +214,17 @@ static void max78000_trng_init(Object *obj)
                         TYPE_MAX78000_TRNG, 0x1000);
     sysbus_init_mmio(SYS_BUS_DEVICE(obj), &s->mmio);
 
+    s->clk = qdev_init_clock_in(DEVICE(s), "clk", max78000_trng_clk_update, s,
+                                ClockUpdate);
+}
+
+static void max78000_trng_realize(DeviceState *dev, Error **errp)
+{
+    Max78000TrngState *s = MAX78000_TRNG(dev);
+
+    if (!clock_has_source(s->clk)) {
+        error_setg(errp, "MAX78000 TRNG: clk must be connected");
+    }
 }
 
 static void max78000_trng_class_init(ObjectClass *klass, const void *data)
@@ -119,7 +233,10 @@ static void max78000_trng_class_init(ObjectClass *klass, const void *data)
     DeviceClass *dc = DEVICE_CLASS(klass);
 
     rc->phases.hold = max78000_trng_reset_hold;
+    rc->phases.exit = max78000_trng_reset_exit;
+    dc->realize = max78000_trng_realize;
     dc->vmsd = &max78000_trng_vmstate;
+    device_class_set_props(dc, max78000_trng_properties);
 
 }
 
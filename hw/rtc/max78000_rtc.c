@@ -0,0 +1,454 @@
+/*
+ * MAX78000 Real Time Clock
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * A 32-bit seconds counter with a 12-bit sub-second counter, a
+ * time-of-day alarm on the low 20 bits of the seconds and a repeating
+ * sub-second alarm. The counters are computed from the rtc_clock
+ * ("-rtc clock=..."), or from the virtual clock when icount is enabled
+ * so that runs are repeatable, and start from the "-rtc base=..." date.
+ * Nothing is ticked: the timer is only armed for the next enabled alarm.
+ *
+ * Like the rest of the always-on domain, the counter keeps running
+ * through a system reset.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/log.h"
+#include "qemu/cutils.h"
+#include "exec/icount.h"
+#include "system/system.h"
+#include "system/rtc.h"
+#include "trace.h"
+#include "hw/irq.h"
+#include "migration/vmstate.h"
+#include "hw/rtc/max78000_rtc.h"
+
+static const uint32_t max78000_rtc_sqw_freq[] = { 1, 512, 4096, 32768 };
+
+static uint64_t max78000_rtc_ticks(Max78000RtcState *s)
+{
+    int64_t now = qemu_clock_get_ns(s->clock_type);
+
+    if (!(s->ctrl & RTC_CTRL_EN) || now <= s->base_ns) {
+        return s->base_ticks;
+    }
+    return s->base_ticks + muldiv64(now - s->base_ns, RTC_SSEC_FREQ,
+                                    NANOSECONDS_PER_SECOND);
+}
+
+/* The first tick after @after at which the time-of-day alarm matches */
+static uint64_t max78000_rtc_tod_next(Max78000RtcState *s, uint64_t after)
+{
+    uint64_t sec = (after >> RTC_SSEC_BITS) + 1;
+    uint64_t next = (sec & ~(uint64_t)RTC_TODA_MASK) | s->toda;
+
+    if (next < sec) {
+        next += RTC_TODA_MASK + 1;
+    }
+    return next << RTC_SSEC_BITS;
+}
+
+/* The first tick after @after at which the sub-second alarm fires */
+static uint64_t max78000_rtc_ssa_next(Max78000RtcState *s, uint64_t after)
+{
+    uint64_t interval = (1ULL << 32) - s->sseca;
+
+    if (after < s->ssa_start) {
+        return s->ssa_start + interval;
+    }
+    return s->ssa_start + ((after - s->ssa_start) / interval + 1) * interval;
+}
+
+static uint64_t max78000_rtc_next_alarm(Max78000RtcState *s)
+{
+    uint64_t next = UINT64_MAX;
+
+    if (s->ctrl & RTC_CTRL_TOD_ALARM_IE) {
+        next = max78000_rtc_tod_next(s, s->last_ticks);
+    }
+    if (s->ctrl & RTC_CTRL_SSEC_ALARM_IE) {
+        next = MIN(next, max78000_rtc_ssa_next(s, s->last_ticks));
+    }
+    return next;
+}
+
+static void max78000_rtc_update_irq(Max78000RtcState *s)
+{
+    bool level = ((s->ctrl & RTC_CTRL_TOD_ALARM) &&
+                  (s->ctrl & RTC_CTRL_TOD_ALARM_IE)) ||
+                 ((s->ctrl & RTC_CTRL_SSEC_ALARM) &&
+                  (s->ctrl & RTC_CTRL_SSEC_ALARM_IE));
+
+    qemu_set_irq(s->irq, level);
+    qemu_set_irq(s->wakeup, level);
+}
+
+/* Raise the flag of every enabled alarm that has passed since last time */
+static void max78000_rtc_advance(Max78000RtcState *s)
+{
+    uint64_t now = max78000_rtc_ticks(s);
+
+    if (now > s->last_ticks) {
+        if ((s->ctrl & RTC_CTRL_TOD_ALARM_IE) &&
+            max78000_rtc_tod_next(s, s->last_ticks) <= now) {
+            s->ctrl |= RTC_CTRL_TOD_ALARM;
+            trace_max78000_rtc_alarm("time-of-day", now >> RTC_SSEC_BITS);
+        }
+        if ((s->ctrl & RTC_CTRL_SSEC_ALARM_IE) &&
+            max78000_rtc_ssa_next(s, s->last_ticks) <= now) {
+            s->ctrl |= RTC_CTRL_SSEC_ALARM;
+            trace_max78000_rtc_alarm("sub-second", now >> RTC_SSEC_BITS);
+        }
+    }
+    s->last_ticks = now;
+}
+
+static void max78000_rtc_program(Max78000RtcState *s)
+{
+    uint64_t next = max78000_rtc_next_alarm(s);
+
+    if (!(s->ctrl & RTC_CTRL_EN) || next == UINT64_MAX) {
+        timer_del(s->alarm_timer);
+        return;
+    }
+    /* Rounded up, so that the alarm tick has been reached by then */
+    timer_mod(s->alarm_timer, s->base_ns +
+              muldiv64(next - s->base_ticks, NANOSECONDS_PER_SECOND,
+                       RTC_SSEC_FREQ) + 1);
+}
+
+static void max78000_rtc_alarm(void *opaque)
+{
+    Max78000RtcState *s = opaque;
+
+    max78000_rtc_advance(s);
+    max78000_rtc_program(s);
+    max78000_rtc_update_irq(s);
+}
+
+/*
+ * The square wave only has to be generated when something can see it:
+ * a device connected to the "sqw" output, or the trace event.
+ */
+static bool max78000_rtc_sqw_active(Max78000RtcState *s)
+{
+    return (s->ctrl & RTC_CTRL_EN) && (s->ctrl & RTC_CTRL_SQW_EN) &&
+           (s->sqw || trace_event_get_state_backends(TRACE_MAX78000_RTC_SQW));
+}
+
+static int64_t max78000_rtc_sqw_half_period(Max78000RtcState *s)
+{
+    uint32_t sel = (s->ctrl >> RTC_CTRL_SQW_SEL_SHIFT) &
+                   RTC_CTRL_SQW_SEL_MASK;
+
+    return NANOSECONDS_PER_SECOND / (2 * max78000_rtc_sqw_freq[sel]);
+}
+
+static void max78000_rtc_update_sqw(Max78000RtcState *s)
+{
+    if (max78000_rtc_sqw_active(s)) {
+        if (!timer_pending(s->sqw_timer)) {
+            timer_mod(s->sqw_timer, qemu_clock_get_ns(s->clock_type) +
+                      max78000_rtc_sqw_half_period(s));
+        }
+        return;
+    }
+
+    timer_del(s->sqw_timer);
+    if (s->sqw_level) {
+        s->sqw_level = false;
+        qemu_set_irq(s->sqw, 0);
+    }
+}
+
+static void max78000_rtc_sqw_toggle(void *opaque)
+{
+    Max78000RtcState *s = opaque;
+
+    s->sqw_level = !s->sqw_level;
+    trace_max78000_rtc_sqw(s->sqw_level);
+    qemu_set_irq(s->sqw, s->sqw_level);
+    max78000_rtc_update_sqw(s);
+}
+
+int64_t max78000_rtc_next_deadline(Max78000RtcState *s)
+{
+    uint64_t now, next;
+
+    if (!(s->ctrl & RTC_CTRL_EN)) {
+        return INT64_MAX;
+    }
+    now = max78000_rtc_ticks(s);
+    next = max78000_rtc_next_alarm(s);
+    if (next == UINT64_MAX) {
+        return INT64_MAX;
+    }
+    if (next <= now) {
+        return 0;
+    }
+    return muldiv64(next - now, NANOSECONDS_PER_SECOND, RTC_SSEC_FREQ);
+}
+
+void max78000_rtc_skip(Max78000RtcState *s, int64_t ns)
+{
+    uint64_t ticks;
+
+    if (!(s->ctrl & RTC_CTRL_EN)) {
+        return;
+    }
+    ticks = muldiv64(ns, RTC_SSEC_FREQ, NANOSECONDS_PER_SECOND);
+    if (!ticks) {
+        return;
+    }
+
+    trace_max78000_rtc_fast_forward(ticks >> RTC_SSEC_BITS);
+    s->base_ticks += ticks;
+    /* An alarm inside the skipped interval is flagged as it would have been */
+    max78000_rtc_advance(s);
+    max78000_rtc_program(s);
+    max78000_rtc_update_irq(s);
+}
+
+static uint64_t max78000_rtc_read(void *opaque, hwaddr addr,
+                                  unsigned int size)
+{
+    Max78000RtcState *s = opaque;
+
+    switch (addr) {
+    case RTC_SEC:
+        return max78000_rtc_ticks(s) >> RTC_SSEC_BITS;
+
+    case RTC_SSEC:
+        return max78000_rtc_ticks(s) & (RTC_SSEC_FREQ - 1);
+
+    case RTC_TODA:
+        return s->toda;
+
+    case RTC_SSECA:
+        return s->sseca;
+
+    case RTC_CTRL:
+        /* The counters can always be read, and writes never wait */
+        return s->ctrl | RTC_CTRL_RDY;
+
+    case RTC_TRIM:
+        return s->trim;
+
+    case RTC_OSCCTRL:
+        return s->oscctrl;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        return 0;
+    }
+}
+
+static void max78000_rtc_set_count(Max78000RtcState *s, uint64_t ticks)
+{
+    if (s->ctrl & RTC_CTRL_EN) {
+        qemu_log_mask(LOG_GUEST_ERROR,
+                      "%s: The counters can only be set while disabled\n",
+                      __func__);
+        return;
+    }
+    s->base_ticks = ticks;
+    s->last_ticks = ticks;
+    s->ssa_start = ticks;
+}
+
+static void max78000_rtc_write(void *opaque, hwaddr addr,
+                               uint64_t val64, unsigned int size)
+{
+    Max78000RtcState *s = opaque;
+    uint32_t val = val64;
+    uint32_t old;
+
+    max78000_rtc_advance(s);
+
+    switch (addr) {
+    case RTC_SEC:
+        max78000_rtc_set_count(s, deposit64(s->base_ticks, RTC_SSEC_BITS,
+                                            32, val));
+        break;
+
+    case RTC_SSEC:
+        max78000_rtc_set_count(s, deposit64(s->base_ticks, 0, RTC_SSEC_BITS,
+                                            val));
+        break;
+
+    case RTC_TODA:
+        s->toda = val & RTC_TODA_MASK;
+        break;
+
+    case RTC_SSECA:
+        s->sseca = val;
+        s->ssa_start = s->last_ticks;
+        break;
+
+    case RTC_CTRL:
+        old = s->ctrl;
+        if (((val ^ old) & RTC_CTRL_EN) && !(old & RTC_CTRL_WR_EN)) {
+            qemu_log_mask(LOG_GUEST_ERROR,
+                          "%s: EN can only be changed with WR_EN set\n",
+                          __func__);
+            val = (val & ~RTC_CTRL_EN) | (old & RTC_CTRL_EN);
+        }
+        if (val & RTC_CTRL_RDY_IE) {
+            qemu_log_mask(LOG_UNIMP, "%s: RDY interrupt not implemented\n",
+                          __func__);
+        }
+
+        if ((old & ~val) & RTC_CTRL_EN) {
+            s->base_ticks = s->last_ticks;
+        } else if ((val & ~old) & RTC_CTRL_EN) {
+            s->base_ns = qemu_clock_get_ns(s->clock_type);
+        }
+        if ((val & ~old) & RTC_CTRL_SSEC_ALARM_IE) {
+            s->ssa_start = s->last_ticks;
+        }
+        s->ctrl = (val & ~(RTC_CTRL_FLAGS | RTC_CTRL_BUSY | RTC_CTRL_RDY)) |
+                  (old & val & RTC_CTRL_FLAGS);
+        max78000_rtc_update_sqw(s);
+        break;
+
+    case RTC_TRIM:
+        s->trim = val;
+        break;
+
+    case RTC_OSCCTRL:
+        s->oscctrl = val;
+        break;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        break;
+    }
+
+    max78000_rtc_program(s);
+    max78000_rtc_update_irq(s);
+}
+
+/* The counter and its enable belong to the always-on domain */
+static void max78000_rtc_reset_hold(Object *obj, ResetType type)
+{
+    Max78000RtcState *s = MAX78000_RTC(obj);
+
+    s->ctrl &= RTC_CTRL_EN;
+    s->toda = 0;
+    s->sseca = 0;
+    s->trim = 0;
+    s->oscctrl = 0;
+    s->last_ticks = max78000_rtc_ticks(s);
+    s->ssa_start = s->last_ticks;
+    if (s->alarm_timer) {
+        timer_del(s->alarm_timer);
+        max78000_rtc_update_sqw(s);
+    }
+}
+
+static void max78000_rtc_reset_exit(Object *obj, ResetType type)
+{
+    Max78000RtcState *s = MAX78000_RTC(obj);
+
+    max78000_rtc_update_irq(s);
+}
+
+static int max78000_rtc_post_load(void *opaque, int version_id)
+{
+    Max78000RtcState *s = opaque;
+
+    max78000_rtc_program(s);
+    timer_del(s->sqw_timer);
+    max78000_rtc_update_sqw(s);
+    return 0;
+}
+
+static const MemoryRegionOps max78000_rtc_ops = {
+    .read = max78000_rtc_read,
+    .write = max78000_rtc_write,
+    .endianness = DEVICE_LITTLE_ENDIAN,
+    .valid.min_access_size = 4,
+    .valid.max_access_size = 4,
+};
+
+/* base_ns is migrated as is, like the PL031's offset from rtc_clock */
+static const VMStateDescription vmstate_max78000_rtc = {
+    .name = TYPE_MAX78000_RTC,
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .post_load = max78000_rtc_post_load,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(ctrl, Max78000RtcState),
+        VMSTATE_UINT32(toda, Max78000RtcState),
+        VMSTATE_UINT32(sseca, Max78000RtcState),
+        VMSTATE_UINT32(trim, Max78000RtcState),
+        VMSTATE_UINT32(oscctrl, Max78000RtcState),
+        VMSTATE_UINT64(base_ticks, Max78000RtcState),
+        VMSTATE_INT64(base_ns, Max78000RtcState),
+        VMSTATE_UINT64(last_ticks, Max78000RtcState),
+        VMSTATE_UINT64(ssa_start, Max78000RtcState),
+        VMSTATE_BOOL(sqw_level, Max78000RtcState),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static void max78000_rtc_init(Object *obj)
+{
+    Max78000RtcState *s = MAX78000_RTC(obj);
+
+    sysbus_init_irq(SYS_BUS_DEVICE(obj), &s->irq);
+    qdev_init_gpio_out_named(DEVICE(obj), &s->wakeup, "wakeup", 1);
+    qdev_init_gpio_out_named(DEVICE(obj), &s->sqw, "sqw", 1);
+
+    memory_region_init_io(&s->mmio, obj, &max78000_rtc_ops, s,
+                        TYPE_MAX78000_RTC, 0x400);
+    sysbus_init_mmio(SYS_BUS_DEVICE(obj), &s->mmio);
+}
+
+static void max78000_rtc_realize(DeviceState *dev, Error **errp)
+{
+    Max78000RtcState *s = MAX78000_RTC(dev);
+    struct tm tm;
+
+    s->clock_type = icount_enabled() ? QEMU_CLOCK_VIRTUAL : rtc_clock;
+    s->alarm_timer = timer_new_ns(s->clock_type, max78000_rtc_alarm, s);
+    s->sqw_timer = timer_new_ns(s->clock_type, max78000_rtc_sqw_toggle, s);
+
+    qemu_get_timedate(&tm, 0);
+    s->base_ticks = (uint64_t)mktimegm(&tm) << RTC_SSEC_BITS;
+    s->base_ns = qemu_clock_get_ns(s->clock_type);
+    s->last_ticks = s->base_ticks;
+    s->ssa_start = s->base_ticks;
+}
+
+static void max78000_rtc_class_init(ObjectClass *klass, const void *data)
+{
+    ResettableClass *rc = RESETTABLE_CLASS(klass);
+    DeviceClass *dc = DEVICE_CLASS(klass);
+
+    rc->phases.hold = max78000_rtc_reset_hold;
+    rc->phases.exit = max78000_rtc_reset_exit;
+    dc->realize = max78000_rtc_realize;
+    dc->vmsd = &vmstate_max78000_rtc;
+}
+
+static const TypeInfo max78000_rtc_info = {
+    .name          = TYPE_MAX78000_RTC,
+    .parent        = TYPE_SYS_BUS_DEVICE,
+    .instance_size = sizeof(Max78000RtcState),
+    .instance_init = max78000_rtc_init,
+    .class_init    = max78000_rtc_class_init,
+};
+
+static void max78000_rtc_register_types(void)
+{
+    type_register_static(&max78000_rtc_info);
+}
+
+type_init(max78000_rtc_register_types)
@@ -0,0 +1,464 @@
+/*
+ * MAX78000 SPI
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Only master mode is modeled. A transaction started with CTRL0.START
+ * shifts MAX(TX_NUM_CHAR, RX_NUM_CHAR) characters; it runs as far as
+ * the FIFOs allow as soon as it is started and picks up again whenever
+ * the guest or the DMA controller fills the TX FIFO or drains the RX
+ * FIFO, so a whole FIFO's worth of data moves per MMIO access rather
+ * than one byte per bit-clock period. Characters past TX_NUM_CHAR, or
+ * sent with the TX FIFO disabled, shift out all ones.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/log.h"
+#include "qapi/error.h"
+#include "trace.h"
+#include "hw/irq.h"
+#include "hw/qdev-clock.h"
+#include "migration/vmstate.h"
+#include "hw/ssi/max78000_spi.h"
+
+static uint32_t max78000_spi_char_bytes(Max78000SpiState *s)
+{
+    uint32_t bits = (s->ctrl2 >> SPI_CTRL2_NUMBITS_SHIFT) &
+                    SPI_CTRL2_NUMBITS_MASK;
+
+    /* NUMBITS of 0 selects 16 bit characters */
+    return (bits == 0 || bits > 8) ? 2 : 1;
+}
+
+static void max78000_spi_update(Max78000SpiState *s)
+{
+    uint32_t tx_thd = s->dma & SPI_DMA_TX_THD_MASK;
+    uint32_t rx_thd = (s->dma >> SPI_DMA_RX_THD_SHIFT) & SPI_DMA_RX_THD_MASK;
+    uint32_t tx_lvl = fifo8_num_used(&s->tx_fifo);
+    uint32_t rx_lvl = fifo8_num_used(&s->rx_fifo);
+
+    if (tx_lvl <= tx_thd) {
+        s->intfl |= SPI_INT_TX_TH;
+    }
+    if (tx_lvl == 0) {
+        s->intfl |= SPI_INT_TX_EM;
+    }
+    if (rx_lvl && rx_lvl >= rx_thd) {
+        s->intfl |= SPI_INT_RX_TH;
+    }
+    if (fifo8_is_full(&s->rx_fifo)) {
+        s->intfl |= SPI_INT_RX_FULL;
+    }
+
+    qemu_set_irq(s->irq, !!(s->intfl & s->inten));
+    qemu_set_irq(s->dma_tx_req, (s->dma & SPI_DMA_TX_EN) &&
+                 (s->dma & SPI_DMA_TX_FIFO_EN) &&
+                 !fifo8_is_full(&s->tx_fifo) && tx_lvl <= tx_thd);
+    qemu_set_irq(s->dma_rx_req, (s->dma & SPI_DMA_RX_EN) &&
+                 rx_lvl && rx_lvl >= rx_thd);
+}
+
+static void max78000_spi_set_ss(Max78000SpiState *s, uint32_t active)
+{
+    int i;
+
+    /* Slave selects are active low */
+    for (i = 0; i < SPI_NUM_SS; i++) {
+        qemu_set_irq(s->cs[i], !(active & (1 << i)));
+    }
+}
+
+static void max78000_spi_finish(Max78000SpiState *s)
+{
+    s->busy = false;
+    s->ctrl0 &= ~SPI_CTRL0_START;
+    s->intfl |= SPI_INT_MST_DONE;
+    if (!(s->ctrl0 & SPI_CTRL0_SS_CTRL)) {
+        max78000_spi_set_ss(s, 0);
+        s->intfl |= SPI_INT_SSD;
+    }
+}
+
+static void max78000_spi_run(Max78000SpiState *s)
+{
+    uint32_t width = max78000_spi_char_bytes(s);
+    bool tx_fifo = s->dma & SPI_DMA_TX_FIFO_EN;
+    bool rx_fifo = s->dma & SPI_DMA_RX_FIFO_EN;
+
+    if (!s->busy || !clock_is_enabled(s->clk)) {
+        return;
+    }
+
+    while (s->tx_left || s->rx_left) {
+        bool send = s->tx_left && tx_fifo;
+        bool keep = s->rx_left && rx_fifo;
+        uint32_t i;
+
+        if (send && fifo8_num_used(&s->tx_fifo) < width) {
+            break;
+        }
+        if (keep && fifo8_num_free(&s->rx_fifo) < width) {
+            break;
+        }
+
+        for (i = 0; i < width; i++) {
+            uint8_t out = send ? fifo8_pop(&s->tx_fifo) : 0xff;
+            uint8_t in = ssi_transfer(s->bus, out);
+
+            if (keep) {
+                fifo8_push(&s->rx_fifo, in);
+            }
+        }
+        if (s->tx_left) {
+            s->tx_left--;
+        }
+        if (s->rx_left) {
+            s->rx_left--;
+        }
+    }
+
+    if (!s->tx_left && !s->rx_left) {
+        max78000_spi_finish(s);
+    }
+}
+
+static void max78000_spi_start(Max78000SpiState *s)
+{
+    if (!(s->ctrl0 & SPI_CTRL0_EN)) {
+        s->ctrl0 &= ~SPI_CTRL0_START;
+        return;
+    }
+    if (!(s->ctrl0 & SPI_CTRL0_MST_MODE)) {
+        qemu_log_mask(LOG_UNIMP, "%s: slave mode is not supported\n",
+                      __func__);
+        s->ctrl0 &= ~SPI_CTRL0_START;
+        return;
+    }
+
+    s->tx_left = s->ctrl1 & SPI_CTRL1_TX_NUM_CHAR_MASK;
+    s->rx_left = s->ctrl1 >> SPI_CTRL1_RX_NUM_CHAR_SHIFT;
+    s->busy = true;
+    max78000_spi_set_ss(s, (s->ctrl0 >> SPI_CTRL0_SS_ACTIVE_SHIFT) &
+                           SPI_CTRL0_SS_ACTIVE_MASK);
+    s->intfl |= SPI_INT_SSA;
+    max78000_spi_run(s);
+}
+
+static uint64_t max78000_spi_read_fifo(Max78000SpiState *s, unsigned int size)
+{
+    uint64_t val = 0;
+    unsigned int i;
+
+    if (fifo8_num_used(&s->rx_fifo) < size) {
+        s->intfl |= SPI_INT_RX_UN;
+    }
+    for (i = 0; i < size && !fifo8_is_empty(&s->rx_fifo); i++) {
+        val |= (uint64_t)fifo8_pop(&s->rx_fifo) << (i * 8);
+    }
+    max78000_spi_run(s);
+    return val;
+}
+
+static void max78000_spi_write_fifo(Max78000SpiState *s, uint64_t val,
+                                    unsigned int size)
+{
+    unsigned int i;
+
+    if (!(s->dma & SPI_DMA_TX_FIFO_EN)) {
+        return;
+    }
+    if (fifo8_num_free(&s->tx_fifo) < size) {
+        s->intfl |= SPI_INT_TX_OV;
+    }
+    for (i = 0; i < size && !fifo8_is_full(&s->tx_fifo); i++) {
+        fifo8_push(&s->tx_fifo, val >> (i * 8));
+    }
+    max78000_spi_run(s);
+}
+
+static uint64_t max78000_spi_read(void *opaque, hwaddr addr,
+                                  unsigned int size)
+{
+    Max78000SpiState *s = opaque;
+    uint64_t retvalue = 0;
+
+    switch (addr) {
+    case SPI_FIFO:
+        retvalue = max78000_spi_read_fifo(s, size);
+        break;
+
+    case SPI_CTRL0:
+        retvalue = s->ctrl0;
+        break;
+
+    case SPI_CTRL1:
+        retvalue = s->ctrl1;
+        break;
+
+    case SPI_CTRL2:
+        retvalue = s->ctrl2;
+        break;
+
+    case SPI_SSTIME:
+        retvalue = s->sstime;
+        break;
+
+    case SPI_CLKCTRL:
+        retvalue = s->clkctrl;
+        break;
+
+    case SPI_DMA:
+        retvalue = (s->dma & ~((0x3f << SPI_DMA_TX_LVL_SHIFT) |
+                               (0x3f << SPI_DMA_RX_LVL_SHIFT))) |
+                   (fifo8_num_used(&s->tx_fifo) << SPI_DMA_TX_LVL_SHIFT) |
+                   (fifo8_num_used(&s->rx_fifo) << SPI_DMA_RX_LVL_SHIFT);
+        break;
+
+    case SPI_INTFL:
+        retvalue = s->intfl;
+        break;
+
+    case SPI_INTEN:
+        retvalue = s->inten;
+        break;
+
+    case SPI_WKFL:
+        retvalue = s->wkfl;
+        break;
+
+    case SPI_WKEN:
+        retvalue = s->wken;
+        break;
+
+    case SPI_STAT:
+        retvalue = s->busy ? SPI_STAT_BUSY : 0;
+        break;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        break;
+    }
+
+    max78000_spi_update(s);
+    return retvalue;
+}
+
+static void max78000_spi_write(void *opaque, hwaddr addr,
+                               uint64_t val64, unsigned int size)
+{
+    Max78000SpiState *s = opaque;
+    uint32_t val = val64;
+
+    switch (addr) {
+    case SPI_FIFO:
+        max78000_spi_write_fifo(s, val64, size);
+        break;
+
+    case SPI_CTRL0:
+        s->ctrl0 = val;
+        if (!(val & SPI_CTRL0_EN)) {
+            s->busy = false;
+            s->ctrl0 &= ~SPI_CTRL0_START;
+            max78000_spi_set_ss(s, 0);
+        } else if ((val & SPI_CTRL0_START) && !s->busy) {
+            max78000_spi_start(s);
+        } else if (!s->busy && !(val & SPI_CTRL0_SS_CTRL)) {
+            /* Clearing SS_CTRL between transactions releases the slave */
+            max78000_spi_set_ss(s, 0);
+        }
+        break;
+
+    case SPI_CTRL1:
+        s->ctrl1 = val;
+        break;
+
+    case SPI_CTRL2:
+        s->ctrl2 = val;
+        break;
+
+    case SPI_SSTIME:
+        s->sstime = val;
+        break;
+
+    case SPI_CLKCTRL:
+        s->clkctrl = val;
+        break;
+
+    case SPI_DMA:
+        if (val & SPI_DMA_TX_FLUSH) {
+            fifo8_reset(&s->tx_fifo);
+        }
+        if (val & SPI_DMA_RX_FLUSH) {
+            fifo8_reset(&s->rx_fifo);
+        }
+        s->dma = val & ~(SPI_DMA_TX_FLUSH | SPI_DMA_RX_FLUSH);
+        max78000_spi_run(s);
+        break;
+
+    case SPI_INTFL:
+        s->intfl &= ~val;
+        break;
+
+    case SPI_INTEN:
+        s->inten = val;
+        break;
+
+    case SPI_WKFL:
+        s->wkfl &= ~val;
+        break;
+
+    case SPI_WKEN:
+        s->wken = val;
+        break;
+
+    case SPI_STAT:
+        break;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        break;
+    }
+
+    max78000_spi_update(s);
+}
+
+static void max78000_spi_clk_update(void *opaque, ClockEvent event)
+{
+    Max78000SpiState *s = opaque;
+
+    max78000_spi_run(s);
+    max78000_spi_update(s);
+}
+
+static void max78000_spi_reset_hold(Object *obj, ResetType type)
+{
+    Max78000SpiState *s = MAX78000_SPI(obj);
+
+    s->ctrl0 = 0;
+    s->ctrl1 = 0;
+    s->ctrl2 = 0;
+    s->sstime = 0;
+    s->clkctrl = 0;
+    s->dma = 0;
+    s->intfl = 0;
+    s->inten = 0;
+    s->wkfl = 0;
+    s->wken = 0;
+    s->tx_left = 0;
+    s->rx_left = 0;
+    s->busy = false;
+
+    fifo8_reset(&s->tx_fifo);
+    fifo8_reset(&s->rx_fifo);
+}
+
+static void max78000_spi_reset_exit(Object *obj, ResetType type)
+{
+    Max78000SpiState *s = MAX78000_SPI(obj);
+
+    max78000_spi_set_ss(s, 0);
+    max78000_spi_update(s);
+}
+
+/* The FIFO takes byte, halfword and word accesses; the rest are word */
+static bool max78000_spi_accepts(void *opaque, hwaddr addr, unsigned size,
+                                 bool is_write, MemTxAttrs attrs)
+{
+    return size == 4 || addr == SPI_FIFO;
+}
+
+static const MemoryRegionOps max78000_spi_ops = {
+    .read = max78000_spi_read,
+    .write = max78000_spi_write,
+    .endianness = DEVICE_LITTLE_ENDIAN,
+    .valid.min_access_size = 1,
+    .valid.max_access_size = 4,
+    .valid.accepts = max78000_spi_accepts,
+};
+
+static const VMStateDescription vmstate_max78000_spi = {
+    .name = TYPE_MAX78000_SPI,
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(ctrl0, Max78000SpiState),
+        VMSTATE_UINT32(ctrl1, Max78000SpiState),
+        VMSTATE_UINT32(ctrl2, Max78000SpiState),
+        VMSTATE_UINT32(sstime, Max78000SpiState),
+        VMSTATE_UINT32(clkctrl, Max78000SpiState),
+        VMSTATE_UINT32(dma, Max78000SpiState),
+        VMSTATE_UINT32(intfl, Max78000SpiState),
+        VMSTATE_UINT32(inten, Max78000SpiState),
+        VMSTATE_UINT32(wkfl, Max78000SpiState),
+        VMSTATE_UINT32(wken, Max78000SpiState),
+        VMSTATE_FIFO8(tx_fifo, Max78000SpiState),
+        VMSTATE_FIFO8(rx_fifo, Max78000SpiState),
+        VMSTATE_UINT32(tx_left, Max78000SpiState),
+        VMSTATE_UINT32(rx_left, Max78000SpiState),
+        VMSTATE_BOOL(busy, Max78000SpiState),
+        VMSTATE_CLOCK(clk, Max78000SpiState),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static void max78000_spi_init(Object *obj)
+{
+    Max78000SpiState *s = MAX78000_SPI(obj);
+
+    s->bus = ssi_create_bus(DEVICE(obj), "spi");
+
+    sysbus_init_irq(SYS_BUS_DEVICE(obj), &s->irq);
+    qdev_init_gpio_out_named(DEVICE(obj), s->cs, SSI_GPIO_CS, SPI_NUM_SS);
+    qdev_init_gpio_out_named(DEVICE(obj), &s->dma_tx_req, "dma-tx", 1);
+    qdev_init_gpio_out_named(DEVICE(obj), &s->dma_rx_req, "dma-rx", 1);
+
+    s->clk = qdev_init_clock_in(DEVICE(obj), "clk", max78000_spi_clk_update,
+                                s, ClockUpdate);
+
+    fifo8_create(&s->tx_fifo, SPI_FIFO_SIZE);
+    fifo8_create(&s->rx_fifo, SPI_FIFO_SIZE);
+
+    memory_region_init_io(&s->mmio, obj, &max78000_spi_ops, s,
+                          TYPE_MAX78000_SPI, 0x1000);
+    sysbus_init_mmio(SYS_BUS_DEVICE(obj), &s->mmio);
+}
+
+static void max78000_spi_realize(DeviceState *dev, Error **errp)
+{
+    Max78000SpiState *s = MAX78000_SPI(dev);
+
+    if (!clock_has_source(s->clk)) {
+        error_setg(errp, "MAX78000 SPI: clk must be connected");
+        return;
+    }
+}
+
+static void max78000_spi_class_init(ObjectClass *klass, const void *data)
+{
+    ResettableClass *rc = RESETTABLE_CLASS(klass);
+    DeviceClass *dc = DEVICE_CLASS(klass);
+
+    rc->phases.hold = max78000_spi_reset_hold;
+    rc->phases.exit = max78000_spi_reset_exit;
+    dc->realize = max78000_spi_realize;
+    dc->vmsd = &vmstate_max78000_spi;
+}
+
+static const TypeInfo max78000_spi_info = {
+    .name          = TYPE_MAX78000_SPI,
+    .parent        = TYPE_SYS_BUS_DEVICE,
+    .instance_size = sizeof(Max78000SpiState),
+    .instance_init = max78000_spi_init,
+    .class_init    = max78000_spi_class_init,
+};
+
+static void max78000_spi_register_types(void)
+{
+    type_register_static(&max78000_spi_info);
+}
+
+type_init(max78000_spi_register_types)
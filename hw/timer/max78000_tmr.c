@@ -0,0 +1,521 @@
+/*
+ * MAX78000 Timer
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * The hardware counts up from 1; each running unit is backed by a
+ * ptimer counting down the ticks left until the next event (a compare
+ * match or a counter wrap), so expiry is a single timer deadline
+ * rather than something that needs polling.
+ *
+ * The PWM output waveform and the non-overlapping complementary
+ * outputs are not modeled; PWM mode behaves like continuous mode.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/log.h"
+#include "qapi/error.h"
+#include "trace.h"
+#include "hw/irq.h"
+#include "hw/qdev-clock.h"
+#include "migration/vmstate.h"
+#include "hw/timer/max78000_tmr.h"
+
+static bool max78000_tmr_cascaded(Max78000TmrState *s)
+{
+    return s->ctrl1 & TMR_CTRL1_CASCADE;
+}
+
+/* Register bits belonging to @unit, shifted down to bit 0 */
+static uint32_t max78000_tmr_bits(Max78000TmrState *s, uint32_t reg, int unit)
+{
+    if (max78000_tmr_cascaded(s)) {
+        return unit ? 0 : reg;
+    }
+    return (reg >> (unit * TMR_UNIT_SHIFT)) & 0xffff;
+}
+
+static void max78000_tmr_set_bits(Max78000TmrState *s, uint32_t *reg,
+                                  int unit, uint32_t val)
+{
+    if (max78000_tmr_cascaded(s)) {
+        if (unit == 0) {
+            *reg = val;
+        }
+        return;
+    }
+    *reg = deposit32(*reg, unit * TMR_UNIT_SHIFT, 16, val);
+}
+
+static uint64_t max78000_tmr_range(Max78000TmrState *s)
+{
+    return max78000_tmr_cascaded(s) ? 1ULL << 32 : 1ULL << 16;
+}
+
+static uint32_t max78000_tmr_ctrl0(Max78000TmrState *s, int unit)
+{
+    return s->ctrl0 >> (unit * TMR_UNIT_SHIFT);
+}
+
+static uint32_t max78000_tmr_ctrl1(Max78000TmrState *s, int unit)
+{
+    return s->ctrl1 >> (unit * TMR_UNIT_SHIFT);
+}
+
+static int max78000_tmr_mode(Max78000TmrState *s, int unit)
+{
+    return max78000_tmr_ctrl0(s, unit) & TMR_CTRL0_MODE_MASK;
+}
+
+static bool max78000_tmr_wraps(int mode)
+{
+    /* These modes free-run through the full range instead of resetting */
+    return mode == TMR_MODE_COMPARE || mode == TMR_MODE_CAPTURE;
+}
+
+/*
+ * The count at which the next event happens, and the count the unit
+ * restarts from after it: (match + restart - count) mod range is the
+ * number of ticks left.
+ */
+static uint64_t max78000_tmr_match(Max78000TmrState *s, int unit)
+{
+    int mode = max78000_tmr_mode(s, unit);
+
+    if (mode == TMR_MODE_CAPTURE) {
+        return 0;
+    }
+    return max78000_tmr_bits(s, s->cmp, unit);
+}
+
+static uint64_t max78000_tmr_restart(Max78000TmrState *s, int unit)
+{
+    return max78000_tmr_wraps(max78000_tmr_mode(s, unit)) ? 0 : 1;
+}
+
+static bool max78000_tmr_clocked(Max78000TmrState *s, int unit)
+{
+    uint32_t ctrl0 = max78000_tmr_ctrl0(s, unit);
+    int mode = ctrl0 & TMR_CTRL0_MODE_MASK;
+    bool gate;
+
+    if (unit == 1 && max78000_tmr_cascaded(s)) {
+        return false;
+    }
+    /* A timer whose peripheral clock is gated is frozen, whatever CLKSEL */
+    if (!(ctrl0 & TMR_CTRL0_EN) || !clock_is_enabled(s->clk)) {
+        return false;
+    }
+
+    switch (mode) {
+    case TMR_MODE_COUNTER:
+        return false;
+    case TMR_MODE_GATED:
+        gate = s->input[unit] ^ !!(ctrl0 & TMR_CTRL0_POL);
+        return gate;
+    default:
+        return true;
+    }
+}
+
+static void max78000_tmr_update_irq(Max78000TmrState *s)
+{
+    bool level = false;
+    int unit;
+
+    for (unit = 0; unit < TMR_NUM_UNITS; unit++) {
+        if ((max78000_tmr_ctrl1(s, unit) & TMR_CTRL1_IE) &&
+            (s->intfl & (TMR_INTFL_IRQ << (unit * TMR_UNIT_SHIFT)))) {
+            level = true;
+        }
+    }
+    qemu_set_irq(s->irq, level);
+}
+
+static void max78000_tmr_event(Max78000TmrState *s, int unit)
+{
+    s->intfl |= TMR_INTFL_IRQ << (unit * TMR_UNIT_SHIFT);
+    max78000_tmr_update_irq(s);
+}
+
+/* Fold the running count of @unit back into s->cnt */
+static void max78000_tmr_latch(Max78000TmrState *s, int unit)
+{
+    uint64_t range = max78000_tmr_range(s);
+    uint64_t count;
+
+    if (!max78000_tmr_clocked(s, unit)) {
+        return;
+    }
+    count = max78000_tmr_match(s, unit) + max78000_tmr_restart(s, unit) +
+            range - ptimer_get_count(s->timer[unit]);
+    max78000_tmr_set_bits(s, &s->cnt, unit, count % range);
+}
+
+/* (Re)program the ptimer of @unit from the register state */
+static void max78000_tmr_program(Max78000TmrState *s, int unit)
+{
+    ptimer_state *pt = s->timer[unit];
+    uint32_t ctrl0 = max78000_tmr_ctrl0(s, unit);
+    uint32_t div = 1 << MIN((ctrl0 >> TMR_CTRL0_CLKDIV_SHIFT) &
+                            TMR_CTRL0_CLKDIV_MASK, 12);
+    uint64_t range = max78000_tmr_range(s);
+    uint64_t remaining, limit;
+    int mode = ctrl0 & TMR_CTRL0_MODE_MASK;
+
+    ptimer_transaction_begin(pt);
+    if (!max78000_tmr_clocked(s, unit)) {
+        ptimer_stop(pt);
+        ptimer_transaction_commit(pt);
+        return;
+    }
+
+    switch (max78000_tmr_ctrl1(s, unit) & TMR_CTRL1_CLKSEL_MASK) {
+    case 0:
+        ptimer_set_period_from_clock(pt, s->clk, div);
+        break;
+    case 1:
+        ptimer_set_freq(pt, TMR_ISO_FREQ / div);
+        break;
+    case 2:
+        ptimer_set_freq(pt, TMR_IBRO_FREQ / div);
+        break;
+    default:
+        ptimer_set_freq(pt, MAX(TMR_ERTCO_FREQ / div, 1));
+        break;
+    }
+
+    limit = max78000_tmr_wraps(mode) ? range :
+            (max78000_tmr_match(s, unit) ?: range);
+    remaining = (max78000_tmr_match(s, unit) + max78000_tmr_restart(s, unit) +
+                 range - max78000_tmr_bits(s, s->cnt, unit)) % range;
+
+    ptimer_set_limit(pt, limit, 0);
+    ptimer_set_count(pt, remaining ?: range);
+    ptimer_run(pt, mode == TMR_MODE_ONESHOT);
+    ptimer_transaction_commit(pt);
+}
+
+static void max78000_tmr_tick(Max78000TmrState *s, int unit)
+{
+    int mode = max78000_tmr_mode(s, unit);
+
+    switch (mode) {
+    case TMR_MODE_ONESHOT:
+        /* Count back at 1, and the unit disables itself */
+        max78000_tmr_set_bits(s, &s->cnt, unit, 1);
+        s->ctrl0 &= ~(TMR_CTRL0_EN << (unit * TMR_UNIT_SHIFT));
+        max78000_tmr_event(s, unit);
+        break;
+    case TMR_MODE_CAPTURE:
+        /* Silent wrap */
+        break;
+    default:
+        max78000_tmr_event(s, unit);
+        break;
+    }
+}
+
+static void max78000_tmr_tick_a(void *opaque)
+{
+    max78000_tmr_tick(opaque, 0);
+}
+
+static void max78000_tmr_tick_b(void *opaque)
+{
+    max78000_tmr_tick(opaque, 1);
+}
+
+/* Timer input pin, used by the counter, capture and gated modes */
+static void max78000_tmr_input(void *opaque, int unit, int level)
+{
+    Max78000TmrState *s = opaque;
+    uint32_t ctrl0 = max78000_tmr_ctrl0(s, unit);
+    bool active;
+    uint32_t count;
+
+    if (s->input[unit] == !!level) {
+        return;
+    }
+    max78000_tmr_latch(s, unit);
+    s->input[unit] = level;
+    active = s->input[unit] ^ !!(ctrl0 & TMR_CTRL0_POL);
+
+    if (!(ctrl0 & TMR_CTRL0_EN) || !active || !clock_is_enabled(s->clk)) {
+        max78000_tmr_program(s, unit);
+        return;
+    }
+
+    switch (ctrl0 & TMR_CTRL0_MODE_MASK) {
+    case TMR_MODE_COUNTER:
+        count = max78000_tmr_bits(s, s->cnt, unit) + 1;
+        if (count == max78000_tmr_bits(s, s->cmp, unit)) {
+            count = 1;
+            max78000_tmr_event(s, unit);
+        }
+        max78000_tmr_set_bits(s, &s->cnt, unit, count);
+        break;
+    case TMR_MODE_CAPTURE:
+    case TMR_MODE_CAPCOMP:
+        max78000_tmr_set_bits(s, &s->pwm, unit,
+                              max78000_tmr_bits(s, s->cnt, unit));
+        max78000_tmr_set_bits(s, &s->cnt, unit, 1);
+        max78000_tmr_event(s, unit);
+        break;
+    default:
+        break;
+    }
+    max78000_tmr_program(s, unit);
+}
+
+static uint64_t max78000_tmr_read(void *opaque, hwaddr addr,
+                                    unsigned int size)
+{
+    Max78000TmrState *s = opaque;
+    uint32_t status;
+    int unit;
+
+    switch (addr) {
+    case TMR_CNT:
+        max78000_tmr_latch(s, 0);
+        max78000_tmr_latch(s, 1);
+        return s->cnt;
+
+    case TMR_CMP:
+        return s->cmp;
+
+    case TMR_PWM:
+        return s->pwm;
+
+    case TMR_INTFL:
+        /* Register writes complete immediately */
+        return s->intfl | TMR_INTFL_WRDONE |
+               (TMR_INTFL_WRDONE << TMR_UNIT_SHIFT);
+
+    case TMR_CTRL0:
+        return s->ctrl0;
+
+    case TMR_NOLCMP:
+        return s->nolcmp;
+
+    case TMR_CTRL1:
+        /* Clocks are ready as soon as they are requested */
+        status = s->ctrl1;
+        for (unit = 0; unit < TMR_NUM_UNITS; unit++) {
+            if ((max78000_tmr_ctrl0(s, unit) &
+                 (TMR_CTRL0_CLKEN | TMR_CTRL0_EN)) ||
+                (max78000_tmr_ctrl1(s, unit) & TMR_CTRL1_CLKEN)) {
+                status |= (TMR_CTRL1_CLKEN | TMR_CTRL1_CLKRDY) <<
+                          (unit * TMR_UNIT_SHIFT);
+            }
+        }
+        return status;
+
+    case TMR_WKFL:
+        return s->wkfl;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        return 0;
+    }
+}
+
+static void max78000_tmr_write(void *opaque, hwaddr addr,
+                    uint64_t val64, unsigned int size)
+{
+    Max78000TmrState *s = opaque;
+    uint32_t val = val64;
+    int unit;
+
+    /* Every write may change how the count evolves; settle it first */
+    for (unit = 0; unit < TMR_NUM_UNITS; unit++) {
+        max78000_tmr_latch(s, unit);
+    }
+
+    switch (addr) {
+    case TMR_CNT:
+        s->cnt = val;
+        break;
+
+    case TMR_CMP:
+        s->cmp = val;
+        break;
+
+    case TMR_PWM:
+        s->pwm = val;
+        break;
+
+    case TMR_INTFL:
+        s->intfl &= ~val;
+        break;
+
+    case TMR_CTRL0:
+        for (unit = 0; unit < TMR_NUM_UNITS; unit++) {
+            if (val & (TMR_CTRL0_RST << (unit * TMR_UNIT_SHIFT))) {
+                max78000_tmr_set_bits(s, &s->cnt, unit, 0);
+            }
+        }
+        s->ctrl0 = val & ~(TMR_CTRL0_RST | (TMR_CTRL0_RST << TMR_UNIT_SHIFT));
+        break;
+
+    case TMR_NOLCMP:
+        s->nolcmp = val;
+        break;
+
+    case TMR_CTRL1:
+        s->ctrl1 = val & ~(TMR_CTRL1_CLKRDY |
+                           (TMR_CTRL1_CLKRDY << TMR_UNIT_SHIFT));
+        break;
+
+    case TMR_WKFL:
+        s->wkfl &= ~val;
+        break;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        return;
+    }
+
+    for (unit = 0; unit < TMR_NUM_UNITS; unit++) {
+        max78000_tmr_program(s, unit);
+    }
+    max78000_tmr_update_irq(s);
+}
+
+/*
+ * The count is settled while the old clock still applies, then the
+ * ptimers are reprogrammed, or stopped if the clock has been gated.
+ */
+static void max78000_tmr_clk_update(void *opaque, ClockEvent event)
+{
+    Max78000TmrState *s = opaque;
+    int unit;
+
+    for (unit = 0; unit < TMR_NUM_UNITS; unit++) {
+        if (event == ClockPreUpdate) {
+            max78000_tmr_latch(s, unit);
+        } else {
+            max78000_tmr_program(s, unit);
+        }
+    }
+}
+
+static void max78000_tmr_reset_hold(Object *obj, ResetType type)
+{
+    Max78000TmrState *s = MAX78000_TMR(obj);
+    int unit;
+
+    s->cnt = 0;
+    s->cmp = 0xffffffff;
+    s->pwm = 0;
+    s->intfl = 0;
+    s->ctrl0 = 0;
+    s->nolcmp = 0;
+    s->ctrl1 = 0;
+    s->wkfl = 0;
+
+    for (unit = 0; unit < TMR_NUM_UNITS; unit++) {
+        max78000_tmr_program(s, unit);
+    }
+}
+
+static void max78000_tmr_reset_exit(Object *obj, ResetType type)
+{
+    Max78000TmrState *s = MAX78000_TMR(obj);
+
+    max78000_tmr_update_irq(s);
+}
+
+static const MemoryRegionOps max78000_tmr_ops = {
+    .read = max78000_tmr_read,
+    .write = max78000_tmr_write,
+    .endianness = DEVICE_LITTLE_ENDIAN,
+    .valid.min_access_size = 4,
+    .valid.max_access_size = 4,
+};
+
+static const VMStateDescription vmstate_max78000_tmr = {
+    .name = TYPE_MAX78000_TMR,
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_PTIMER_ARRAY(timer, Max78000TmrState, TMR_NUM_UNITS),
+        VMSTATE_CLOCK(clk, Max78000TmrState),
+        VMSTATE_UINT32(cnt, Max78000TmrState),
+        VMSTATE_UINT32(cmp, Max78000TmrState),
+        VMSTATE_UINT32(pwm, Max78000TmrState),
+        VMSTATE_UINT32(intfl, Max78000TmrState),
+        VMSTATE_UINT32(ctrl0, Max78000TmrState),
+        VMSTATE_UINT32(nolcmp, Max78000TmrState),
+        VMSTATE_UINT32(ctrl1, Max78000TmrState),
+        VMSTATE_UINT32(wkfl, Max78000TmrState),
+        VMSTATE_BOOL_ARRAY(input, Max78000TmrState, TMR_NUM_UNITS),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static void max78000_tmr_init(Object *obj)
+{
+    Max78000TmrState *s = MAX78000_TMR(obj);
+
+    sysbus_init_irq(SYS_BUS_DEVICE(obj), &s->irq);
+    qdev_init_gpio_in_named(DEVICE(obj), max78000_tmr_input, "input",
+                            TMR_NUM_UNITS);
+
+    memory_region_init_io(&s->mmio, obj, &max78000_tmr_ops, s,
+                        TYPE_MAX78000_TMR, 0x400);
+    sysbus_init_mmio(SYS_BUS_DEVICE(obj), &s->mmio);
+
+    s->clk = qdev_init_clock_in(DEVICE(s), "clk", max78000_tmr_clk_update, s,
+                                ClockPreUpdate | ClockUpdate);
+}
+
+static void max78000_tmr_realize(DeviceState *dev, Error **errp)
+{
+    Max78000TmrState *s = MAX78000_TMR(dev);
+    static const ptimer_cb ticks[TMR_NUM_UNITS] = {
+        max78000_tmr_tick_a, max78000_tmr_tick_b
+    };
+    int unit;
+
+    if (!clock_has_source(s->clk)) {
+        error_setg(errp, "MAX78000 timer: clk must be connected");
+        return;
+    }
+
+    for (unit = 0; unit < TMR_NUM_UNITS; unit++) {
+        s->timer[unit] = ptimer_init(ticks[unit], s,
+                                     PTIMER_POLICY_TRIGGER_ONLY_ON_DECREMENT |
+                                     PTIMER_POLICY_NO_COUNTER_ROUND_DOWN);
+    }
+}
+
+static void max78000_tmr_class_init(ObjectClass *klass, const void *data)
+{
+    ResettableClass *rc = RESETTABLE_CLASS(klass);
+    DeviceClass *dc = DEVICE_CLASS(klass);
+
+    rc->phases.hold = max78000_tmr_reset_hold;
+    rc->phases.exit = max78000_tmr_reset_exit;
+    dc->realize = max78000_tmr_realize;
+    dc->vmsd = &vmstate_max78000_tmr;
+}
+
+static const TypeInfo max78000_tmr_info = {
+    .name          = TYPE_MAX78000_TMR,
+    .parent        = TYPE_SYS_BUS_DEVICE,
+    .instance_size = sizeof(Max78000TmrState),
+    .instance_init = max78000_tmr_init,
+    .class_init    = max78000_tmr_class_init,
+};
+
+static void max78000_tmr_register_types(void)
+{
+    type_register_static(&max78000_tmr_info);
+}
+
+type_init(max78000_tmr_register_types)
@@ -0,0 +1,322 @@
+/*
+ * MAX78000 Wakeup Timer
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * A 32-bit timer in the always-on domain, clocked from the 32kHz
+ * oscillator. Like the general purpose timers it counts up from 1 and
+ * is backed by a ptimer counting down to the next compare match.
+ * Only the one-shot, continuous and compare modes are modeled; the
+ * other modes behave like continuous mode.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/log.h"
+#include "trace.h"
+#include "hw/irq.h"
+#include "migration/vmstate.h"
+#include "hw/timer/max78000_wut.h"
+
+#define WUT_RANGE (1ULL << 32)
+
+static int max78000_wut_mode(Max78000WutState *s)
+{
+    return s->ctrl & WUT_CTRL_TMODE_MASK;
+}
+
+static bool max78000_wut_running(Max78000WutState *s)
+{
+    return s->ctrl & WUT_CTRL_TEN;
+}
+
+/* Compare mode free-runs through the full range; other modes restart at 1 */
+static uint64_t max78000_wut_restart(Max78000WutState *s)
+{
+    return max78000_wut_mode(s) == WUT_MODE_COMPARE ? 0 : 1;
+}
+
+static void max78000_wut_update_irq(Max78000WutState *s)
+{
+    bool level = s->intfl & WUT_INTFL_IRQ;
+
+    qemu_set_irq(s->irq, level);
+    qemu_set_irq(s->wakeup, level);
+}
+
+static void max78000_wut_latch(Max78000WutState *s)
+{
+    if (!max78000_wut_running(s)) {
+        return;
+    }
+    s->cnt = (s->cmp + max78000_wut_restart(s) + WUT_RANGE -
+              ptimer_get_count(s->timer)) % WUT_RANGE;
+}
+
+static uint32_t max78000_wut_freq(Max78000WutState *s)
+{
+    uint32_t pres = (s->ctrl >> WUT_CTRL_PRES_SHIFT) & WUT_CTRL_PRES_MASK;
+
+    if (s->ctrl & WUT_CTRL_PRES3) {
+        pres |= 8;
+    }
+    return MAX(WUT_FREQ >> pres, 1);
+}
+
+static void max78000_wut_program(Max78000WutState *s)
+{
+    uint64_t remaining, limit;
+
+    ptimer_transaction_begin(s->timer);
+    if (!max78000_wut_running(s)) {
+        ptimer_stop(s->timer);
+        ptimer_transaction_commit(s->timer);
+        return;
+    }
+
+    ptimer_set_freq(s->timer, max78000_wut_freq(s));
+
+    limit = max78000_wut_mode(s) == WUT_MODE_COMPARE ? WUT_RANGE :
+            (s->cmp ?: WUT_RANGE);
+    remaining = (s->cmp + max78000_wut_restart(s) + WUT_RANGE - s->cnt) %
+                WUT_RANGE;
+
+    ptimer_set_limit(s->timer, limit, 0);
+    ptimer_set_count(s->timer, remaining ?: WUT_RANGE);
+    ptimer_run(s->timer, max78000_wut_mode(s) == WUT_MODE_ONESHOT);
+    ptimer_transaction_commit(s->timer);
+}
+
+static void max78000_wut_tick(void *opaque)
+{
+    Max78000WutState *s = opaque;
+
+    if (max78000_wut_mode(s) == WUT_MODE_ONESHOT) {
+        s->cnt = 1;
+        s->ctrl &= ~WUT_CTRL_TEN;
+    }
+    s->intfl |= WUT_INTFL_IRQ;
+    max78000_wut_update_irq(s);
+}
+
+int64_t max78000_wut_next_deadline(Max78000WutState *s)
+{
+    if (!max78000_wut_running(s)) {
+        return INT64_MAX;
+    }
+    return muldiv64(ptimer_get_count(s->timer), NANOSECONDS_PER_SECOND,
+                    max78000_wut_freq(s));
+}
+
+void max78000_wut_skip(Max78000WutState *s, int64_t ns)
+{
+    uint64_t ticks, count;
+
+    if (!max78000_wut_running(s)) {
+        return;
+    }
+    ticks = muldiv64(ns, max78000_wut_freq(s), NANOSECONDS_PER_SECOND);
+
+    ptimer_transaction_begin(s->timer);
+    count = ptimer_get_count(s->timer);
+    /* A match inside the skipped interval still fires, on the next tick */
+    ptimer_set_count(s->timer, count > ticks ? count - ticks : 1);
+    ptimer_transaction_commit(s->timer);
+}
+
+static uint64_t max78000_wut_read(void *opaque, hwaddr addr,
+                                    unsigned int size)
+{
+    Max78000WutState *s = opaque;
+
+    switch (addr) {
+    case WUT_CNT:
+        max78000_wut_latch(s);
+        return s->cnt;
+
+    case WUT_CMP:
+        return s->cmp;
+
+    case WUT_PWM:
+        return s->pwm;
+
+    case WUT_INTFL:
+        return s->intfl;
+
+    case WUT_CTRL:
+        return s->ctrl;
+
+    case WUT_NOLCMP:
+        return s->nolcmp;
+
+    case WUT_PRESET:
+        return s->preset;
+
+    case WUT_RELOAD:
+        return s->reload;
+
+    case WUT_SNAPSHOT:
+        max78000_wut_latch(s);
+        s->snapshot = s->cnt;
+        return s->snapshot;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        return 0;
+    }
+}
+
+static void max78000_wut_write(void *opaque, hwaddr addr,
+                    uint64_t val64, unsigned int size)
+{
+    Max78000WutState *s = opaque;
+    uint32_t val = val64;
+
+    max78000_wut_latch(s);
+
+    switch (addr) {
+    case WUT_CNT:
+        s->cnt = val;
+        break;
+
+    case WUT_CMP:
+        s->cmp = val;
+        break;
+
+    case WUT_PWM:
+        s->pwm = val;
+        break;
+
+    case WUT_INTFL:
+        s->intfl &= ~val;
+        break;
+
+    case WUT_CTRL:
+        s->ctrl = val;
+        break;
+
+    case WUT_NOLCMP:
+        s->nolcmp = val;
+        break;
+
+    case WUT_PRESET:
+        s->preset = val;
+        break;
+
+    case WUT_RELOAD:
+        s->reload = val;
+        break;
+
+    case WUT_SNAPSHOT:
+        s->snapshot = val;
+        break;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        return;
+    }
+
+    max78000_wut_program(s);
+    max78000_wut_update_irq(s);
+}
+
+static void max78000_wut_reset_hold(Object *obj, ResetType type)
+{
+    Max78000WutState *s = MAX78000_WUT(obj);
+
+    s->cnt = 0;
+    s->cmp = 0xffffffff;
+    s->pwm = 0;
+    s->intfl = 0;
+    s->ctrl = 0;
+    s->nolcmp = 0;
+    s->preset = 0;
+    s->reload = 0;
+    s->snapshot = 0;
+
+    max78000_wut_program(s);
+}
+
+static void max78000_wut_reset_exit(Object *obj, ResetType type)
+{
+    Max78000WutState *s = MAX78000_WUT(obj);
+
+    max78000_wut_update_irq(s);
+}
+
+static const MemoryRegionOps max78000_wut_ops = {
+    .read = max78000_wut_read,
+    .write = max78000_wut_write,
+    .endianness = DEVICE_LITTLE_ENDIAN,
+    .valid.min_access_size = 4,
+    .valid.max_access_size = 4,
+};
+
+static const VMStateDescription vmstate_max78000_wut = {
+    .name = TYPE_MAX78000_WUT,
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_PTIMER(timer, Max78000WutState),
+        VMSTATE_UINT32(cnt, Max78000WutState),
+        VMSTATE_UINT32(cmp, Max78000WutState),
+        VMSTATE_UINT32(pwm, Max78000WutState),
+        VMSTATE_UINT32(intfl, Max78000WutState),
+        VMSTATE_UINT32(ctrl, Max78000WutState),
+        VMSTATE_UINT32(nolcmp, Max78000WutState),
+        VMSTATE_UINT32(preset, Max78000WutState),
+        VMSTATE_UINT32(reload, Max78000WutState),
+        VMSTATE_UINT32(snapshot, Max78000WutState),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static void max78000_wut_init(Object *obj)
+{
+    Max78000WutState *s = MAX78000_WUT(obj);
+
+    sysbus_init_irq(SYS_BUS_DEVICE(obj), &s->irq);
+    qdev_init_gpio_out_named(DEVICE(obj), &s->wakeup, "wakeup", 1);
+
+    memory_region_init_io(&s->mmio, obj, &max78000_wut_ops, s,
+                        TYPE_MAX78000_WUT, 0x400);
+    sysbus_init_mmio(SYS_BUS_DEVICE(obj), &s->mmio);
+}
+
+static void max78000_wut_realize(DeviceState *dev, Error **errp)
+{
+    Max78000WutState *s = MAX78000_WUT(dev);
+
+    s->timer = ptimer_init(max78000_wut_tick, s,
+                           PTIMER_POLICY_TRIGGER_ONLY_ON_DECREMENT |
+                           PTIMER_POLICY_NO_COUNTER_ROUND_DOWN);
+}
+
+static void max78000_wut_class_init(ObjectClass *klass, const void *data)
+{
+    ResettableClass *rc = RESETTABLE_CLASS(klass);
+    DeviceClass *dc = DEVICE_CLASS(klass);
+
+    rc->phases.hold = max78000_wut_reset_hold;
+    rc->phases.exit = max78000_wut_reset_exit;
+    dc->realize = max78000_wut_realize;
+    dc->vmsd = &vmstate_max78000_wut;
+}
+
+static const TypeInfo max78000_wut_info = {
+    .name          = TYPE_MAX78000_WUT,
+    .parent        = TYPE_SYS_BUS_DEVICE,
+    .instance_size = sizeof(Max78000WutState),
+    .instance_init = max78000_wut_init,
+    .class_init    = max78000_wut_class_init,
+};
+
+static void max78000_wut_register_types(void)
+{
+    type_register_static(&max78000_wut_info);
+}
+
+type_init(max78000_wut_register_types)
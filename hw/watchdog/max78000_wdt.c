@@ -0,0 +1,356 @@
+/*
+ * MAX78000 Watchdog Timer
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Used for both WDT0 and the low power watchdog. The counter is not
+ * ticked; it is computed from virtual time when it is read, and the
+ * timer is only armed for the next late threshold. Feeding the watchdog
+ * checks the early thresholds when windowed mode is enabled.
+ *
+ * A bite goes through watchdog_perform_action(), so it emits the
+ * WATCHDOG QMP event and then does whatever "-action watchdog=..."
+ * asks for: a system reset by default, or "poweroff" to exit at once.
+ * The reset flags in CTRL survive the system reset that a bite causes.
+ */
+
+#include "qemu/osdep.h"
+#include "qemu/log.h"
+#include "qemu/timer.h"
+#include "qapi/error.h"
+#include "system/watchdog.h"
+#include "trace.h"
+#include "hw/irq.h"
+#include "hw/qdev-clock.h"
+#include "migration/vmstate.h"
+#include "hw/watchdog/max78000_wdt.h"
+
+static bool max78000_wdt_running(Max78000WdtState *s)
+{
+    return (s->ctrl & WDT_CTRL_EN) && clock_is_enabled(s->clk);
+}
+
+static uint32_t max78000_wdt_threshold(Max78000WdtState *s, int shift)
+{
+    return 1u << (31 - ((s->ctrl >> shift) & WDT_CTRL_VAL_MASK));
+}
+
+/* Rounded up, so that the count has reached @ticks by the time returned */
+static int64_t max78000_wdt_ticks_to_ns(Max78000WdtState *s, uint64_t ticks)
+{
+    switch (s->clksel & WDT_CLKSEL_MASK) {
+    case WDT_CLKSEL_PCLK:
+        return clock_ticks_to_ns(s->clk, ticks) + 1;
+    case WDT_CLKSEL_IBRO:
+        return muldiv64(ticks, NANOSECONDS_PER_SECOND, WDT_IBRO_FREQ) + 1;
+    default:
+        return muldiv64(ticks, NANOSECONDS_PER_SECOND, WDT_ERTCO_FREQ) + 1;
+    }
+}
+
+static uint64_t max78000_wdt_ns_to_ticks(Max78000WdtState *s, int64_t ns)
+{
+    switch (s->clksel & WDT_CLKSEL_MASK) {
+    case WDT_CLKSEL_PCLK:
+        return clock_ns_to_ticks(s->clk, ns);
+    case WDT_CLKSEL_IBRO:
+        return muldiv64(ns, WDT_IBRO_FREQ, NANOSECONDS_PER_SECOND);
+    default:
+        return muldiv64(ns, WDT_ERTCO_FREQ, NANOSECONDS_PER_SECOND);
+    }
+}
+
+static uint32_t max78000_wdt_count(Max78000WdtState *s)
+{
+    int64_t now = qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
+
+    if (!max78000_wdt_running(s) || now <= s->cnt_ns) {
+        return s->cnt;
+    }
+    return MIN(s->cnt + max78000_wdt_ns_to_ticks(s, now - s->cnt_ns),
+               UINT32_MAX);
+}
+
+static void max78000_wdt_update_irq(Max78000WdtState *s)
+{
+    qemu_set_irq(s->irq, (s->ctrl & WDT_CTRL_WDT_INT_EN) &&
+                         (s->ctrl & (WDT_CTRL_INT_LATE | WDT_CTRL_INT_EARLY)));
+}
+
+static void max78000_wdt_bite(Max78000WdtState *s, uint32_t flag)
+{
+    s->ctrl |= flag;
+    s->bite_flags = flag;
+    trace_max78000_wdt_bite(object_get_canonical_path_component(OBJECT(s)),
+                            flag == WDT_CTRL_RST_EARLY ? "early" : "late");
+    watchdog_perform_action();
+}
+
+/*
+ * Bring the counter up to date, raising the late interrupt and reset for
+ * any threshold it has crossed since the last update.
+ */
+static void max78000_wdt_advance(Max78000WdtState *s)
+{
+    uint32_t old = s->cnt;
+    uint32_t new = max78000_wdt_count(s);
+    uint32_t th;
+
+    if (!max78000_wdt_running(s)) {
+        s->cnt_ns = qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
+        return;
+    }
+
+    /* Keep the fraction of a tick that has not completed yet */
+    s->cnt = new;
+    s->cnt_ns += max78000_wdt_ticks_to_ns(s, new - old) - 1;
+
+    th = max78000_wdt_threshold(s, WDT_CTRL_INT_LATE_VAL_SHIFT);
+    if (old < th && new >= th) {
+        s->ctrl |= WDT_CTRL_INT_LATE;
+    }
+    th = max78000_wdt_threshold(s, WDT_CTRL_RST_LATE_VAL_SHIFT);
+    if ((s->ctrl & WDT_CTRL_WDT_RST_EN) && old < th && new >= th) {
+        max78000_wdt_bite(s, WDT_CTRL_RST_LATE);
+    }
+}
+
+/* Arm the timer for the next late threshold, if one is still ahead */
+static void max78000_wdt_program(Max78000WdtState *s)
+{
+    uint32_t next = UINT32_MAX;
+    uint32_t th;
+
+    if (!s->timer) {
+        return;
+    }
+
+    th = max78000_wdt_threshold(s, WDT_CTRL_INT_LATE_VAL_SHIFT);
+    if (s->cnt < th) {
+        next = th;
+    }
+    th = max78000_wdt_threshold(s, WDT_CTRL_RST_LATE_VAL_SHIFT);
+    if ((s->ctrl & WDT_CTRL_WDT_RST_EN) && s->cnt < th) {
+        next = MIN(next, th);
+    }
+
+    if (!max78000_wdt_running(s) || next == UINT32_MAX) {
+        timer_del(s->timer);
+        return;
+    }
+    timer_mod(s->timer,
+              s->cnt_ns + max78000_wdt_ticks_to_ns(s, next - s->cnt));
+}
+
+static void max78000_wdt_expire(void *opaque)
+{
+    Max78000WdtState *s = opaque;
+
+    max78000_wdt_advance(s);
+    max78000_wdt_program(s);
+    max78000_wdt_update_irq(s);
+}
+
+/* Called with the count up to date */
+static void max78000_wdt_feed(Max78000WdtState *s)
+{
+    if (max78000_wdt_running(s) && (s->ctrl & WDT_CTRL_WIN_EN)) {
+        if (s->cnt < max78000_wdt_threshold(s, WDT_CTRL_INT_EARLY_VAL_SHIFT)) {
+            s->ctrl |= WDT_CTRL_INT_EARLY;
+        }
+        if ((s->ctrl & WDT_CTRL_WDT_RST_EN) &&
+            s->cnt < max78000_wdt_threshold(s, WDT_CTRL_RST_EARLY_VAL_SHIFT)) {
+            max78000_wdt_bite(s, WDT_CTRL_RST_EARLY);
+        }
+    }
+
+    trace_max78000_wdt_feed(object_get_canonical_path_component(OBJECT(s)),
+                            s->cnt);
+    s->cnt = 0;
+    s->cnt_ns = qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
+}
+
+static uint64_t max78000_wdt_read(void *opaque, hwaddr addr,
+                                  unsigned int size)
+{
+    Max78000WdtState *s = opaque;
+
+    switch (addr) {
+    case WDT_CTRL:
+        /* The clock switch always completes immediately */
+        return s->ctrl | WDT_CTRL_CLKRDY;
+
+    case WDT_RST:
+        return 0;
+
+    case WDT_CLKSEL:
+        return s->clksel;
+
+    case WDT_CNT:
+        return max78000_wdt_count(s);
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        return 0;
+    }
+}
+
+static void max78000_wdt_write(void *opaque, hwaddr addr,
+                               uint64_t val64, unsigned int size)
+{
+    Max78000WdtState *s = opaque;
+    uint32_t val = val64;
+
+    max78000_wdt_advance(s);
+
+    switch (addr) {
+    case WDT_CTRL:
+        s->ctrl = (val & ~(WDT_CTRL_FLAGS | WDT_CTRL_CLKRDY)) |
+                  (s->ctrl & val & WDT_CTRL_FLAGS);
+        break;
+
+    case WDT_RST:
+        if (s->rst_seq == WDT_RST_SEQ0 && (val & 0xff) == WDT_RST_SEQ1) {
+            max78000_wdt_feed(s);
+        }
+        s->rst_seq = val;
+        break;
+
+    case WDT_CLKSEL:
+        s->clksel = val & WDT_CLKSEL_MASK;
+        break;
+
+    case WDT_CNT:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: CNT is read only\n", __func__);
+        break;
+
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR, "%s: Bad offset 0x%"
+            HWADDR_PRIx "\n", __func__, addr);
+        break;
+    }
+
+    max78000_wdt_program(s);
+    max78000_wdt_update_irq(s);
+}
+
+/*
+ * The count is settled while the old clock still applies, then the
+ * timer is rearmed, or stopped if the clock has been gated.
+ */
+static void max78000_wdt_clk_update(void *opaque, ClockEvent event)
+{
+    Max78000WdtState *s = opaque;
+
+    if (!s->timer) {
+        return;
+    }
+    if (event == ClockPreUpdate) {
+        max78000_wdt_advance(s);
+    } else {
+        max78000_wdt_program(s);
+        max78000_wdt_update_irq(s);
+    }
+}
+
+static void max78000_wdt_reset_hold(Object *obj, ResetType type)
+{
+    Max78000WdtState *s = MAX78000_WDT(obj);
+
+    s->ctrl = s->bite_flags;
+    s->bite_flags = 0;
+    s->clksel = 0;
+    s->rst_seq = 0;
+    s->cnt = 0;
+    s->cnt_ns = qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
+    if (s->timer) {
+        timer_del(s->timer);
+    }
+}
+
+static void max78000_wdt_reset_exit(Object *obj, ResetType type)
+{
+    Max78000WdtState *s = MAX78000_WDT(obj);
+
+    max78000_wdt_update_irq(s);
+}
+
+static const MemoryRegionOps max78000_wdt_ops = {
+    .read = max78000_wdt_read,
+    .write = max78000_wdt_write,
+    .endianness = DEVICE_LITTLE_ENDIAN,
+    .valid.min_access_size = 4,
+    .valid.max_access_size = 4,
+};
+
+static const VMStateDescription vmstate_max78000_wdt = {
+    .name = TYPE_MAX78000_WDT,
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(ctrl, Max78000WdtState),
+        VMSTATE_UINT32(clksel, Max78000WdtState),
+        VMSTATE_UINT8(rst_seq, Max78000WdtState),
+        VMSTATE_UINT32(cnt, Max78000WdtState),
+        VMSTATE_INT64(cnt_ns, Max78000WdtState),
+        VMSTATE_TIMER_PTR(timer, Max78000WdtState),
+        VMSTATE_UINT32(bite_flags, Max78000WdtState),
+        VMSTATE_CLOCK(clk, Max78000WdtState),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static void max78000_wdt_init(Object *obj)
+{
+    Max78000WdtState *s = MAX78000_WDT(obj);
+
+    sysbus_init_irq(SYS_BUS_DEVICE(obj), &s->irq);
+
+    memory_region_init_io(&s->mmio, obj, &max78000_wdt_ops, s,
+                        TYPE_MAX78000_WDT, 0x400);
+    sysbus_init_mmio(SYS_BUS_DEVICE(obj), &s->mmio);
+
+    s->clk = qdev_init_clock_in(DEVICE(s), "clk", max78000_wdt_clk_update, s,
+                                ClockPreUpdate | ClockUpdate);
+}
+
+static void max78000_wdt_realize(DeviceState *dev, Error **errp)
+{
+    Max78000WdtState *s = MAX78000_WDT(dev);
+
+    if (!clock_has_source(s->clk)) {
+        error_setg(errp, "MAX78000 WDT: clk must be connected");
+        return;
+    }
+
+    s->timer = timer_new_ns(QEMU_CLOCK_VIRTUAL, max78000_wdt_expire, s);
+}
+
+static void max78000_wdt_class_init(ObjectClass *klass, const void *data)
+{
+    ResettableClass *rc = RESETTABLE_CLASS(klass);
+    DeviceClass *dc = DEVICE_CLASS(klass);
+
+    rc->phases.hold = max78000_wdt_reset_hold;
+    rc->phases.exit = max78000_wdt_reset_exit;
+    dc->realize = max78000_wdt_realize;
+    dc->vmsd = &vmstate_max78000_wdt;
+}
+
+static const TypeInfo max78000_wdt_info = {
+    .name          = TYPE_MAX78000_WDT,
+    .parent        = TYPE_SYS_BUS_DEVICE,
+    .instance_size = sizeof(Max78000WdtState),
+    .instance_init = max78000_wdt_init,
+    .class_init    = max78000_wdt_class_init,
+};
+
+static void max78000_wdt_register_types(void)
+{
+    type_register_static(&max78000_wdt_info);
+}
+
+type_init(max78000_wdt_register_types)
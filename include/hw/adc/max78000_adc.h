@@ -0,0 +1,105 @@
+/*
+ * MAX78000 ADC
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef HW_MAX78000_ADC_H
+#define HW_MAX78000_ADC_H
+
+#include "hw/sysbus.h"
+#include "hw/clock.h"
+#include "qom/object.h"
+
+#define TYPE_MAX78000_ADC "max78000-adc"
+OBJECT_DECLARE_SIMPLE_TYPE(Max78000AdcState, MAX78000_ADC)
+
+/* AIN0-7 and the internal supply monitors */
+#define ADC_NUM_CHANNELS 16
+#define ADC_NUM_LIMITS 4
+
+/* ADC clock cycles per conversion */
+#define ADC_CONV_CYCLES 1024
+
+/* Samples read from a channel's file at a time */
+#define ADC_FILE_BATCH 4096
+
+#define ADC_CTRL        0x0
+#define ADC_STATUS      0x4
+#define ADC_DATA        0x8
+#define ADC_INTR        0xc
+#define ADC_LIMIT0      0x10
+
+/* CTRL */
+#define ADC_CTRL_START          (1 << 0)
+#define ADC_CTRL_PWR            (1 << 1)
+#define ADC_CTRL_REFBUF_PWR     (1 << 3)
+#define ADC_CTRL_REF_SEL        (1 << 4)
+#define ADC_CTRL_REF_SCALE      (1 << 8)
+#define ADC_CTRL_SCALE          (1 << 9)
+#define ADC_CTRL_CLK_EN         (1 << 11)
+#define ADC_CTRL_CH_SEL_SHIFT   12
+#define ADC_CTRL_CH_SEL_MASK    0x1f
+#define ADC_CTRL_DIVSEL_SHIFT   17
+#define ADC_CTRL_DIVSEL_MASK    0x3
+#define ADC_CTRL_DATA_ALIGN     (1 << 20)
+
+/* STATUS */
+#define ADC_STATUS_ACTIVE       (1 << 0)
+#define ADC_STATUS_OVERFLOW     (1 << 3)
+
+/* INTR: enables in the low half, flags in the high half */
+#define ADC_INTR_DONE           (1 << 0)
+#define ADC_INTR_REF_READY      (1 << 1)
+#define ADC_INTR_HI_LIMIT       (1 << 2)
+#define ADC_INTR_LO_LIMIT       (1 << 3)
+#define ADC_INTR_OVERFLOW       (1 << 4)
+#define ADC_INTR_ALL            0x1f
+#define ADC_INTR_IF_SHIFT       16
+#define ADC_INTR_PENDING        (1 << 22)
+
+/* LIMIT0-3 */
+#define ADC_LIMIT_LO_MASK       0x3ff
+#define ADC_LIMIT_HI_SHIFT      12
+#define ADC_LIMIT_HI_MASK       0x3ff
+#define ADC_LIMIT_CH_SEL_SHIFT  24
+#define ADC_LIMIT_CH_SEL_MASK   0xf
+#define ADC_LIMIT_LO_EN         (1 << 28)
+#define ADC_LIMIT_HI_EN         (1 << 29)
+
+#define ADC_SAMPLE_MASK         0x3ff
+
+/*
+ * Input samples for one channel: the raw 10 bit codes of successive
+ * conversions, from a file or from the "samples[n]" property. Once they
+ * run out the input holds its last value.
+ */
+typedef struct Max78000AdcChannel {
+    char *path;
+    int fd;
+    uint16_t *buf;
+    uint32_t len;
+    uint32_t pos;
+    uint16_t last;
+} Max78000AdcChannel;
+
+struct Max78000AdcState {
+    SysBusDevice parent_obj;
+
+    MemoryRegion mmio;
+
+    uint32_t ctrl;
+    uint32_t status;
+    uint32_t data;
+    uint32_t intr;
+    uint32_t limit[ADC_NUM_LIMITS];
+
+    Max78000AdcChannel ch[ADC_NUM_CHANNELS];
+    QEMUTimer *conv_timer;
+
+    Clock *clk;
+    qemu_irq irq;
+};
+
+#endif
@@ -10,12 +10,33 @@
 #define HW_ARM_MAX78000_SOC_H
 
 #include "hw/or-irq.h"
+#include "hw/core/split-irq.h"
 #include "hw/arm/armv7m.h"
+#include "hw/adc/max78000_adc.h"
+#include "hw/audio/max78000_i2s.h"
 #include "hw/misc/max78000_aes.h"
+#include "hw/misc/max78000_cnn.h"
+#include "hw/misc/max78000_crc.h"
+#include "hw/misc/max78000_flc.h"
 #include "hw/misc/max78000_gcr.h"
 #include "hw/misc/max78000_icc.h"
+#include "hw/misc/max78000_lpgcr.h"
+#include "hw/misc/max78000_owm.h"
+#include "hw/misc/max78000_pcif.h"
+#include "hw/misc/max78000_pt.h"
+#include "hw/misc/max78000_pwrseq.h"
+#include "hw/misc/max78000_sema.h"
 #include "hw/char/max78000_uart.h"
+#include "hw/dma/max78000_dma.h"
+#include "hw/gpio/max78000_gpio.h"
+#include "hw/ssi/max78000_spi.h"
+#include "hw/i2c/max78000_i2c.h"
 #include "hw/misc/max78000_trng.h"
+#include "hw/rtc/max78000_rtc.h"
+#include "hw/timer/max78000_tmr.h"
+#include "hw/timer/max78000_wut.h"
+#include "hw/watchdog/max78000_wdt.h"
+#include "system/hostmem.h"
 #include "qom/object.h"
 
 #define TYPE_MAX78000_SOC "max78000-soc"
@@ -28,7 +49,20 @@ OBJECT_DECLARE_SIMPLE_TYPE(MAX78000State, MAX78000_SOC)
 
 /* The MAX78k has 2 instruction caches; only icc0 matters, icc1 is for RISC */
 #define MAX78000_NUM_ICC 2
-#define MAX78000_NUM_UART 3
+#define MAX78000_NUM_UART 4
+/*
+ * UART0-2 sit behind the GCR and have DMA requests; the low power
+ * UART3 sits behind the LPGCR and has none
+ */
+#define MAX78000_NUM_HS_UART 3
+/* TMR0-3 plus the low power timers TMR4 and TMR5 */
+#define MAX78000_NUM_TMR 6
+/* GPIO2 sits in the always-on domain behind the LPGCR */
+#define MAX78000_NUM_GPIO 3
+#define MAX78000_NUM_SPI 2
+#define MAX78000_NUM_I2C 3
+/* WDT0 plus the low power watchdog, WDT1 in the LPGCR */
+#define MAX78000_NUM_WDT 2
 
 struct MAX78000State {
     SysBusDevice parent_obj;
@@ -37,14 +71,41 @@ struct MAX78000State {
 
     MemoryRegion sram;
     MemoryRegion flash;
+    /* Optional host memory backend holding the flash contents */
+    HostMemoryBackend *flash_memdev;
 
     Max78000GcrState gcr;
+    Max78000FlcState flc;
     Max78000IccState icc[MAX78000_NUM_ICC];
     Max78000UartState uart[MAX78000_NUM_UART];
     Max78000TrngState trng;
     Max78000AesState aes;
+    Max78000CrcState crc;
+    Max78000SemaState sema;
+    Max78000PcifState pcif;
+    Max78000I2sState i2s;
+    Max78000AdcState adc;
+    Max78000PtState pt;
+    Max78000OwmState owm;
+    Max78000CnnState cnn;
+    Max78000DmaState dma;
+    Max78000TmrState tmr[MAX78000_NUM_TMR];
+    Max78000WutState wut;
+    Max78000RtcState rtc;
+    Max78000WdtState wdt[MAX78000_NUM_WDT];
+    Max78000GpioState gpio[MAX78000_NUM_GPIO];
+    Max78000SpiState spi[MAX78000_NUM_SPI];
+    Max78000I2cState i2c[MAX78000_NUM_I2C];
+    Max78000PwrseqState pwrseq;
+    Max78000LpgcrState lpgcr;
+
+    /* AES and TMR0 share NVIC line 5 */
+    OrIRQState irq5_orgate;
+    /* The NVIC's exception request goes to the core and wakes the GCR */
+    SplitIRQ cpu_irq_split;
 
     Clock *sysclk;
+    Clock *pclk;
 };
 
 #endif
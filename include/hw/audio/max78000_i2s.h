@@ -0,0 +1,133 @@
+/*
+ * MAX78000 I2S
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef HW_MAX78000_I2S_H
+#define HW_MAX78000_I2S_H
+
+#include "hw/sysbus.h"
+#include "hw/clock.h"
+#include "chardev/char-fe.h"
+#include "qemu/fifo8.h"
+#include "qemu/fifo32.h"
+#include "qemu/notify.h"
+#include "qom/object.h"
+
+#define TYPE_MAX78000_I2S "max78000-i2s"
+OBJECT_DECLARE_SIMPLE_TYPE(Max78000I2sState, MAX78000_I2S)
+
+/* FIFO depth, in samples */
+#define I2S_FIFO_DEPTH 32
+
+/* Host-side buffering of the input and output streams */
+#define I2S_STREAM_BUF_SIZE (64 * 1024)
+
+#define I2S_CTRL0CH0    0x0
+#define I2S_CTRL1CH0    0x10
+#define I2S_FILTCH0     0x30
+#define I2S_DMACH0      0x40
+#define I2S_FIFOCH0     0x50
+#define I2S_INTFL       0x60
+#define I2S_INTEN       0x64
+#define I2S_EXTSETUP    0x68
+#define I2S_WKEN        0x6c
+#define I2S_WKFL        0x70
+
+/* CTRL0CH0 */
+#define I2S_CTRL0_STEREO_SHIFT      12
+#define I2S_CTRL0_STEREO_MASK       0x3
+#define I2S_STEREO_STEREO           0
+#define I2S_STEREO_MONO_LEFT        2
+#define I2S_STEREO_MONO_RIGHT       3
+#define I2S_CTRL0_TX_EN             (1 << 16)
+#define I2S_CTRL0_RX_EN             (1 << 17)
+#define I2S_CTRL0_FLUSH             (1 << 18)
+#define I2S_CTRL0_RX_THD_SHIFT      24
+#define I2S_CTRL0_RX_THD_MASK       0xff
+
+/* CTRL1CH0 */
+#define I2S_CTRL1_BITS_WORD_MASK    0x1f
+#define I2S_CTRL1_EN                (1 << 8)
+#define I2S_CTRL1_SMP_SIZE_SHIFT    9
+#define I2S_CTRL1_SMP_SIZE_MASK     0x1f
+#define I2S_CTRL1_CLKDIV_SHIFT      16
+#define I2S_CTRL1_CLKDIV_MASK       0xffff
+
+/* DMACH0 */
+#define I2S_DMA_TX_THD_MASK         0x7f
+#define I2S_DMA_TX_EN               (1 << 7)
+#define I2S_DMA_RX_THD_SHIFT        8
+#define I2S_DMA_RX_THD_MASK         0x7f
+#define I2S_DMA_RX_EN               (1 << 15)
+#define I2S_DMA_TX_LVL_SHIFT        16
+#define I2S_DMA_RX_LVL_SHIFT        24
+#define I2S_DMA_LVL_MASK            0xff
+
+/* INTFL, INTEN */
+#define I2S_INT_RX_OV       (1 << 0)
+#define I2S_INT_RX_THD      (1 << 1)
+#define I2S_INT_TX_OB       (1 << 2)
+#define I2S_INT_TX_HE       (1 << 3)
+#define I2S_INT_ALL         0xf
+
+struct Max78000I2sState {
+    SysBusDevice parent_obj;
+
+    MemoryRegion mmio;
+
+    uint32_t ctrl0ch0;
+    uint32_t ctrl1ch0;
+    uint32_t filtch0;
+    uint32_t dmach0;
+    uint32_t intfl;
+    uint32_t inten;
+    uint32_t extsetup;
+    uint32_t wken;
+    uint32_t wkfl;
+
+    Fifo32 rx_fifo;
+    Fifo32 tx_fifo;
+
+    /*
+     * The word select clock: frames_done frames have been transferred
+     * since start_ns. The timer only runs when an interrupt or a DMA
+     * request is due; otherwise frames are caught up on the next access.
+     */
+    int64_t start_ns;
+    uint64_t frames_done;
+    QEMUTimer *timer;
+
+    /* Microphone samples: a WAV file, or raw 16 bit mono from a chardev */
+    char *in_path;
+    int in_fd;
+    uint16_t in_channels;
+    uint16_t in_bits;
+    uint64_t in_left;
+    uint8_t *in_buf;
+    uint32_t in_len;
+    uint32_t in_pos;
+    CharBackend chr;
+    Fifo8 chr_fifo;
+
+    /* Transmitted samples, written to a WAV file */
+    char *out_path;
+    int out_fd;
+    bool out_started;
+    uint16_t out_channels;
+    uint16_t out_bits;
+    uint32_t out_rate;
+    uint64_t out_size;
+    uint8_t *out_buf;
+    uint32_t out_len;
+    Notifier exit_notifier;
+
+    Clock *clk;
+    qemu_irq irq;
+    qemu_irq dma_rx;
+    qemu_irq dma_tx;
+};
+
+#endif
@@ -10,6 +10,7 @@
 #define HW_MAX78000_UART_H
 
 #include "hw/sysbus.h"
+#include "hw/clock.h"
 #include "chardev/char-fe.h"
 #include "qemu/fifo8.h"
 #include "qom/object.h"
@@ -35,20 +36,36 @@
 #define UART_BCLKRDY    (1 << 19)
 
 /* STATUS */
+#define UART_TX_LVL     12
 #define UART_RX_LVL     8
+#define UART_TX_FULL    (1 << 7)
 #define UART_TX_EM      (1 << 6)
 #define UART_RX_FULL    (1 << 5)
 #define UART_RX_EM      (1 << 4)
+#define UART_TX_BUSY    (1 << 0)
 
 /* PNR (Pin Control Register) */
 #define UART_CTS        1
 #define UART_RTS        (1 << 1)
 
+/* DMA */
+#define UART_DMA_TX_THD_MASK    0xf
+#define UART_DMA_TX_EN          (1 << 4)
+#define UART_DMA_RX_THD_SHIFT   5
+#define UART_DMA_RX_THD_MASK    0xf
+#define UART_DMA_RX_EN          (1 << 9)
+
+/* WKEN / WKFL */
+#define UART_WK_RX_NE   (1 << 0)
+#define UART_WK_RX_FULL (1 << 1)
+#define UART_WK_RX_THD  (1 << 2)
+
 /* INT_EN / INT_FL */
 #define UART_RX_THD     (1 << 4)
 #define UART_TX_HE      (1 << 6)
 
 #define UART_RXBUFLEN   0x100
+#define UART_FIFO_DEPTH 8
 #define TYPE_MAX78000_UART "max78000-uart"
 OBJECT_DECLARE_SIMPLE_TYPE(Max78000UartState, MAX78000_UART)
 
@@ -71,8 +88,15 @@ struct Max78000UartState {
     uint32_t wkfl;
 
     Fifo8 rx_fifo;
+    Fifo8 tx_fifo;
+    guint watch_tag;
 
     CharBackend chr;
+    bool chr_attached;
+    Clock *clk;
     qemu_irq irq;
+    qemu_irq dma_tx_req;
+    qemu_irq dma_rx_req;
+    qemu_irq wakeup;
 };
 #endif /* HW_STM32F2XX_USART_H */
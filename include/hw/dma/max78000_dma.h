@@ -0,0 +1,118 @@
+/*
+ * MAX78000 Standard DMA Controller
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef HW_MAX78000_DMA_H
+#define HW_MAX78000_DMA_H
+
+#include "hw/sysbus.h"
+#include "qom/object.h"
+
+#define TYPE_MAX78000_DMA "max78000-dma"
+OBJECT_DECLARE_SIMPLE_TYPE(Max78000DmaState, MAX78000_DMA)
+
+#define DMA_NUM_CHANNELS 4
+#define DMA_NUM_REQUESTS 64
+
+#define DMA_INTEN       0x0
+#define DMA_INTFL       0x4
+#define DMA_CH_BASE     0x100
+#define DMA_CH_STRIDE   0x20
+
+/* Channel registers, relative to DMA_CH_BASE + n * DMA_CH_STRIDE */
+#define DMA_CH_CTRL     0x0
+#define DMA_CH_STATUS   0x4
+#define DMA_CH_SRC      0x8
+#define DMA_CH_DST      0xc
+#define DMA_CH_CNT      0x10
+#define DMA_CH_SRCRLD   0x14
+#define DMA_CH_DSTRLD   0x18
+#define DMA_CH_CNTRLD   0x1c
+
+/* CTRL */
+#define DMA_CTRL_EN             (1 << 0)
+#define DMA_CTRL_RLDEN          (1 << 1)
+#define DMA_CTRL_REQUEST_SHIFT  4
+#define DMA_CTRL_REQUEST_MASK   0x3f
+#define DMA_CTRL_SRCWD_SHIFT    16
+#define DMA_CTRL_SRCINC         (1 << 18)
+#define DMA_CTRL_DSTWD_SHIFT    20
+#define DMA_CTRL_DSTINC         (1 << 22)
+#define DMA_CTRL_DIS_IE         (1 << 30)
+#define DMA_CTRL_CTZ_IE         (1u << 31)
+
+/* STATUS */
+#define DMA_STATUS_EN           (1 << 0)
+#define DMA_STATUS_IPEND        (1 << 1)
+#define DMA_STATUS_CTZ_IF       (1 << 2)
+#define DMA_STATUS_RLD_IF       (1 << 3)
+#define DMA_STATUS_BUS_ERR      (1 << 4)
+#define DMA_STATUS_TO_IF        (1 << 6)
+#define DMA_STATUS_W1C          (DMA_STATUS_CTZ_IF | DMA_STATUS_RLD_IF | \
+                                 DMA_STATUS_BUS_ERR | DMA_STATUS_TO_IF)
+
+/* CNT / CNTRLD */
+#define DMA_CNT_MASK            0xffffff
+#define DMA_CNTRLD_EN           (1u << 31)
+
+/*
+ * Request select values. Peripherals assert the matching "request"
+ * GPIO input while they can accept (TX) or supply (RX) data; the DMA
+ * acknowledges each request with the bus access that moves the data.
+ */
+#define DMA_REQ_MEMTOMEM        0x00
+#define DMA_REQ_SPI1_RX         0x01
+#define DMA_REQ_SPI0_RX         0x02
+#define DMA_REQ_UART0_RX        0x04
+#define DMA_REQ_UART1_RX        0x05
+#define DMA_REQ_I2C0_RX         0x07
+#define DMA_REQ_I2C1_RX         0x08
+#define DMA_REQ_I2C2_RX         0x0a
+#define DMA_REQ_UART2_RX        0x0e
+#define DMA_REQ_AES_RX          0x10
+#define DMA_REQ_PCIF_RX         0x13
+#define DMA_REQ_I2S_RX          0x1e
+#define DMA_REQ_SPI1_TX         0x21
+#define DMA_REQ_SPI0_TX         0x22
+#define DMA_REQ_UART0_TX        0x24
+#define DMA_REQ_UART1_TX        0x25
+#define DMA_REQ_I2C0_TX         0x27
+#define DMA_REQ_I2C1_TX         0x28
+#define DMA_REQ_I2C2_TX         0x2a
+#define DMA_REQ_UART2_TX        0x2e
+#define DMA_REQ_AES_TX          0x30
+#define DMA_REQ_CRC_TX          0x3c
+#define DMA_REQ_I2S_TX          0x3e
+
+typedef struct Max78000DmaChannel {
+    uint32_t ctrl;
+    uint32_t status;
+    uint32_t src;
+    uint32_t dst;
+    uint32_t cnt;
+    uint32_t srcrld;
+    uint32_t dstrld;
+    uint32_t cntrld;
+} Max78000DmaChannel;
+
+struct Max78000DmaState {
+    SysBusDevice parent_obj;
+
+    MemoryRegion mmio;
+
+    uint32_t inten;
+    Max78000DmaChannel ch[DMA_NUM_CHANNELS];
+
+    uint64_t requests;
+    QEMUBH *bh;
+
+    MemoryRegion *downstream;
+    AddressSpace downstream_as;
+
+    qemu_irq irq[DMA_NUM_CHANNELS];
+};
+
+#endif
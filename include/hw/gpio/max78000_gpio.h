@@ -0,0 +1,119 @@
+/*
+ * MAX78000 GPIO
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef HW_MAX78000_GPIO_H
+#define HW_MAX78000_GPIO_H
+
+#include "hw/sysbus.h"
+#include "hw/clock.h"
+#include "chardev/char-fe.h"
+#include "qemu/timer.h"
+#include "qom/object.h"
+
+#define TYPE_MAX78000_GPIO "max78000-gpio"
+OBJECT_DECLARE_SIMPLE_TYPE(Max78000GpioState, MAX78000_GPIO)
+
+#define GPIO_EN0        0x0
+#define GPIO_EN0_SET    0x4
+#define GPIO_EN0_CLR    0x8
+#define GPIO_OUTEN      0xc
+#define GPIO_OUTEN_SET  0x10
+#define GPIO_OUTEN_CLR  0x14
+#define GPIO_OUT        0x18
+#define GPIO_OUT_SET    0x1c
+#define GPIO_OUT_CLR    0x20
+#define GPIO_IN         0x24
+#define GPIO_INTMODE    0x28
+#define GPIO_INTPOL     0x2c
+#define GPIO_INEN       0x30
+#define GPIO_INTEN      0x34
+#define GPIO_INTEN_SET  0x38
+#define GPIO_INTEN_CLR  0x3c
+#define GPIO_INTFL      0x40
+#define GPIO_INTFL_CLR  0x48
+#define GPIO_WKEN       0x4c
+#define GPIO_WKEN_SET   0x50
+#define GPIO_WKEN_CLR   0x54
+#define GPIO_DUALEDGE   0x5c
+#define GPIO_PADCTRL0   0x60
+#define GPIO_PADCTRL1   0x64
+#define GPIO_EN1        0x68
+#define GPIO_EN1_SET    0x6c
+#define GPIO_EN1_CLR    0x70
+#define GPIO_EN2        0x74
+#define GPIO_EN2_SET    0x78
+#define GPIO_EN2_CLR    0x7c
+#define GPIO_HYSEN      0xa8
+#define GPIO_SRSEL      0xac
+#define GPIO_DS0        0xb0
+#define GPIO_DS1        0xb4
+#define GPIO_PSSEL      0xb8
+#define GPIO_VSSEL      0xc0
+
+#define GPIO_NUM_PINS   32
+
+/*
+ * Stimulus input: pin transitions read from a chardev are queued with
+ * their virtual time stamp and applied when that time is reached.
+ */
+#define GPIO_STIM_QUEUE 256
+#define GPIO_STIM_LINE  64
+
+typedef struct Max78000GpioEvent {
+    int64_t time;
+    uint8_t pin;
+    bool level;
+} Max78000GpioEvent;
+
+struct Max78000GpioState {
+    SysBusDevice parent_obj;
+
+    MemoryRegion mmio;
+
+    uint32_t en0;
+    uint32_t en1;
+    uint32_t en2;
+    uint32_t outen;
+    uint32_t out;
+    uint32_t intmode;
+    uint32_t intpol;
+    uint32_t inen;
+    uint32_t inten;
+    uint32_t intfl;
+    uint32_t wken;
+    uint32_t dualedge;
+    uint32_t padctrl0;
+    uint32_t padctrl1;
+    uint32_t hysen;
+    uint32_t srsel;
+    uint32_t ds0;
+    uint32_t ds1;
+    uint32_t pssel;
+    uint32_t vssel;
+
+    /* Levels applied to the pins from outside, and which pins are driven */
+    uint32_t ext_level;
+    uint32_t ext_driven;
+    /* Pin levels as last seen by the interrupt logic */
+    uint32_t level;
+
+    CharBackend chr;
+    Max78000GpioEvent stim[GPIO_STIM_QUEUE];
+    uint32_t stim_head;
+    uint32_t stim_count;
+    int64_t stim_last;
+    char stim_line[GPIO_STIM_LINE];
+    uint32_t stim_line_len;
+    QEMUTimer *stim_timer;
+
+    Clock *clk;
+    qemu_irq irq;
+    qemu_irq pin_out[GPIO_NUM_PINS];
+    qemu_irq wakeup[GPIO_NUM_PINS];
+};
+
+#endif
@@ -0,0 +1,141 @@
+/*
+ * MAX78000 I2C
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef HW_MAX78000_I2C_H
+#define HW_MAX78000_I2C_H
+
+#include "hw/sysbus.h"
+#include "hw/clock.h"
+#include "hw/i2c/i2c.h"
+#include "qemu/fifo8.h"
+#include "qom/object.h"
+
+#define TYPE_MAX78000_I2C "max78000-i2c"
+OBJECT_DECLARE_SIMPLE_TYPE(Max78000I2cState, MAX78000_I2C)
+
+#define I2C_CTRL        0x0
+#define I2C_STATUS      0x4
+#define I2C_INTFL0      0x8
+#define I2C_INTEN0      0xc
+#define I2C_INTFL1      0x10
+#define I2C_INTEN1      0x14
+#define I2C_FIFOLEN     0x18
+#define I2C_RXCTRL0     0x1c
+#define I2C_RXCTRL1     0x20
+#define I2C_TXCTRL0     0x24
+#define I2C_TXCTRL1     0x28
+#define I2C_FIFO        0x2c
+#define I2C_MSTCTRL     0x30
+#define I2C_CLKLO       0x34
+#define I2C_CLKHI       0x38
+#define I2C_HSCLK       0x3c
+#define I2C_TIMEOUT     0x40
+#define I2C_DMA         0x48
+#define I2C_SLAVE       0x4c
+
+/* CTRL */
+#define I2C_CTRL_EN             (1 << 0)
+#define I2C_CTRL_MST_MODE       (1 << 1)
+#define I2C_CTRL_SCL            (1 << 8)
+#define I2C_CTRL_SDA            (1 << 9)
+
+/* STATUS */
+#define I2C_STATUS_BUSY         (1 << 0)
+#define I2C_STATUS_RX_EM        (1 << 1)
+#define I2C_STATUS_RX_FULL      (1 << 2)
+#define I2C_STATUS_TX_EM        (1 << 3)
+#define I2C_STATUS_TX_FULL      (1 << 4)
+#define I2C_STATUS_MST_BUSY     (1 << 5)
+
+/* INTFL0, INTEN0 */
+#define I2C_INT0_DONE           (1 << 0)
+#define I2C_INT0_RX_THD         (1 << 4)
+#define I2C_INT0_TX_THD         (1 << 5)
+#define I2C_INT0_STOP           (1 << 6)
+#define I2C_INT0_ADDR_ACK       (1 << 7)
+#define I2C_INT0_ADDR_NACK_ERR  (1 << 10)
+#define I2C_INT0_DATA_ERR       (1 << 11)
+
+/* INTFL1, INTEN1 */
+#define I2C_INT1_RX_OV          (1 << 0)
+#define I2C_INT1_TX_UN          (1 << 1)
+#define I2C_INT1_START          (1 << 2)
+
+/* RXCTRL0 */
+#define I2C_RXCTRL0_FLUSH       (1 << 7)
+#define I2C_RXCTRL0_THD_SHIFT   8
+#define I2C_RXCTRL0_THD_MASK    0xf
+
+/* RXCTRL1 */
+#define I2C_RXCTRL1_CNT_MASK    0xff
+#define I2C_RXCTRL1_LVL_SHIFT   8
+
+/* TXCTRL0 */
+#define I2C_TXCTRL0_NACK_FLUSH_DIS  (1 << 5)
+#define I2C_TXCTRL0_FLUSH       (1 << 7)
+#define I2C_TXCTRL0_THD_SHIFT   8
+#define I2C_TXCTRL0_THD_MASK    0xf
+
+/* TXCTRL1 */
+#define I2C_TXCTRL1_LVL_SHIFT   8
+
+/* MSTCTRL */
+#define I2C_MSTCTRL_START       (1 << 0)
+#define I2C_MSTCTRL_RESTART     (1 << 1)
+#define I2C_MSTCTRL_STOP        (1 << 2)
+#define I2C_MSTCTRL_EX_ADDR_EN  (1 << 7)
+
+/* DMA */
+#define I2C_DMA_TX_EN           (1 << 0)
+#define I2C_DMA_RX_EN           (1 << 1)
+
+#define I2C_FIFO_SIZE   8
+
+/* Master state machine */
+enum {
+    I2C_MST_IDLE,
+    I2C_MST_ADDR,
+    I2C_MST_WRITE,
+    I2C_MST_READ,
+};
+
+struct Max78000I2cState {
+    SysBusDevice parent_obj;
+
+    MemoryRegion mmio;
+    I2CBus *bus;
+
+    uint32_t ctrl;
+    uint32_t intfl0;
+    uint32_t inten0;
+    uint32_t intfl1;
+    uint32_t inten1;
+    uint32_t rxctrl0;
+    uint32_t rxctrl1;
+    uint32_t txctrl0;
+    uint32_t mstctrl;
+    uint32_t clklo;
+    uint32_t clkhi;
+    uint32_t hsclk;
+    uint32_t timeout;
+    uint32_t dma;
+    uint32_t slave;
+
+    Fifo8 tx_fifo;
+    Fifo8 rx_fifo;
+
+    uint32_t mst_state;
+    /* Bytes of the current read still to be received */
+    uint32_t rx_left;
+
+    Clock *clk;
+    qemu_irq irq;
+    qemu_irq dma_tx_req;
+    qemu_irq dma_rx_req;
+};
+
+#endif
@@ -9,7 +9,10 @@
 #define HW_MAX78000_AES_H
 
 #include "hw/sysbus.h"
+#include "hw/clock.h"
+#include "qemu/timer.h"
 #include "crypto/aes.h"
+#include "crypto/aes-round.h"
 #include "qom/object.h"
 
 #define TYPE_MAX78000_AES "max78000-aes"
@@ -30,7 +33,8 @@ OBJECT_DECLARE_SIMPLE_TYPE(Max78000AesState, MAX78000_AES)
 #define OUTPUT_FLUSH (1 << 5)
 #define INPUT_FLUSH (1 << 4)
 #define START (1 << 3)
-
+#define AES_DMA_TX_EN (1 << 2)
+#define AES_DMA_RX_EN (1 << 1)
 #define AES_EN (1 << 0)
 
 /* STATUS */
@@ -43,6 +47,16 @@ OBJECT_DECLARE_SIMPLE_TYPE(Max78000AesState, MAX78000_AES)
 /* INTFL*/
 #define DONE (1 << 0)
 
+/*
+ * With DMA TX enabled the engine streams: input words queue up to
+ * AES_STREAM_BLOCKS blocks, and every complete block queued when the
+ * engine goes idle is processed as one batch. The batch completes after
+ * one clock per round plus AES_OVERHEAD_CYCLES per block.
+ */
+#define AES_STREAM_BLOCKS 64
+#define AES_STREAM_SIZE (AES_STREAM_BLOCKS * AES_BLOCK_SIZE)
+#define AES_OVERHEAD_CYCLES 2
+
 struct Max78000AesState {
     SysBusDevice parent_obj;
 
@@ -58,11 +72,39 @@ struct Max78000AesState {
     uint8_t key[32];
     AES_KEY internal_key;
 
+    /*
+     * Round keys expanded from key[] at the selected key size, in the
+     * layout taken by the crypto/aes-round.h primitives. They are only
+     * rebuilt once the key or KEY_SIZE has changed.
+     */
+    bool key_cached;
+    AES_KEY dec_key;
+    AESState enc_rk[AES_MAXNR + 1];
+    AESState dec_rk[AES_MAXNR + 1];
+    AESState internal_rk[AES_MAXNR + 1];
+
     uint32_t result_index;
     uint8_t result[16];
 
+    uint8_t stream_in[AES_STREAM_SIZE];
+    uint32_t stream_in_len;
+    uint8_t stream_out[AES_STREAM_SIZE];
+    uint32_t stream_out_pos;
+    uint32_t stream_out_len;
+    uint32_t busy_blocks;
+    QEMUTimer *done_timer;
+
+    Clock *clk;
 
     qemu_irq irq;
+    qemu_irq dma_tx_req;
+    qemu_irq dma_rx_req;
 };
 
+/*
+ * Load all 32 bytes of the key registers, as the TRNG does when it
+ * generates a key. A NULL key wipes them.
+ */
+void max78000_aes_set_key(Max78000AesState *s, const uint8_t *key);
+
 #endif
@@ -0,0 +1,131 @@
+/*
+ * MAX78000 CNN Accelerator
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef HW_MAX78000_CNN_H
+#define HW_MAX78000_CNN_H
+
+#include "hw/sysbus.h"
+#include "qom/object.h"
+
+#define TYPE_MAX78000_CNN "max78000-cnn"
+OBJECT_DECLARE_SIMPLE_TYPE(Max78000CnnState, MAX78000_CNN)
+
+#define CNN_NUM_QUADRANTS   4
+#define CNN_PROCS_PER_QUAD  16
+#define CNN_NUM_PROCS       (CNN_NUM_QUADRANTS * CNN_PROCS_PER_QUAD)
+#define CNN_MAX_LAYERS      32
+#define CNN_KERNEL_BYTES    9
+#define CNN_KERNELS_PER_PROC 768
+
+/* Layout of each quadrant's 4MB window */
+#define CNN_QUAD_SIZE       0x400000
+#define CNN_REGS_SIZE       0x1000
+#define CNN_BIAS_OFFSET     0x8000
+#define CNN_BIAS_SIZE       0x800
+#define CNN_MRAM_OFFSET     0x80000
+#define CNN_MRAM_PROC_SIZE  0x4000
+#define CNN_MRAM_SIZE       (CNN_PROCS_PER_QUAD * CNN_MRAM_PROC_SIZE)
+#define CNN_SRAM_OFFSET     0x300000
+#define CNN_SRAM_INST_SIZE  0x8000
+#define CNN_SRAM_SIZE       (4 * CNN_SRAM_INST_SIZE)
+
+/* Quadrant registers */
+#define CNN_CTRL            0x0
+#define CNN_SRAM            0x4
+#define CNN_LCNT_MAX        0x8
+#define CNN_TEST            0xc
+#define CNN_LREG_BASE       0x10
+
+/*
+ * Per-layer registers are arrays of CNN_MAX_LAYERS words; register r
+ * of layer l lives at CNN_LREG_BASE + r * 0x80 + l * 4.
+ */
+#define CNN_LREG_RCNT       0
+#define CNN_LREG_CCNT       1
+#define CNN_LREG_ONED       2
+#define CNN_LREG_PRCNT      3
+#define CNN_LREG_PCCNT      4
+#define CNN_LREG_STRIDE     5
+#define CNN_LREG_WPTR_BASE  6
+#define CNN_LREG_WPTR_TOFF  7
+#define CNN_LREG_WPTR_MOFF  8
+#define CNN_LREG_WPTR_CHOFF 9
+#define CNN_LREG_RPTR_BASE  10
+#define CNN_LREG_LCTRL0     11
+#define CNN_LREG_MCNT       12
+#define CNN_LREG_TPTR       13
+#define CNN_LREG_EN         14
+#define CNN_LREG_POST       15
+#define CNN_LREG_LCTRL1     16
+#define CNN_NUM_LREGS       17
+
+/* CTRL */
+#define CNN_CTRL_EN         (1 << 0)
+#define CNN_CTRL_CLK_EN     (1 << 3)
+#define CNN_CTRL_MASTER     (1 << 11)
+#define CNN_CTRL_IRQ        (1 << 12)
+
+/* RCNT / CCNT */
+#define CNN_CNT_MASK        0x3ff
+#define CNN_CNT_PAD_SHIFT   16
+#define CNN_CNT_PAD_MASK    0x3
+
+/* ONED */
+#define CNN_ONED_KSIZE_MASK 0xf
+#define CNN_ONED_EN         (1 << 8)
+#define CNN_ONED_K1X1       (1 << 9)
+
+/* WPTR_BASE / RPTR_BASE / WPTR_CHOFF */
+#define CNN_PTR_MASK        0x1fff
+
+/* LCTRL0 */
+#define CNN_LCTRL0_POOL_EN  (1 << 7)
+#define CNN_LCTRL0_MAXPL_EN (1 << 8)
+
+/* MCNT */
+#define CNN_MCNT_END_MASK   0xfff
+#define CNN_MCNT_START_SHIFT 16
+#define CNN_MCNT_START_MASK 0xfff
+
+/* POST */
+#define CNN_POST_BPTR_MASK  0x1ff
+#define CNN_POST_BIAS_EN    (1 << 12)
+#define CNN_POST_SCALE_SHIFT 13
+#define CNN_POST_SCALE_MASK 0xf
+#define CNN_POST_SCALE_LEFT (1 << 17)
+#define CNN_POST_ACT_SHIFT  20
+#define CNN_POST_ACT_MASK   0x3
+#define CNN_ACT_NONE        0
+#define CNN_ACT_RELU        1
+#define CNN_ACT_ABS         2
+
+typedef struct Max78000CnnQuadrant {
+    Max78000CnnState *cnn;
+    int index;
+
+    MemoryRegion container;
+    MemoryRegion regs;
+    MemoryRegion bias;
+    MemoryRegion mram;
+    MemoryRegion sram;
+
+    uint32_t ctrl;
+    uint32_t sram_ctrl;
+    uint32_t lcnt_max;
+    uint32_t test;
+    uint32_t lreg[CNN_NUM_LREGS][CNN_MAX_LAYERS];
+} Max78000CnnQuadrant;
+
+struct Max78000CnnState {
+    SysBusDevice parent_obj;
+
+    Max78000CnnQuadrant quad[CNN_NUM_QUADRANTS];
+
+    qemu_irq irq;
+};
+
+#endif
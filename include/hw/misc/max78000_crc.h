@@ -0,0 +1,51 @@
+/*
+ * MAX78000 CRC
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef HW_MAX78000_CRC_H
+#define HW_MAX78000_CRC_H
+
+#include "hw/sysbus.h"
+#include "hw/clock.h"
+#include "qom/object.h"
+
+#define TYPE_MAX78000_CRC "max78000-crc"
+OBJECT_DECLARE_SIMPLE_TYPE(Max78000CrcState, MAX78000_CRC)
+
+#define CRC_CTRL        0x0
+#define CRC_DATAIN      0x4
+#define CRC_POLY        0x8
+#define CRC_VAL         0xc
+
+/* CTRL */
+#define CRC_CTRL_EN             (1 << 0)
+#define CRC_CTRL_DMA_EN         (1 << 1)
+#define CRC_CTRL_MSB            (1 << 2)
+#define CRC_CTRL_BYTE_SWAP_IN   (1 << 3)
+#define CRC_CTRL_BYTE_SWAP_OUT  (1 << 4)
+#define CRC_CTRL_BUSY           (1 << 16)
+
+/* Reflected polynomials with a host implementation */
+#define CRC_POLY_CRC32          0xedb88320
+#define CRC_POLY_CRC32C         0x82f63b78
+
+struct Max78000CrcState {
+    SysBusDevice parent_obj;
+
+    MemoryRegion mmio;
+
+    uint32_t ctrl;
+    uint32_t poly;
+    uint32_t val;
+
+    /* Byte-at-a-time table for POLY in the current bit order */
+    uint32_t table[256];
+
+    Clock *clk;
+    qemu_irq dma_req;
+};
+
+#endif
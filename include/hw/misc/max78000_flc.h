@@ -0,0 +1,74 @@
+/*
+ * MAX78000 Flash Controller
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef HW_MAX78000_FLC_H
+#define HW_MAX78000_FLC_H
+
+#include "hw/sysbus.h"
+#include "system/block-backend.h"
+#include "qom/object.h"
+
+#define TYPE_MAX78000_FLC "max78000-flc"
+OBJECT_DECLARE_SIMPLE_TYPE(Max78000FlcState, MAX78000_FLC)
+
+#define FLC_ADDR        0x0
+#define FLC_CLKDIV      0x4
+#define FLC_CTRL        0x8
+#define FLC_INTR        0x24
+#define FLC_ECCDATA     0x28
+#define FLC_DATA0       0x30
+#define FLC_DATA1       0x34
+#define FLC_DATA2       0x38
+#define FLC_DATA3       0x3c
+#define FLC_ACTNL       0x40
+
+/* CTRL */
+#define FLC_CTRL_WR             (1 << 0)
+#define FLC_CTRL_ME             (1 << 1)
+#define FLC_CTRL_PGE            (1 << 2)
+#define FLC_CTRL_ERASE_CODE_SHIFT 8
+#define FLC_CTRL_ERASE_CODE_MASK  0xff
+#define FLC_CTRL_PEND           (1 << 24)
+#define FLC_CTRL_LVE            (1 << 25)
+#define FLC_CTRL_UNLOCK_SHIFT   28
+#define FLC_CTRL_UNLOCK_MASK    0xf
+
+#define FLC_ERASE_CODE_PAGE     0x55
+#define FLC_ERASE_CODE_MASS     0xaa
+#define FLC_UNLOCK_KEY          0x2
+
+/* INTR */
+#define FLC_INTR_DONE           (1 << 0)
+#define FLC_INTR_AF             (1 << 1)
+#define FLC_INTR_DONEIE         (1 << 8)
+#define FLC_INTR_AFIE           (1 << 9)
+
+#define FLC_PAGE_SIZE   0x2000
+#define FLC_WRITE_SIZE  16
+
+struct Max78000FlcState {
+    SysBusDevice parent_obj;
+
+    MemoryRegion mmio;
+
+    uint32_t addr;
+    uint32_t clkdiv;
+    uint32_t ctrl;
+    uint32_t intr;
+    uint32_t eccdata;
+    uint32_t data[4];
+    uint32_t actnl;
+
+    MemoryRegion *flash;
+    AddressSpace flash_as;
+    BlockBackend *blk;
+    bool ro;
+
+    qemu_irq irq;
+};
+
+#endif
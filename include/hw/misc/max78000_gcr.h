@@ -9,6 +9,8 @@
 #define HW_MAX78000_GCR_H
 
 #include "hw/sysbus.h"
+#include "hw/clock.h"
+#include "hw/timer/max78000_wut.h"
 #include "qom/object.h"
 
 #define TYPE_MAX78000_GCR "max78000-gcr"
@@ -22,6 +24,11 @@ OBJECT_DECLARE_SIMPLE_TYPE(Max78000GcrState, MAX78000_GCR)
 #define PCLKDIS0    0x24
 #define MEMCTRL     0x28
 #define MEMZ        0x2c
+/*
+ * Not on hardware, where the offset is reserved: writing GCR_READY_MAGIC
+ * pulses the "ready" output, which the board can snapshot the machine on.
+ */
+#define READY       0x3c
 #define SYSST       0x40
 #define RST1        0x44
 #define PCKDIS1     0x48
@@ -60,9 +67,30 @@ OBJECT_DECLARE_SIMPLE_TYPE(Max78000GcrState, MAX78000_GCR)
 #define WDT0_RESET (1 << 1)
 #define DMA_RESET (1 << 0)
 
+/* PCLKDIV */
+#define PCLKDIV_ADCFRQ_SHIFT 10
+#define PCLKDIV_ADCFRQ_MASK 0xf
+
 /* CLKCTRL */
 #define SYSCLK_RDY (1 << 13)
 
+/* READY */
+#define GCR_READY_MAGIC 0x52454459
+
+/* PM */
+#define PM_MODE_MASK        0xf
+#define PM_MODE_ACTIVE      0x0
+#define PM_MODE_SLEEP       0x1
+#define PM_MODE_STANDBY     0x2
+#define PM_MODE_BACKUP      0x4
+#define PM_MODE_LPM         0x8
+#define PM_MODE_UPM         0x9
+#define PM_MODE_POWERDOWN   0xa
+#define PM_GPIO_WE          (1 << 4)
+#define PM_RTC_WE           (1 << 5)
+#define PM_WUT_WE           (1 << 7)
+#define PM_AINCOMP_WE       (1 << 9)
+
 /* MEMZ */
 #define ram0 (1 << 0)
 #define ram1 (1 << 1)
@@ -84,9 +112,59 @@ OBJECT_DECLARE_SIMPLE_TYPE(Max78000GcrState, MAX78000_GCR)
 #define AES_RESET (1 << 10)
 #define CRC_RESET (1 << 9)
 
+#define OWM_RESET (1 << 7)
+
 #define PT_RESET (1 << 1)
 #define I2C1_RESET (1 << 0)
 
+/* The RST1 bits reset by a peripheral or soft reset through RST0 */
+#define RST1_PERIPHERALS (I2C2_RESET | I2S_RESET | SMPHR_RESET | \
+                          SPI0_RESET | AES_RESET | CRC_RESET | OWM_RESET | \
+                          PT_RESET | I2C1_RESET)
+
+/*
+ * Gated peripheral clocks, numbered by their bit in PCLKDIS0 (0-31) or
+ * PCKDIS1 (32-63). Each has a "<name>-clk" output which follows PCLK
+ * while its disable bit is clear and is stopped while it is set.
+ */
+#define GCR_CLK_GPIO0   0
+#define GCR_CLK_GPIO1   1
+#define GCR_CLK_SPI1    6
+#define GCR_CLK_UART0   9
+#define GCR_CLK_UART1   10
+#define GCR_CLK_I2C0    13
+#define GCR_CLK_TMR0    15
+#define GCR_CLK_TMR1    16
+#define GCR_CLK_TMR2    17
+#define GCR_CLK_TMR3    18
+#define GCR_CLK_ADC     23
+#define GCR_CLK_I2C1    28
+#define GCR_CLK_PT      29
+#define GCR_CLK_UART2   (32 + 1)
+#define GCR_CLK_TRNG    (32 + 2)
+#define GCR_CLK_OWM     (32 + 13)
+#define GCR_CLK_CRC     (32 + 14)
+#define GCR_CLK_AES     (32 + 15)
+#define GCR_CLK_SPI0    (32 + 16)
+#define GCR_CLK_PCIF    (32 + 18)
+#define GCR_CLK_I2S     (32 + 23)
+#define GCR_CLK_I2C2    (32 + 24)
+#define GCR_CLK_WDT0    (32 + 27)
+/* The RISC-V core; not modeled, so it has no clock output */
+#define GCR_CLK_CPU1    (32 + 31)
+#define GCR_NUM_CLK_OUT 23
+
+/* "wakeup" input lines */
+#define GCR_WAKE_GPIO   0
+#define GCR_WAKE_RTC    1
+#define GCR_WAKE_WUT    2
+#define GCR_WAKE_UART0  3
+#define GCR_WAKE_UART1  4
+#define GCR_WAKE_UART2  5
+#define GCR_WAKE_UART3  6
+/* The NVIC's exception request to the core; always a wakeup source */
+#define GCR_WAKE_NVIC   7
+#define GCR_NUM_WAKE    8
 
 #define SYSRAM0_START 0x20000000
 #define SYSRAM1_START 0x20008000
@@ -120,11 +198,43 @@ struct Max78000GcrState {
     MemoryRegion *sram;
     AddressSpace sram_as;
 
+    /* Low power mode state; see max78000_gcr_update_power() */
+    uint32_t wake_level;
+    bool sleeping;
+    bool fast_forward;
+    qemu_irq ready_irq;
+    CPUState *cpu;
+
+    Clock *pclk;
+    Clock *clk_out[GCR_NUM_CLK_OUT];
+
     DeviceState *uart0;
     DeviceState *uart1;
     DeviceState *uart2;
     DeviceState *trng;
     DeviceState *aes;
+    DeviceState *cnn;
+    DeviceState *dma;
+    DeviceState *tmr0;
+    DeviceState *tmr1;
+    DeviceState *tmr2;
+    DeviceState *tmr3;
+    DeviceState *gpio0;
+    DeviceState *gpio1;
+    DeviceState *spi0;
+    DeviceState *spi1;
+    DeviceState *i2c0;
+    DeviceState *i2c1;
+    DeviceState *i2c2;
+    DeviceState *crc;
+    DeviceState *sema;
+    DeviceState *i2s;
+    DeviceState *adc;
+    DeviceState *wdt0;
+    DeviceState *rtc;
+    Max78000WutState *wut;
+    DeviceState *pt;
+    DeviceState *owm;
 
 };
 
@@ -0,0 +1,49 @@
+/*
+ * MAX78000 Low Power Global Control Registers
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef HW_MAX78000_LPGCR_H
+#define HW_MAX78000_LPGCR_H
+
+#include "hw/sysbus.h"
+#include "hw/clock.h"
+#include "qom/object.h"
+
+#define TYPE_MAX78000_LPGCR "max78000-lpgcr"
+OBJECT_DECLARE_SIMPLE_TYPE(Max78000LpgcrState, MAX78000_LPGCR)
+
+#define LPGCR_RST       0x8
+#define LPGCR_PCLKDIS   0xc
+
+/* RST and PCLKDIS */
+#define LPGCR_GPIO2     (1 << 0)
+#define LPGCR_WDT1      (1 << 1)
+#define LPGCR_TMR4      (1 << 2)
+#define LPGCR_TMR5      (1 << 3)
+#define LPGCR_UART3     (1 << 4)
+#define LPGCR_LPCOMP    (1 << 6)
+
+/* Gated clock outputs, see max78000_lpgcr_clocks[] */
+#define LPGCR_NUM_CLK_OUT 5
+
+struct Max78000LpgcrState {
+    SysBusDevice parent_obj;
+
+    MemoryRegion mmio;
+
+    uint32_t pclkdis;
+
+    Clock *pclk;
+    Clock *clk_out[LPGCR_NUM_CLK_OUT];
+
+    DeviceState *tmr4;
+    DeviceState *tmr5;
+    DeviceState *gpio2;
+    DeviceState *wdt1;
+    DeviceState *uart3;
+};
+
+#endif
@@ -0,0 +1,103 @@
+/*
+ * MAX78000 1-Wire Master
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef HW_MAX78000_OWM_H
+#define HW_MAX78000_OWM_H
+
+#include "hw/sysbus.h"
+#include "hw/clock.h"
+#include "chardev/char-fe.h"
+#include "qom/object.h"
+
+#define TYPE_MAX78000_OWM "max78000-owm"
+OBJECT_DECLARE_SIMPLE_TYPE(Max78000OwmState, MAX78000_OWM)
+
+#define OWM_CFG         0x0
+#define OWM_CLK_DIV_1US 0x4
+#define OWM_CTRL_STAT   0x8
+#define OWM_DATA        0xc
+#define OWM_INTFL       0x10
+#define OWM_INTEN       0x14
+
+/* CFG */
+#define OWM_CFG_BIT_BANG_EN         (1 << 2)
+#define OWM_CFG_SINGLE_BIT_MODE     (1 << 5)
+#define OWM_CFG_OVERDRIVE           (1 << 6)
+
+/* CTRL_STAT */
+#define OWM_CTRL_START_OW_RESET     (1 << 0)
+#define OWM_CTRL_SRA_MODE           (1 << 1)
+#define OWM_CTRL_BIT_BANG_OE        (1 << 2)
+#define OWM_CTRL_OW_INPUT           (1 << 3)
+#define OWM_CTRL_OD_SPEC_MODE       (1 << 4)
+#define OWM_CTRL_PRESENCE_DETECT    (1 << 5)
+
+/* INTFL, INTEN */
+#define OWM_INT_RESET_DONE          (1 << 0)
+#define OWM_INT_TX_DATA_EMPTY       (1 << 1)
+#define OWM_INT_RX_DATA_READY       (1 << 2)
+#define OWM_INT_LINE_SHORT          (1 << 3)
+#define OWM_INT_LINE_LOW            (1 << 4)
+#define OWM_INT_ALL                 0x1f
+
+/*
+ * A DS18B20 temperature sensor that can be attached to the bus, modeled
+ * one time slot at a time.
+ */
+typedef enum {
+    DS18B20_IDLE,
+    DS18B20_ROM_CMD,
+    DS18B20_MATCH_ROM,
+    DS18B20_SEARCH_ROM,
+    DS18B20_FUNC_CMD,
+    DS18B20_WRITE_SCRATCHPAD,
+    DS18B20_SEND,
+} Ds18b20Phase;
+
+typedef struct Ds18b20State {
+    uint32_t phase;
+    /* Bits received, or sent, in the current phase */
+    uint32_t bits;
+    uint64_t shift;
+    /* Bytes being sent, and the phase to go to after them */
+    uint8_t tx[9];
+    uint32_t tx_len;
+    uint32_t next_phase;
+    uint8_t scratchpad[9];
+} Ds18b20State;
+
+struct Max78000OwmState {
+    SysBusDevice parent_obj;
+
+    MemoryRegion mmio;
+
+    uint32_t cfg;
+    uint32_t clk_div_1us;
+    uint32_t ctrl_stat;
+    uint32_t data;
+    uint32_t intfl;
+    uint32_t inten;
+
+    /* Flags to raise when the reset or transfer in progress completes */
+    uint32_t pending_intfl;
+    QEMUTimer *timer;
+
+    bool ds18b20;
+    uint64_t ds18b20_serial;
+    uint64_t ds18b20_rom;
+    /* In millidegrees Celsius */
+    int32_t temperature;
+    Ds18b20State dev;
+
+    /* Receives the bus waveforms as run-length records */
+    CharBackend chr;
+
+    Clock *clk;
+    qemu_irq irq;
+};
+
+#endif
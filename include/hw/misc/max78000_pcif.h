@@ -0,0 +1,86 @@
+/*
+ * MAX78000 Parallel Camera Interface
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef HW_MAX78000_PCIF_H
+#define HW_MAX78000_PCIF_H
+
+#include "hw/sysbus.h"
+#include "hw/clock.h"
+#include "chardev/char-fe.h"
+#include "qom/object.h"
+
+#define TYPE_MAX78000_PCIF "max78000-pcif"
+OBJECT_DECLARE_SIMPLE_TYPE(Max78000PcifState, MAX78000_PCIF)
+
+/* FIFO depth, in 32 bit words */
+#define PCIF_FIFO_DEPTH 32
+
+#define PCIF_CTRL               0x0
+#define PCIF_INT_EN             0x4
+#define PCIF_INT_FL             0x8
+#define PCIF_DS_TIMING_CODES    0xc
+#define PCIF_FIFO_DATA          0x30
+
+/* CTRL */
+#define PCIF_CTRL_READ_MODE_MASK        0x3
+#define PCIF_CTRL_READ_MODE_SINGLE      0x0
+#define PCIF_CTRL_READ_MODE_CONTINUOUS  0x1
+#define PCIF_CTRL_DATA_WIDTH_SHIFT      2
+#define PCIF_CTRL_DATA_WIDTH_MASK       0x3
+#define PCIF_CTRL_DS_TIMING_EN          (1 << 4)
+#define PCIF_CTRL_FIFO_THRSH_SHIFT      5
+#define PCIF_CTRL_FIFO_THRSH_MASK       0x1f
+#define PCIF_CTRL_PCIF_SYS              (1 << 16)
+
+/* INT_EN, INT_FL */
+#define PCIF_INT_IMG_DONE       (1 << 0)
+#define PCIF_INT_FIFO_FULL      (1 << 1)
+#define PCIF_INT_FIFO_THRESH    (1 << 2)
+#define PCIF_INT_FIFO_NOT_EMPTY (1 << 3)
+#define PCIF_INT_ALL            0xf
+
+struct Max78000PcifState {
+    SysBusDevice parent_obj;
+
+    MemoryRegion mmio;
+
+    uint32_t ctrl;
+    uint32_t int_en;
+    uint32_t int_fl;
+    uint32_t ds_timing_codes;
+
+    /*
+     * The frame being read out through FIFO_DATA, and how far. The FIFO
+     * holds the next PCIF_FIFO_DEPTH words of it; pos == frame_size
+     * means it is empty.
+     */
+    const uint8_t *frame;
+    uint32_t pos;
+    /* Frame index within the frames file */
+    uint32_t cur;
+    uint32_t next;
+    /* A single image has been captured since PCIF_SYS was set */
+    bool captured;
+
+    /* Frame source: a file of raw frames, or a chardev stream */
+    char *frames_path;
+    GMappedFile *frames;
+    uint32_t num_frames;
+    CharBackend chr;
+    uint8_t *chr_frame[2];
+    uint32_t chr_len;
+
+    uint32_t frame_size;
+    uint32_t fps;
+    QEMUTimer *vsync_timer;
+
+    Clock *clk;
+    qemu_irq irq;
+    qemu_irq dma_req;
+};
+
+#endif
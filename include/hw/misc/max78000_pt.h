@@ -0,0 +1,87 @@
+/*
+ * MAX78000 Pulse Train Engine
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef HW_MAX78000_PT_H
+#define HW_MAX78000_PT_H
+
+#include "hw/sysbus.h"
+#include "hw/clock.h"
+#include "chardev/char-fe.h"
+#include "qom/object.h"
+
+#define TYPE_MAX78000_PT "max78000-pt"
+OBJECT_DECLARE_SIMPLE_TYPE(Max78000PtState, MAX78000_PT)
+
+#define PT_NUM_CHANNELS 4
+
+/* Global registers */
+#define PTG_ENABLE      0x0
+#define PTG_RESYNC      0x4
+#define PTG_INTFL       0x8
+#define PTG_INTEN       0xc
+#define PTG_SAFE_EN     0x10
+#define PTG_SAFE_DIS    0x14
+
+/* Per pulse train registers, at PT_BASE + n * PT_STRIDE */
+#define PT_BASE         0x20
+#define PT_STRIDE       0x10
+#define PT_RATE_LENGTH  0x0
+#define PT_TRAIN        0x4
+#define PT_LOOP         0x8
+#define PT_RESTART      0xc
+
+/* RATE_LENGTH */
+#define PT_RATE_MASK            0x7ffffff
+#define PT_MODE_SHIFT           27
+#define PT_MODE_32BIT           0
+#define PT_MODE_SQUARE          1
+
+/* LOOP */
+#define PT_LOOP_COUNT_MASK      0xffff
+#define PT_LOOP_DELAY_SHIFT     16
+#define PT_LOOP_DELAY_MASK      0xfff
+
+/* RESTART */
+#define PT_RESTART_X_SHIFT      0
+#define PT_RESTART_X_EXIT       (1 << 7)
+#define PT_RESTART_Y_SHIFT      8
+#define PT_RESTART_Y_EXIT       (1 << 15)
+#define PT_RESTART_SEL_MASK     0x1f
+
+typedef struct Max78000PtChannel {
+    uint32_t rate_length;
+    uint32_t train;
+    uint32_t loop;
+    uint32_t restart;
+
+    /* When a running train's last loop ends, or INT64_MAX if it loops */
+    int64_t end_ns;
+} Max78000PtChannel;
+
+struct Max78000PtState {
+    SysBusDevice parent_obj;
+
+    MemoryRegion mmio;
+
+    uint32_t enable;
+    uint32_t intfl;
+    uint32_t inten;
+
+    Max78000PtChannel ch[PT_NUM_CHANNELS];
+
+    /* The pulse trains currently generating, and the earliest end_ns */
+    uint32_t running;
+    QEMUTimer *timer;
+
+    /* Receives the generated waveforms as run-length records */
+    CharBackend chr;
+
+    Clock *clk;
+    qemu_irq irq;
+};
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ * MAX78000 Power Sequencer
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef HW_MAX78000_PWRSEQ_H
+#define HW_MAX78000_PWRSEQ_H
+
+#include "hw/sysbus.h"
+#include "qom/object.h"
+
+#define TYPE_MAX78000_PWRSEQ "max78000-pwrseq"
+OBJECT_DECLARE_SIMPLE_TYPE(Max78000PwrseqState, MAX78000_PWRSEQ)
+
+#define PWRSEQ_LPCTRL   0x0
+#define PWRSEQ_LPWKFL0  0x4
+#define PWRSEQ_LPWKEN0  0x8
+#define PWRSEQ_LPWKFL1  0xc
+#define PWRSEQ_LPWKEN1  0x10
+#define PWRSEQ_LPWKFL2  0x14
+#define PWRSEQ_LPWKEN2  0x18
+#define PWRSEQ_LPWKFL3  0x1c
+#define PWRSEQ_LPWKEN3  0x20
+#define PWRSEQ_LPPWKFL  0x30
+#define PWRSEQ_LPPWKEN  0x34
+#define PWRSEQ_LPMEMSD  0x40
+#define PWRSEQ_LPVDDPD  0x44
+#define PWRSEQ_GP0      0x48
+#define PWRSEQ_GP1      0x4c
+
+/*
+ * GPIO wakeup: one "gpio-wake" input line per pin, numbered
+ * port * PWRSEQ_PINS_PER_PORT + pin.
+ */
+#define PWRSEQ_NUM_PORTS        4
+#define PWRSEQ_PINS_PER_PORT    32
+
+struct Max78000PwrseqState {
+    SysBusDevice parent_obj;
+
+    MemoryRegion mmio;
+
+    uint32_t lpctrl;
+    uint32_t lpwkfl[PWRSEQ_NUM_PORTS];
+    uint32_t lpwken[PWRSEQ_NUM_PORTS];
+    uint32_t lppwkfl;
+    uint32_t lppwken;
+    uint32_t lpmemsd;
+    uint32_t lpvddpd;
+    uint32_t gp0;
+    uint32_t gp1;
+
+    qemu_irq irq;
+    qemu_irq wakeup;
+};
+
+#endif
@@ -0,0 +1,49 @@
+/*
+ * MAX78000 Semaphores
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef HW_MAX78000_SEMA_H
+#define HW_MAX78000_SEMA_H
+
+#include "hw/sysbus.h"
+#include "qom/object.h"
+
+#define TYPE_MAX78000_SEMA "max78000-sema"
+OBJECT_DECLARE_SIMPLE_TYPE(Max78000SemaState, MAX78000_SEMA)
+
+#define SEMA_NUM        8
+
+#define SEMA_SEMAPHORES 0x0
+#define SEMA_IRQ0       0x100
+#define SEMA_MAIL0      0x104
+#define SEMA_IRQ1       0x108
+#define SEMA_MAIL1      0x10c
+#define SEMA_STATUS     0x200
+
+/* IRQ0, IRQ1 */
+#define SEMA_IRQ_EN             (1 << 0)
+#define SEMA_IRQ_PEND           (1 << 16)
+
+struct Max78000SemaState {
+    SysBusDevice parent_obj;
+
+    MemoryRegion mmio;
+
+    uint32_t sema;
+    uint32_t irq0;
+    uint32_t mail0;
+    uint32_t irq1;
+    uint32_t mail1;
+
+    /* Contention statistics for tracing; not migrated */
+    int64_t taken_at[SEMA_NUM];
+    uint32_t spins[SEMA_NUM];
+
+    /* Mailbox interrupt to the Cortex-M4 */
+    qemu_irq irq;
+};
+
+#endif
@@ -9,6 +9,8 @@
 #define HW_MAX78000_TRNG_H
 
 #include "hw/sysbus.h"
+#include "hw/clock.h"
+#include "hw/misc/max78000_aes.h"
 #include "qom/object.h"
 
 #define TYPE_MAX78000_TRNG "max78000-trng"
@@ -19,6 +21,17 @@ OBJECT_DECLARE_SIMPLE_TYPE(Max78000TrngState, MAX78000_TRNG)
 #define DATA 8
 
 #define RND_IE (1 << 1)
+#define TRNG_KEYGEN (1 << 3)
+#define TRNG_KEYWIPE (1 << 15)
+
+/* STATUS */
+#define TRNG_RDY (1 << 0)
+
+/*
+ * Random data is drawn from the host in chunks of TRNG_POOL_SIZE bytes
+ * and handed out to the guest from this pool.
+ */
+#define TRNG_POOL_SIZE 256
 
 struct Max78000TrngState {
     SysBusDevice parent_obj;
@@ -29,6 +42,12 @@ struct Max78000TrngState {
     uint32_t status;
     uint32_t data;
 
+    uint8_t pool[TRNG_POOL_SIZE];
+    uint32_t pool_pos;
+
+    Max78000AesState *aes;
+
+    Clock *clk;
     qemu_irq irq;
 };
 
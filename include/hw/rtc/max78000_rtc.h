@@ -0,0 +1,92 @@
+/*
+ * MAX78000 Real Time Clock
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef HW_MAX78000_RTC_H
+#define HW_MAX78000_RTC_H
+
+#include "hw/sysbus.h"
+#include "qemu/timer.h"
+#include "qom/object.h"
+
+#define TYPE_MAX78000_RTC "max78000-rtc"
+OBJECT_DECLARE_SIMPLE_TYPE(Max78000RtcState, MAX78000_RTC)
+
+/* The sub-second counter runs at 4096Hz */
+#define RTC_SSEC_BITS   12
+#define RTC_SSEC_FREQ   (1 << RTC_SSEC_BITS)
+
+#define RTC_SEC         0x0
+#define RTC_SSEC        0x4
+#define RTC_TODA        0x8
+#define RTC_SSECA       0xc
+#define RTC_CTRL        0x10
+#define RTC_TRIM        0x14
+#define RTC_OSCCTRL     0x18
+
+/* TODA */
+#define RTC_TODA_MASK   0xfffff
+
+/* CTRL */
+#define RTC_CTRL_EN             (1 << 0)
+#define RTC_CTRL_TOD_ALARM_IE   (1 << 1)
+#define RTC_CTRL_SSEC_ALARM_IE  (1 << 2)
+#define RTC_CTRL_BUSY           (1 << 3)
+#define RTC_CTRL_RDY            (1 << 4)
+#define RTC_CTRL_RDY_IE         (1 << 5)
+#define RTC_CTRL_TOD_ALARM      (1 << 6)
+#define RTC_CTRL_SSEC_ALARM     (1 << 7)
+#define RTC_CTRL_SQW_EN         (1 << 8)
+#define RTC_CTRL_SQW_SEL_SHIFT  9
+#define RTC_CTRL_SQW_SEL_MASK   0x3
+#define RTC_CTRL_WR_EN          (1 << 15)
+
+/* Flags that are cleared by writing 0 */
+#define RTC_CTRL_FLAGS  (RTC_CTRL_TOD_ALARM | RTC_CTRL_SSEC_ALARM)
+
+struct Max78000RtcState {
+    SysBusDevice parent_obj;
+
+    MemoryRegion mmio;
+
+    uint32_t ctrl;
+    uint32_t toda;
+    uint32_t sseca;
+    uint32_t trim;
+    uint32_t oscctrl;
+
+    /*
+     * SEC and SSEC together form a count of 4096Hz ticks. It was
+     * base_ticks at base_ns, in the time base of clock_type, and counts
+     * from there while the RTC is enabled. Alarms are checked against
+     * the ticks that passed since last_ticks, and the sub-second alarm
+     * repeats every 2^32 - SSECA ticks from ssa_start.
+     */
+    uint64_t base_ticks;
+    int64_t base_ns;
+    uint64_t last_ticks;
+    uint64_t ssa_start;
+    QEMUClockType clock_type;
+    QEMUTimer *alarm_timer;
+
+    QEMUTimer *sqw_timer;
+    bool sqw_level;
+
+    qemu_irq irq;
+    qemu_irq wakeup;
+    qemu_irq sqw;
+};
+
+/*
+ * While the SoC sleeps with fast-forward enabled, the GCR skips the
+ * always-on counters ahead. This returns the time until the next enabled
+ * alarm, in ns, or INT64_MAX if there is none or the RTC is stopped.
+ */
+int64_t max78000_rtc_next_deadline(Max78000RtcState *s);
+/* Advance the counters as if @ns had gone by */
+void max78000_rtc_skip(Max78000RtcState *s, int64_t ns);
+
+#endif
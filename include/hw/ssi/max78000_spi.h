@@ -0,0 +1,116 @@
+/*
+ * MAX78000 SPI
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef HW_MAX78000_SPI_H
+#define HW_MAX78000_SPI_H
+
+#include "hw/sysbus.h"
+#include "hw/clock.h"
+#include "hw/ssi/ssi.h"
+#include "qemu/fifo8.h"
+#include "qom/object.h"
+
+#define TYPE_MAX78000_SPI "max78000-spi"
+OBJECT_DECLARE_SIMPLE_TYPE(Max78000SpiState, MAX78000_SPI)
+
+#define SPI_FIFO        0x0
+#define SPI_CTRL0       0x10
+#define SPI_CTRL1       0x14
+#define SPI_CTRL2       0x18
+#define SPI_SSTIME      0x1c
+#define SPI_CLKCTRL     0x20
+#define SPI_DMA         0x28
+#define SPI_INTFL       0x2c
+#define SPI_INTEN       0x30
+#define SPI_WKFL        0x34
+#define SPI_WKEN        0x38
+#define SPI_STAT        0x3c
+
+/* CTRL0 */
+#define SPI_CTRL0_EN            (1 << 0)
+#define SPI_CTRL0_MST_MODE      (1 << 1)
+#define SPI_CTRL0_SS_IO         (1 << 4)
+#define SPI_CTRL0_START         (1 << 5)
+#define SPI_CTRL0_SS_CTRL       (1 << 8)
+#define SPI_CTRL0_SS_ACTIVE_SHIFT 16
+#define SPI_CTRL0_SS_ACTIVE_MASK  0xf
+
+/* CTRL1 */
+#define SPI_CTRL1_TX_NUM_CHAR_MASK  0xffff
+#define SPI_CTRL1_RX_NUM_CHAR_SHIFT 16
+
+/* CTRL2 */
+#define SPI_CTRL2_NUMBITS_SHIFT 8
+#define SPI_CTRL2_NUMBITS_MASK  0xf
+
+/* DMA */
+#define SPI_DMA_TX_THD_MASK     0x1f
+#define SPI_DMA_TX_FIFO_EN      (1 << 6)
+#define SPI_DMA_TX_FLUSH        (1 << 7)
+#define SPI_DMA_TX_LVL_SHIFT    8
+#define SPI_DMA_TX_EN           (1 << 15)
+#define SPI_DMA_RX_THD_SHIFT    16
+#define SPI_DMA_RX_THD_MASK     0x1f
+#define SPI_DMA_RX_FIFO_EN      (1 << 22)
+#define SPI_DMA_RX_FLUSH        (1 << 23)
+#define SPI_DMA_RX_LVL_SHIFT    24
+#define SPI_DMA_RX_EN           (1 << 31)
+
+/* INTFL, INTEN */
+#define SPI_INT_TX_TH           (1 << 0)
+#define SPI_INT_TX_EM           (1 << 1)
+#define SPI_INT_RX_TH           (1 << 2)
+#define SPI_INT_RX_FULL         (1 << 3)
+#define SPI_INT_SSA             (1 << 4)
+#define SPI_INT_SSD             (1 << 5)
+#define SPI_INT_FAULT           (1 << 8)
+#define SPI_INT_ABORT           (1 << 9)
+#define SPI_INT_MST_DONE        (1 << 11)
+#define SPI_INT_TX_OV           (1 << 12)
+#define SPI_INT_TX_UN           (1 << 13)
+#define SPI_INT_RX_OV           (1 << 14)
+#define SPI_INT_RX_UN           (1 << 15)
+
+/* STAT */
+#define SPI_STAT_BUSY           (1 << 0)
+
+#define SPI_FIFO_SIZE   32
+#define SPI_NUM_SS      4
+
+struct Max78000SpiState {
+    SysBusDevice parent_obj;
+
+    MemoryRegion mmio;
+    SSIBus *bus;
+
+    uint32_t ctrl0;
+    uint32_t ctrl1;
+    uint32_t ctrl2;
+    uint32_t sstime;
+    uint32_t clkctrl;
+    uint32_t dma;
+    uint32_t intfl;
+    uint32_t inten;
+    uint32_t wkfl;
+    uint32_t wken;
+
+    Fifo8 tx_fifo;
+    Fifo8 rx_fifo;
+
+    /* Characters of the current transaction still to be shifted */
+    uint32_t tx_left;
+    uint32_t rx_left;
+    bool busy;
+
+    Clock *clk;
+    qemu_irq irq;
+    qemu_irq cs[SPI_NUM_SS];
+    qemu_irq dma_tx_req;
+    qemu_irq dma_rx_req;
+};
+
+#endif
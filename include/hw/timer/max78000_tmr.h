@@ -0,0 +1,91 @@
+/*
+ * MAX78000 Timer
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef HW_MAX78000_TMR_H
+#define HW_MAX78000_TMR_H
+
+#include "hw/sysbus.h"
+#include "hw/ptimer.h"
+#include "qom/object.h"
+
+#define TYPE_MAX78000_TMR "max78000-tmr"
+OBJECT_DECLARE_SIMPLE_TYPE(Max78000TmrState, MAX78000_TMR)
+
+#define TMR_CNT         0x0
+#define TMR_CMP         0x4
+#define TMR_PWM         0x8
+#define TMR_INTFL       0xc
+#define TMR_CTRL0       0x10
+#define TMR_NOLCMP      0x14
+#define TMR_CTRL1       0x18
+#define TMR_WKFL        0x1c
+
+/*
+ * Each timer is two 16-bit halves (A in bits 15:0, B in bits 31:16 of
+ * every register) which can be cascaded into one 32-bit timer A.
+ */
+#define TMR_NUM_UNITS   2
+#define TMR_UNIT_SHIFT  16
+
+/* CTRL0, per unit */
+#define TMR_CTRL0_MODE_MASK     0xf
+#define TMR_CTRL0_CLKDIV_SHIFT  4
+#define TMR_CTRL0_CLKDIV_MASK   0xf
+#define TMR_CTRL0_POL           (1 << 8)
+#define TMR_CTRL0_RST           (1 << 13)
+#define TMR_CTRL0_CLKEN         (1 << 14)
+#define TMR_CTRL0_EN            (1 << 15)
+
+/* CTRL1, per unit */
+#define TMR_CTRL1_CLKSEL_MASK   0x3
+#define TMR_CTRL1_CLKEN         (1 << 2)
+#define TMR_CTRL1_CLKRDY        (1 << 3)
+#define TMR_CTRL1_IE            (1 << 8)
+#define TMR_CTRL1_CASCADE       (1u << 31)
+
+/* INTFL, per unit */
+#define TMR_INTFL_IRQ           (1 << 0)
+#define TMR_INTFL_WRDONE        (1 << 8)
+
+/* Modes */
+#define TMR_MODE_ONESHOT        0
+#define TMR_MODE_CONTINUOUS     1
+#define TMR_MODE_COUNTER        2
+#define TMR_MODE_PWM            3
+#define TMR_MODE_CAPTURE        4
+#define TMR_MODE_COMPARE        5
+#define TMR_MODE_GATED          6
+#define TMR_MODE_CAPCOMP        7
+
+/* Fixed-frequency sources selectable through CTRL1.CLKSEL */
+#define TMR_ISO_FREQ            60000000
+#define TMR_IBRO_FREQ           7372800
+#define TMR_ERTCO_FREQ          32768
+
+struct Max78000TmrState {
+    SysBusDevice parent_obj;
+
+    MemoryRegion mmio;
+
+    ptimer_state *timer[TMR_NUM_UNITS];
+
+    uint32_t cnt;
+    uint32_t cmp;
+    uint32_t pwm;
+    uint32_t intfl;
+    uint32_t ctrl0;
+    uint32_t nolcmp;
+    uint32_t ctrl1;
+    uint32_t wkfl;
+
+    bool input[TMR_NUM_UNITS];
+
+    Clock *clk;
+    qemu_irq irq;
+};
+
+#endif
@@ -0,0 +1,76 @@
+/*
+ * MAX78000 Wakeup Timer
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef HW_MAX78000_WUT_H
+#define HW_MAX78000_WUT_H
+
+#include "hw/sysbus.h"
+#include "hw/ptimer.h"
+#include "qom/object.h"
+
+#define TYPE_MAX78000_WUT "max78000-wut"
+OBJECT_DECLARE_SIMPLE_TYPE(Max78000WutState, MAX78000_WUT)
+
+#define WUT_CNT         0x0
+#define WUT_CMP         0x4
+#define WUT_PWM         0x8
+#define WUT_INTFL       0xc
+#define WUT_CTRL        0x10
+#define WUT_NOLCMP      0x14
+#define WUT_PRESET      0x18
+#define WUT_RELOAD      0x1c
+#define WUT_SNAPSHOT    0x20
+
+/* CTRL */
+#define WUT_CTRL_TMODE_MASK     0x7
+#define WUT_CTRL_PRES_SHIFT     3
+#define WUT_CTRL_PRES_MASK      0x7
+#define WUT_CTRL_TPOL           (1 << 6)
+#define WUT_CTRL_TEN            (1 << 7)
+#define WUT_CTRL_PRES3          (1 << 8)
+
+/* INTFL */
+#define WUT_INTFL_IRQ           (1 << 0)
+
+#define WUT_MODE_ONESHOT        0
+#define WUT_MODE_CONTINUOUS     1
+#define WUT_MODE_COMPARE        5
+
+/* The wakeup timer always runs from the 32kHz ERTCO */
+#define WUT_FREQ                32768
+
+struct Max78000WutState {
+    SysBusDevice parent_obj;
+
+    MemoryRegion mmio;
+
+    ptimer_state *timer;
+
+    uint32_t cnt;
+    uint32_t cmp;
+    uint32_t pwm;
+    uint32_t intfl;
+    uint32_t ctrl;
+    uint32_t nolcmp;
+    uint32_t preset;
+    uint32_t reload;
+    uint32_t snapshot;
+
+    qemu_irq irq;
+    qemu_irq wakeup;
+};
+
+/*
+ * While the SoC sleeps with fast-forward enabled, the GCR skips the
+ * always-on counters ahead. This returns the time until the next match,
+ * in ns, or INT64_MAX if the timer is stopped.
+ */
+int64_t max78000_wut_next_deadline(Max78000WutState *s);
+/* Advance the count as if @ns had gone by */
+void max78000_wut_skip(Max78000WutState *s, int64_t ns);
+
+#endif
@@ -0,0 +1,83 @@
+/*
+ * MAX78000 Watchdog Timer
+ *
+ * Copyright (c) 2025 Jackson Donaldson <jcksn@duck.com>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef HW_MAX78000_WDT_H
+#define HW_MAX78000_WDT_H
+
+#include "hw/sysbus.h"
+#include "hw/clock.h"
+#include "qom/object.h"
+
+#define TYPE_MAX78000_WDT "max78000-wdt"
+OBJECT_DECLARE_SIMPLE_TYPE(Max78000WdtState, MAX78000_WDT)
+
+#define WDT_IBRO_FREQ   7372800
+#define WDT_ERTCO_FREQ  32768
+
+#define WDT_CTRL    0x0
+#define WDT_RST     0x4
+#define WDT_CLKSEL  0x8
+#define WDT_CNT     0xc
+
+/*
+ * CTRL. Each threshold field selects 2^(31 - n) clock cycles.
+ */
+#define WDT_CTRL_INT_LATE_VAL_SHIFT     0
+#define WDT_CTRL_RST_LATE_VAL_SHIFT     4
+#define WDT_CTRL_EN                     (1 << 8)
+#define WDT_CTRL_INT_LATE               (1 << 9)
+#define WDT_CTRL_WDT_INT_EN             (1 << 10)
+#define WDT_CTRL_WDT_RST_EN             (1 << 11)
+#define WDT_CTRL_INT_EARLY              (1 << 12)
+#define WDT_CTRL_INT_EARLY_VAL_SHIFT    16
+#define WDT_CTRL_RST_EARLY_VAL_SHIFT    20
+#define WDT_CTRL_CLKRDY_IE              (1 << 27)
+#define WDT_CTRL_CLKRDY                 (1 << 28)
+#define WDT_CTRL_WIN_EN                 (1 << 29)
+#define WDT_CTRL_RST_EARLY              (1 << 30)
+#define WDT_CTRL_RST_LATE               (1u << 31)
+#define WDT_CTRL_VAL_MASK               0xf
+
+/* Flags that are cleared by writing 0 */
+#define WDT_CTRL_FLAGS  (WDT_CTRL_INT_LATE | WDT_CTRL_INT_EARLY | \
+                         WDT_CTRL_RST_EARLY | WDT_CTRL_RST_LATE)
+
+/* RST: writing SEQ0 then SEQ1 feeds the watchdog */
+#define WDT_RST_SEQ0    0xa5
+#define WDT_RST_SEQ1    0x5a
+
+/* CLKSEL */
+#define WDT_CLKSEL_MASK     0x7
+#define WDT_CLKSEL_PCLK     0
+#define WDT_CLKSEL_IBRO     1
+
+struct Max78000WdtState {
+    SysBusDevice parent_obj;
+
+    MemoryRegion mmio;
+
+    uint32_t ctrl;
+    uint32_t clksel;
+    uint8_t rst_seq;
+
+    /*
+     * The counter was cnt at cnt_ns, and counts up from there while the
+     * watchdog is enabled and clocked. The timer is only armed for the
+     * next late interrupt or reset threshold.
+     */
+    uint32_t cnt;
+    int64_t cnt_ns;
+    QEMUTimer *timer;
+
+    /* Reset flags to report after the system reset that a bite causes */
+    uint32_t bite_flags;
+
+    Clock *clk;
+    qemu_irq irq;
+};
+
+#endif
@@ -0,0 +1,131 @@
+/*
+ * QTest testcase for the MAX78000 CRC engine
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+#include "qemu/osdep.h"
+#include "libqtest.h"
+#include "hw/misc/max78000_crc.h"
+#include "hw/misc/max78000_gcr.h"
+
+#define GCR_BASE_ADDR   0x40000000
+#define CRC_BASE_ADDR   0x4000f000
+
+/* The non-reflected form of the CRC-32 polynomial, for MSB first mode */
+#define CRC_POLY_CRC32_MSB 0x04c11db7
+
+/*
+ * CRC_VAL after "123456789", starting from the reset value. The engine
+ * has no final XOR, so these are the inverted catalogue check values of
+ * CRC-32 (zlib), CRC-32C and CRC-32/MPEG-2 respectively.
+ */
+#define CRC32_CHECK     0x340bc6d9
+#define CRC32C_CHECK    0x1cf96d7c
+#define CRC32_MSB_CHECK 0x0376e6e7
+
+static QTestState *init_crc(uint32_t ctrl, uint32_t poly)
+{
+    QTestState *qts = qtest_init("-M max78000fthr");
+
+    /* Ungate the CRC peripheral clock */
+    qtest_writel(qts, GCR_BASE_ADDR + PCKDIS1,
+                 qtest_readl(qts, GCR_BASE_ADDR + PCKDIS1) &
+                 ~(1 << (GCR_CLK_CRC - 32)));
+    qtest_writel(qts, CRC_BASE_ADDR + CRC_CTRL, CRC_CTRL_EN | ctrl);
+    qtest_writel(qts, CRC_BASE_ADDR + CRC_POLY, poly);
+    g_assert_cmphex(qtest_readl(qts, CRC_BASE_ADDR + CRC_VAL), ==,
+                    0xffffffff);
+    return qts;
+}
+
+/*
+ * Feed "123456789" as two words and a byte. With BYTE_SWAP_IN the first
+ * character is the most significant byte of each word.
+ */
+static void feed_check_string(QTestState *qts, bool swap_in)
+{
+    if (swap_in) {
+        qtest_writel(qts, CRC_BASE_ADDR + CRC_DATAIN, 0x31323334);
+        qtest_writel(qts, CRC_BASE_ADDR + CRC_DATAIN, 0x35363738);
+    } else {
+        qtest_writel(qts, CRC_BASE_ADDR + CRC_DATAIN, 0x34333231);
+        qtest_writel(qts, CRC_BASE_ADDR + CRC_DATAIN, 0x38373635);
+    }
+    qtest_writeb(qts, CRC_BASE_ADDR + CRC_DATAIN, '9');
+}
+
+static void test_crc32(void)
+{
+    QTestState *qts = init_crc(0, CRC_POLY_CRC32);
+
+    feed_check_string(qts, false);
+    g_assert_cmphex(qtest_readl(qts, CRC_BASE_ADDR + CRC_VAL), ==,
+                    CRC32_CHECK);
+
+    qtest_quit(qts);
+}
+
+static void test_crc32c(void)
+{
+    QTestState *qts = init_crc(0, CRC_POLY_CRC32C);
+
+    feed_check_string(qts, false);
+    g_assert_cmphex(qtest_readl(qts, CRC_BASE_ADDR + CRC_VAL), ==,
+                    CRC32C_CHECK);
+
+    qtest_quit(qts);
+}
+
+static void test_msb(void)
+{
+    QTestState *qts = init_crc(CRC_CTRL_MSB, CRC_POLY_CRC32_MSB);
+
+    feed_check_string(qts, false);
+    g_assert_cmphex(qtest_readl(qts, CRC_BASE_ADDR + CRC_VAL), ==,
+                    CRC32_MSB_CHECK);
+
+    qtest_quit(qts);
+}
+
+static void test_byte_swap_in(void)
+{
+    QTestState *qts = init_crc(CRC_CTRL_BYTE_SWAP_IN, CRC_POLY_CRC32);
+
+    feed_check_string(qts, true);
+    g_assert_cmphex(qtest_readl(qts, CRC_BASE_ADDR + CRC_VAL), ==,
+                    CRC32_CHECK);
+
+    qtest_quit(qts);
+}
+
+static void test_byte_swap_out(void)
+{
+    QTestState *qts = init_crc(CRC_CTRL_BYTE_SWAP_OUT, CRC_POLY_CRC32C);
+
+    feed_check_string(qts, false);
+    g_assert_cmphex(qtest_readl(qts, CRC_BASE_ADDR + CRC_VAL), ==,
+                    bswap32(CRC32C_CHECK));
+
+    /* Only the read back is swapped, not the running value */
+    qtest_writel(qts, CRC_BASE_ADDR + CRC_CTRL, CRC_CTRL_EN);
+    g_assert_cmphex(qtest_readl(qts, CRC_BASE_ADDR + CRC_VAL), ==,
+                    CRC32C_CHECK);
+
+    qtest_quit(qts);
+}
+
+int main(int argc, char **argv)
+{
+    g_test_init(&argc, &argv, NULL);
+    g_test_set_nonfatal_assertions();
+
+    qtest_add_func("max78000/crc/crc32", test_crc32);
+    qtest_add_func("max78000/crc/crc32c", test_crc32c);
+    qtest_add_func("max78000/crc/msb", test_msb);
+    qtest_add_func("max78000/crc/byte_swap_in", test_byte_swap_in);
+    qtest_add_func("max78000/crc/byte_swap_out", test_byte_swap_out);
+
+    return g_test_run();
+}
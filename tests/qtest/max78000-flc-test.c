@@ -0,0 +1,127 @@
+/*
+ * QTest testcase for the MAX78000 flash controller
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+#include "qemu/osdep.h"
+#include "libqtest.h"
+#include "hw/misc/max78000_flc.h"
+
+#define FLC_BASE_ADDR   0x40029000
+#define FLASH_BASE_ADDR 0x10000000
+
+/* A page away from the vector table */
+#define TEST_PAGE       (FLASH_BASE_ADDR + 2 * FLC_PAGE_SIZE)
+
+#define FLC_UNLOCKED    (FLC_UNLOCK_KEY << FLC_CTRL_UNLOCK_SHIFT)
+
+static uint32_t flc_readl(QTestState *qts, hwaddr reg)
+{
+    return qtest_readl(qts, FLC_BASE_ADDR + reg);
+}
+
+static void flc_writel(QTestState *qts, hwaddr reg, uint32_t val)
+{
+    qtest_writel(qts, FLC_BASE_ADDR + reg, val);
+}
+
+/* Run a command and check that it completed and nothing else */
+static void flc_command(QTestState *qts, uint32_t addr, uint32_t ctrl)
+{
+    flc_writel(qts, FLC_INTR, 0);
+    flc_writel(qts, FLC_ADDR, addr);
+    flc_writel(qts, FLC_CTRL, ctrl);
+    g_assert_cmphex(flc_readl(qts, FLC_INTR), ==, FLC_INTR_DONE);
+}
+
+static void page_erase(QTestState *qts, uint32_t addr)
+{
+    flc_command(qts, addr, FLC_UNLOCKED | FLC_CTRL_PGE |
+                (FLC_ERASE_CODE_PAGE << FLC_CTRL_ERASE_CODE_SHIFT));
+}
+
+/* Load the 128 bit write buffer with @val in every word */
+static void set_data(QTestState *qts, uint32_t val)
+{
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        flc_writel(qts, FLC_DATA0 + i * 4, val);
+    }
+}
+
+static void test_page_erase(void)
+{
+    QTestState *qts = qtest_init("-M max78000fthr");
+    uint32_t addr;
+
+    page_erase(qts, TEST_PAGE + 0x100);
+
+    for (addr = TEST_PAGE; addr < TEST_PAGE + FLC_PAGE_SIZE; addr += 4) {
+        g_assert_cmphex(qtest_readl(qts, addr), ==, 0xffffffff);
+    }
+    /* The neighbouring pages are left alone */
+    g_assert_cmphex(qtest_readl(qts, TEST_PAGE - 4), ==, 0);
+    g_assert_cmphex(qtest_readl(qts, TEST_PAGE + FLC_PAGE_SIZE), ==, 0);
+
+    qtest_quit(qts);
+}
+
+static void test_program_clears_bits(void)
+{
+    QTestState *qts = qtest_init("-M max78000fthr");
+    int i;
+
+    page_erase(qts, TEST_PAGE);
+
+    set_data(qts, 0x12345678);
+    flc_command(qts, TEST_PAGE, FLC_UNLOCKED | FLC_CTRL_WR);
+    for (i = 0; i < 4; i++) {
+        g_assert_cmphex(qtest_readl(qts, TEST_PAGE + i * 4), ==, 0x12345678);
+    }
+
+    /* A second program can clear more bits but never set one */
+    set_data(qts, 0xff00ff00);
+    flc_command(qts, TEST_PAGE, FLC_UNLOCKED | FLC_CTRL_WR);
+    for (i = 0; i < 4; i++) {
+        g_assert_cmphex(qtest_readl(qts, TEST_PAGE + i * 4), ==, 0x12005600);
+    }
+    g_assert_cmphex(qtest_readl(qts, TEST_PAGE + FLC_WRITE_SIZE), ==,
+                    0xffffffff);
+
+    qtest_quit(qts);
+}
+
+static void test_locked_write(void)
+{
+    QTestState *qts = qtest_init("-M max78000fthr");
+
+    page_erase(qts, TEST_PAGE);
+
+    set_data(qts, 0);
+    flc_writel(qts, FLC_INTR, 0);
+    flc_writel(qts, FLC_ADDR, TEST_PAGE);
+    flc_writel(qts, FLC_CTRL, FLC_CTRL_WR);
+
+    /* The access fault is flagged and the command bit self-clears */
+    g_assert_cmphex(flc_readl(qts, FLC_INTR), ==, FLC_INTR_AF);
+    g_assert_cmphex(flc_readl(qts, FLC_CTRL) & FLC_CTRL_WR, ==, 0);
+    g_assert_cmphex(qtest_readl(qts, TEST_PAGE), ==, 0xffffffff);
+
+    qtest_quit(qts);
+}
+
+int main(int argc, char **argv)
+{
+    g_test_init(&argc, &argv, NULL);
+    g_test_set_nonfatal_assertions();
+
+    qtest_add_func("max78000/flc/page_erase", test_page_erase);
+    qtest_add_func("max78000/flc/program_clears_bits",
+                   test_program_clears_bits);
+    qtest_add_func("max78000/flc/locked_write", test_locked_write);
+
+    return g_test_run();
+}
@@ -0,0 +1,223 @@
+/*
+ * QTest testcase for the MAX78000 GCR low power modes
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+#include "qemu/osdep.h"
+#include "libqtest.h"
+#include "hw/misc/max78000_gcr.h"
+#include "hw/timer/max78000_wut.h"
+#include "hw/rtc/max78000_rtc.h"
+#include "hw/misc/max78000_crc.h"
+
+#define GCR_BASE_ADDR   0x40000000
+#define CRC_BASE_ADDR   0x4000f000
+#define RTC_BASE_ADDR   0x40006000
+#define WUT_BASE_ADDR   0x40006400
+
+#define NVIC_ISER0 0xE000E100
+#define NVIC_ISPR0 0xE000E200
+#define NVIC_ICPR0 0xE000E280
+/* Any line with no device behind it */
+#define TEST_IRQ 1
+
+#define WUT_TICK_NS (NANOSECONDS_PER_SECOND / WUT_FREQ)
+
+static void enter_lpm(QTestState *qts, uint32_t wake_en)
+{
+    uint32_t pm = qtest_readl(qts, GCR_BASE_ADDR + PM);
+
+    qtest_writel(qts, GCR_BASE_ADDR + PM,
+                 (pm & ~PM_MODE_MASK) | wake_en | PM_MODE_LPM);
+    g_assert_cmphex(qtest_readl(qts, GCR_BASE_ADDR + PM) & PM_MODE_MASK,
+                    ==, PM_MODE_LPM);
+}
+
+/*
+ * An interrupt that is not a GCR wakeup source still un-halts the core,
+ * and must end the fast-forwarding of the always-on timers with it.
+ */
+static void test_nvic_wake(void)
+{
+    uint32_t cnt;
+    QTestState *qts = qtest_init("-M max78000fthr "
+                                 "-global max78000-gcr.fast-forward=on");
+
+    enter_lpm(qts, PM_WUT_WE);
+
+    qtest_writel(qts, NVIC_ISER0, 1 << TEST_IRQ);
+    qtest_writel(qts, NVIC_ISPR0, 1 << TEST_IRQ);
+    g_assert_cmphex(qtest_readl(qts, GCR_BASE_ADDR + PM) & PM_MODE_MASK,
+                    ==, PM_MODE_ACTIVE);
+    qtest_writel(qts, NVIC_ICPR0, 1 << TEST_IRQ);
+
+    qtest_writel(qts, WUT_BASE_ADDR + WUT_CMP, 0x100000);
+    qtest_writel(qts, WUT_BASE_ADDR + WUT_CTRL,
+                 WUT_CTRL_TEN | WUT_MODE_CONTINUOUS);
+
+    /* A disabled wakeup source must not skip the WUT ahead any more */
+    qtest_set_irq_in(qts, "/machine/soc/gcr", "wakeup", GCR_WAKE_GPIO, 1);
+    qtest_clock_step(qts, 100 * WUT_TICK_NS);
+    cnt = qtest_readl(qts, WUT_BASE_ADDR + WUT_CNT);
+    g_assert_cmpuint(cnt, >=, 90);
+    g_assert_cmpuint(cnt, <=, 110);
+
+    qtest_quit(qts);
+}
+
+/* Start the RTC from 0s with a time-of-day alarm at @alarm_sec */
+static void start_rtc(QTestState *qts, uint32_t alarm_sec)
+{
+    qtest_writel(qts, RTC_BASE_ADDR + RTC_CTRL, RTC_CTRL_WR_EN);
+    qtest_writel(qts, RTC_BASE_ADDR + RTC_SEC, 0);
+    qtest_writel(qts, RTC_BASE_ADDR + RTC_SSEC, 0);
+    qtest_writel(qts, RTC_BASE_ADDR + RTC_TODA, alarm_sec);
+    qtest_writel(qts, RTC_BASE_ADDR + RTC_CTRL,
+                 RTC_CTRL_WR_EN | RTC_CTRL_EN | RTC_CTRL_TOD_ALARM_IE);
+}
+
+/* Start the WUT from 1, to reload @sec seconds from now */
+static void start_wut(QTestState *qts, uint32_t sec)
+{
+    qtest_writel(qts, WUT_BASE_ADDR + WUT_CNT, 1);
+    qtest_writel(qts, WUT_BASE_ADDR + WUT_CMP, sec * WUT_FREQ);
+    qtest_writel(qts, WUT_BASE_ADDR + WUT_CTRL,
+                 WUT_CTRL_TEN | WUT_MODE_CONTINUOUS);
+}
+
+/*
+ * The WUT match comes first: both counters move 2s ahead, and the RTC,
+ * whose alarm is far off, must not be flagged.
+ */
+static void test_fast_forward_wut_first(void)
+{
+    uint32_t cnt;
+    QTestState *qts = qtest_init("-M max78000fthr -rtc clock=vm "
+                                 "-global max78000-gcr.fast-forward=on");
+
+    start_rtc(qts, 100);
+    start_wut(qts, 2);
+    enter_lpm(qts, PM_WUT_WE | PM_RTC_WE);
+
+    /* Everything up to the tick before the match has been skipped */
+    qtest_clock_step(qts, 2 * WUT_TICK_NS);
+    g_assert_cmphex(qtest_readl(qts, GCR_BASE_ADDR + PM) & PM_MODE_MASK,
+                    ==, PM_MODE_ACTIVE);
+    g_assert_cmphex(qtest_readl(qts, WUT_BASE_ADDR + WUT_INTFL), ==,
+                    WUT_INTFL_IRQ);
+    cnt = qtest_readl(qts, WUT_BASE_ADDR + WUT_CNT);
+    g_assert_cmpuint(cnt, <=, 3);
+
+    g_assert_cmpuint(qtest_readl(qts, RTC_BASE_ADDR + RTC_SEC), ==, 1);
+    g_assert_cmpuint(qtest_readl(qts, RTC_BASE_ADDR + RTC_SSEC), >=,
+                     RTC_SSEC_FREQ - 2);
+    g_assert_false(qtest_readl(qts, RTC_BASE_ADDR + RTC_CTRL) &
+                   RTC_CTRL_TOD_ALARM);
+
+    qtest_quit(qts);
+}
+
+/*
+ * The RTC alarm comes first: both counters move 3s ahead, and the WUT,
+ * whose match is far off, must not fire.
+ */
+static void test_fast_forward_rtc_first(void)
+{
+    uint32_t cnt;
+    QTestState *qts = qtest_init("-M max78000fthr -rtc clock=vm "
+                                 "-global max78000-gcr.fast-forward=on");
+
+    start_rtc(qts, 3);
+    start_wut(qts, 100);
+    enter_lpm(qts, PM_WUT_WE | PM_RTC_WE);
+
+    /* Everything up to the tick before the alarm has been skipped */
+    qtest_clock_step(qts, 2 * NANOSECONDS_PER_SECOND / RTC_SSEC_FREQ);
+    g_assert_cmphex(qtest_readl(qts, GCR_BASE_ADDR + PM) & PM_MODE_MASK,
+                    ==, PM_MODE_ACTIVE);
+    g_assert_true(qtest_readl(qts, RTC_BASE_ADDR + RTC_CTRL) &
+                  RTC_CTRL_TOD_ALARM);
+    g_assert_cmpuint(qtest_readl(qts, RTC_BASE_ADDR + RTC_SEC), ==, 3);
+
+    g_assert_cmphex(qtest_readl(qts, WUT_BASE_ADDR + WUT_INTFL), ==, 0);
+    cnt = qtest_readl(qts, WUT_BASE_ADDR + WUT_CNT);
+    g_assert_cmpuint(cnt, >=, 3 * WUT_FREQ - 16);
+    g_assert_cmpuint(cnt, <=, 3 * WUT_FREQ + 32);
+
+    qtest_quit(qts);
+}
+
+/* Without RTC_WE the RTC alarm is no deadline, and nothing is skipped */
+static void test_fast_forward_disabled_source(void)
+{
+    QTestState *qts = qtest_init("-M max78000fthr -rtc clock=vm "
+                                 "-global max78000-gcr.fast-forward=on");
+
+    start_rtc(qts, 3);
+    enter_lpm(qts, 0);
+
+    qtest_clock_step(qts, NANOSECONDS_PER_SECOND / 2);
+    g_assert_cmpuint(qtest_readl(qts, RTC_BASE_ADDR + RTC_SEC), ==, 0);
+    g_assert_cmphex(qtest_readl(qts, GCR_BASE_ADDR + PM) & PM_MODE_MASK,
+                    ==, PM_MODE_LPM);
+
+    qtest_quit(qts);
+}
+
+/* An interrupt that is already pending keeps the core from sleeping */
+static void test_nvic_pending(void)
+{
+    QTestState *qts = qtest_init("-M max78000fthr");
+
+    qtest_writel(qts, NVIC_ISER0, 1 << TEST_IRQ);
+    qtest_writel(qts, NVIC_ISPR0, 1 << TEST_IRQ);
+
+    qtest_writel(qts, GCR_BASE_ADDR + PM,
+                 (qtest_readl(qts, GCR_BASE_ADDR + PM) & ~PM_MODE_MASK) |
+                 PM_MODE_LPM);
+    g_assert_cmphex(qtest_readl(qts, GCR_BASE_ADDR + PM) & PM_MODE_MASK,
+                    ==, PM_MODE_ACTIVE);
+
+    qtest_quit(qts);
+}
+
+/* Peripheral and soft resets through RST0 also reset the RST1 devices */
+static void test_rst0_resets_rst1(void)
+{
+    static const uint32_t resets[] = { PERIPHERAL_RESET, SOFT_RESET };
+    QTestState *qts = qtest_init("-M max78000fthr");
+    int i;
+
+    for (i = 0; i < ARRAY_SIZE(resets); i++) {
+        qtest_writel(qts, CRC_BASE_ADDR + CRC_POLY, CRC_POLY_CRC32C);
+        qtest_writel(qts, CRC_BASE_ADDR + CRC_VAL, 0x12345678);
+
+        qtest_writel(qts, GCR_BASE_ADDR + RST0, resets[i]);
+        g_assert_cmphex(qtest_readl(qts, CRC_BASE_ADDR + CRC_POLY), ==,
+                        CRC_POLY_CRC32);
+        g_assert_cmphex(qtest_readl(qts, CRC_BASE_ADDR + CRC_VAL), ==,
+                        0xffffffff);
+    }
+
+    qtest_quit(qts);
+}
+
+int main(int argc, char **argv)
+{
+    g_test_init(&argc, &argv, NULL);
+    g_test_set_nonfatal_assertions();
+
+    qtest_add_func("max78000/gcr/nvic_wake", test_nvic_wake);
+    qtest_add_func("max78000/gcr/nvic_pending", test_nvic_pending);
+    qtest_add_func("max78000/gcr/fast_forward_wut_first",
+                   test_fast_forward_wut_first);
+    qtest_add_func("max78000/gcr/fast_forward_rtc_first",
+                   test_fast_forward_rtc_first);
+    qtest_add_func("max78000/gcr/fast_forward_disabled_source",
+                   test_fast_forward_disabled_source);
+    qtest_add_func("max78000/gcr/rst0_resets_rst1", test_rst0_resets_rst1);
+
+    return g_test_run();
+}
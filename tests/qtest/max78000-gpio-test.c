@@ -0,0 +1,122 @@
+/*
+ * QTest testcase for the MAX78000 GPIO stimulus input
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+#include "qemu/osdep.h"
+#include "libqtest.h"
+#include "hw/gpio/max78000_gpio.h"
+#include "hw/misc/max78000_gcr.h"
+
+#define GCR_BASE_ADDR   0x40000000
+#define GPIO0_BASE_ADDR 0x40008000
+
+/*
+ * Pin 0 goes high at once so the test can tell the file has been read.
+ * Pin 3 pulses, pin 5 follows relative to the last good line, and none
+ * of the bad lines in between may touch pin 4 or the relative base.
+ */
+static const char stimulus[] =
+    "# sync\n"
+    "0 0 1\n"
+    "1000000 3 1\n"
+    "+500000 3 0\n"
+    "1600000 4 2\n"
+    "1600000 40 1\n"
+    "+x 4 1\n"
+    "1600000 4 1 junk\n"
+    "+500000 5 1\n";
+
+static uint32_t gpio_readl(QTestState *qts, hwaddr reg)
+{
+    return qtest_readl(qts, GPIO0_BASE_ADDR + reg);
+}
+
+static void gpio_writel(QTestState *qts, hwaddr reg, uint32_t val)
+{
+    qtest_writel(qts, GPIO0_BASE_ADDR + reg, val);
+}
+
+/*
+ * The chardev is read from the main loop, so wait for the sync line.
+ * If this is run on a slow CI runner,
+ * the meson harness will timeout after 10 minutes for us.
+ */
+static void wait_for_stimulus(QTestState *qts)
+{
+    while (!(gpio_readl(qts, GPIO_IN) & BIT(0))) {
+        g_usleep(1000);
+    }
+}
+
+static void test_stimulus(void)
+{
+    g_autofree char *path = NULL;
+    g_autofree char *args = NULL;
+    const uint32_t pins = BIT(3) | BIT(4) | BIT(5);
+    QTestState *qts;
+    int fd;
+
+    fd = g_file_open_tmp("qtest-max78000-gpio-XXXXXX", &path, NULL);
+    g_assert_cmpint(fd, >=, 0);
+    g_assert_cmpint(write(fd, stimulus, strlen(stimulus)), ==,
+                    strlen(stimulus));
+    close(fd);
+
+    args = g_strdup_printf("-M max78000fthr "
+                           "-chardev file,id=stim,path=/dev/null,"
+                           "input-path=%s "
+                           "-global max78000-soc.gpio0-stimulus=stim",
+                           path);
+    qts = qtest_init(args);
+
+    /* Edge detection needs the port clock */
+    qtest_writel(qts, GCR_BASE_ADDR + PCLKDIS0,
+                 qtest_readl(qts, GCR_BASE_ADDR + PCLKDIS0) &
+                 ~(1 << GCR_CLK_GPIO0));
+    /* Pins 3 and 4 flag rising edges, pin 5 both edges */
+    gpio_writel(qts, GPIO_INTMODE, pins);
+    gpio_writel(qts, GPIO_INTPOL, BIT(3) | BIT(4));
+    gpio_writel(qts, GPIO_DUALEDGE, BIT(5));
+    gpio_writel(qts, GPIO_INTFL_CLR, 0xffffffff);
+
+    wait_for_stimulus(qts);
+    g_assert_cmphex(gpio_readl(qts, GPIO_IN) & pins, ==, 0);
+
+    qtest_clock_set(qts, 1000000);
+    g_assert_cmphex(gpio_readl(qts, GPIO_IN) & pins, ==, BIT(3));
+    g_assert_cmphex(gpio_readl(qts, GPIO_INTFL) & pins, ==, BIT(3));
+    gpio_writel(qts, GPIO_INTFL_CLR, pins);
+
+    /* A falling edge on a rising edge pin leaves the flag clear */
+    qtest_clock_set(qts, 1500000);
+    g_assert_cmphex(gpio_readl(qts, GPIO_IN) & pins, ==, 0);
+    g_assert_cmphex(gpio_readl(qts, GPIO_INTFL) & pins, ==, 0);
+
+    /* Nothing happens at the time stamp of the bad lines */
+    qtest_clock_set(qts, 1600000);
+    g_assert_cmphex(gpio_readl(qts, GPIO_IN) & pins, ==, 0);
+    g_assert_cmphex(gpio_readl(qts, GPIO_INTFL) & pins, ==, 0);
+
+    /* The relative line counts from the last good one, not a bad one */
+    qtest_clock_set(qts, 1999999);
+    g_assert_cmphex(gpio_readl(qts, GPIO_IN) & pins, ==, 0);
+    qtest_clock_set(qts, 2000000);
+    g_assert_cmphex(gpio_readl(qts, GPIO_IN) & pins, ==, BIT(5));
+    g_assert_cmphex(gpio_readl(qts, GPIO_INTFL) & pins, ==, BIT(5));
+
+    qtest_quit(qts);
+    unlink(path);
+}
+
+int main(int argc, char **argv)
+{
+    g_test_init(&argc, &argv, NULL);
+    g_test_set_nonfatal_assertions();
+
+    qtest_add_func("max78000/gpio/stimulus", test_stimulus);
+
+    return g_test_run();
+}
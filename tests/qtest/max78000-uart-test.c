@@ -0,0 +1,134 @@
+/*
+ * QTest testcase for the MAX78000 UART
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+#include "qemu/osdep.h"
+#include "libqtest.h"
+#include "hw/char/max78000_uart.h"
+#include "hw/dma/max78000_dma.h"
+#include "hw/misc/max78000_gcr.h"
+
+#define GCR_BASE_ADDR   0x40000000
+#define DMA_BASE_ADDR   0x40028000
+#define UART0_BASE_ADDR 0x40042000
+#define SRAM_BASE_ADDR  0x20000000
+
+#define DMA_CH(n, reg)  (DMA_BASE_ADDR + DMA_CH_BASE + (n) * DMA_CH_STRIDE + \
+                         (reg))
+
+/*
+ * Wait indefinitely for the flag to be updated.
+ * If this is run on a slow CI runner,
+ * the meson harness will timeout after 10 minutes for us.
+ */
+static void uart_wait_for_rx_level(QTestState *qts, uint32_t level)
+{
+    while (((qtest_readl(qts, UART0_BASE_ADDR + UART_STATUS) >>
+             UART_RX_LVL) & 0xf) < level) {
+        g_usleep(1000);
+    }
+}
+
+/* The DMA runs from a bottom half, so completion has to be polled for */
+static void dma_wait_for_done(QTestState *qts, int ch)
+{
+    while (qtest_readl(qts, DMA_CH(ch, DMA_CH_CNT)) != 0) {
+        g_usleep(1000);
+    }
+}
+
+static void init_uart(QTestState *qts)
+{
+    /* Ungate the UART0 peripheral clock */
+    qtest_writel(qts, GCR_BASE_ADDR + PCLKDIS0,
+                 qtest_readl(qts, GCR_BASE_ADDR + PCLKDIS0) &
+                 ~(1 << GCR_CLK_UART0));
+    qtest_writel(qts, UART0_BASE_ADDR + UART_CTRL, UART_BCLKEN);
+}
+
+/* A byte wide DMA transfer from SRAM into the TX FIFO */
+static void test_dma_send(void)
+{
+    int sock_fd;
+    char s[10];
+    ssize_t len, ret;
+    QTestState *qts = qtest_init_with_serial("-M max78000fthr", &sock_fd);
+
+    init_uart(qts);
+
+    qtest_memwrite(qts, SRAM_BASE_ADDR, "world", 5);
+    qtest_writel(qts, DMA_CH(0, DMA_CH_SRC), SRAM_BASE_ADDR);
+    qtest_writel(qts, DMA_CH(0, DMA_CH_DST), UART0_BASE_ADDR + UART_FIFO);
+    qtest_writel(qts, DMA_CH(0, DMA_CH_CNT), 5);
+    qtest_writel(qts, DMA_CH(0, DMA_CH_CTRL),
+                 DMA_CTRL_EN | DMA_CTRL_SRCINC |
+                 (DMA_REQ_UART0_TX << DMA_CTRL_REQUEST_SHIFT));
+
+    /* Request data while fewer than 8 bytes are queued */
+    qtest_writel(qts, UART0_BASE_ADDR + UART_DMA, UART_DMA_TX_EN | 8);
+
+    /* The DMA feeds the FIFO a byte at a time, so the bytes may trickle in */
+    for (len = 0; len < 5; len += ret) {
+        ret = recv(sock_fd, s + len, sizeof(s) - len, 0);
+        g_assert_cmpint(ret, >, 0);
+    }
+    g_assert_cmpint(len, ==, 5);
+    g_assert_true(memcmp(s, "world", 5) == 0);
+    g_assert_cmphex(qtest_readl(qts, DMA_CH(0, DMA_CH_STATUS)) &
+                    DMA_STATUS_BUS_ERR, ==, 0);
+    g_assert_cmpuint(qtest_readl(qts, DMA_CH(0, DMA_CH_CNT)), ==, 0);
+
+    close(sock_fd);
+
+    qtest_quit(qts);
+}
+
+/* A byte wide DMA transfer from the RX FIFO into SRAM */
+static void test_dma_receive(void)
+{
+    int sock_fd;
+    char s[5];
+    QTestState *qts = qtest_init_with_serial("-M max78000fthr", &sock_fd);
+
+    init_uart(qts);
+
+    g_assert_true(send(sock_fd, "hello", 5, 0) == 5);
+    uart_wait_for_rx_level(qts, 5);
+
+    qtest_writel(qts, DMA_CH(1, DMA_CH_SRC), UART0_BASE_ADDR + UART_FIFO);
+    qtest_writel(qts, DMA_CH(1, DMA_CH_DST), SRAM_BASE_ADDR + 0x100);
+    qtest_writel(qts, DMA_CH(1, DMA_CH_CNT), 5);
+    qtest_writel(qts, DMA_CH(1, DMA_CH_CTRL),
+                 DMA_CTRL_EN | DMA_CTRL_DSTINC |
+                 (DMA_REQ_UART0_RX << DMA_CTRL_REQUEST_SHIFT));
+
+    /* Request a transfer as soon as one byte is available */
+    qtest_writel(qts, UART0_BASE_ADDR + UART_DMA,
+                 UART_DMA_RX_EN | (1 << UART_DMA_RX_THD_SHIFT));
+    dma_wait_for_done(qts, 1);
+
+    qtest_memread(qts, SRAM_BASE_ADDR + 0x100, s, 5);
+    g_assert_true(memcmp(s, "hello", 5) == 0);
+    g_assert_cmphex(qtest_readl(qts, DMA_CH(1, DMA_CH_STATUS)) &
+                    DMA_STATUS_BUS_ERR, ==, 0);
+    g_assert_true(qtest_readl(qts, UART0_BASE_ADDR + UART_STATUS) &
+                  UART_RX_EM);
+
+    close(sock_fd);
+
+    qtest_quit(qts);
+}
+
+int main(int argc, char **argv)
+{
+    g_test_init(&argc, &argv, NULL);
+    g_test_set_nonfatal_assertions();
+
+    qtest_add_func("max78000/uart/dma_send", test_dma_send);
+    qtest_add_func("max78000/uart/dma_receive", test_dma_receive);
+
+    return g_test_run();
+}